@@ -0,0 +1,95 @@
+function regressions = bench_compare(current, baseline, thresholds)
+% BENCH_COMPARE  Regressions of a bench_suite report against a baseline.
+%
+%   regressions = bench_compare(current, baseline)
+%   regressions = bench_compare(current, baseline, thresholds)
+%
+%   current and baseline are bench_suite reports or JSON files written by
+%   it. Cases are matched on problem, size, backend, variant and threads;
+%   cases missing from either side are ignored. A case regresses if its
+%   status changed, or if a metric grew by more than its threshold
+%   relative to the baseline. thresholds overrides the defaults
+%
+%     solve_time 0.15, setup_time 0.25, lin_sys_time 0.15,
+%     cone_time 0.15, iter 0.05, peak_mb 0.10, min_time 1
+%
+%   Times (ms) below min_time in the baseline are too noisy to compare
+%   and are skipped. Returns one element per regression (problem, size,
+%   backend, variant, threads, metric, baseline, current, ratio) and
+%   prints them.
+
+if nargin < 3
+    thresholds = struct();
+end
+tol = struct('solve_time', 0.15, 'setup_time', 0.25, ...
+    'lin_sys_time', 0.15, 'cone_time', 0.15, 'iter', 0.05, ...
+    'peak_mb', 0.10, 'min_time', 1);
+names = fieldnames(thresholds);
+for i = 1:numel(names)
+    if ~isfield(tol, names{i})
+        error('Unknown threshold ''%s''.', names{i});
+    end
+    tol.(names{i}) = thresholds.(names{i});
+end
+current = load_report(current);
+baseline = load_report(baseline);
+
+metrics = setdiff(fieldnames(tol), {'min_time'});
+regressions = struct('problem', {}, 'size', {}, 'backend', {}, ...
+    'variant', {}, 'threads', {}, 'metric', {}, 'baseline', {}, ...
+    'current', {}, 'ratio', {});
+base_keys = arrayfun(@case_key, baseline.results, 'UniformOutput', false);
+for i = 1:numel(current.results)
+    cur = current.results(i);
+    j = find(strcmp(base_keys, case_key(cur)), 1);
+    if isempty(j)
+        continue
+    end
+    base = baseline.results(j);
+    if ~strcmp(cur.status, base.status)
+        regressions(end + 1) = regression(cur, 'status', NaN, NaN); %#ok<AGROW>
+        continue
+    end
+    for k = 1:numel(metrics)
+        name = metrics{k};
+        b = base.(name);
+        c = cur.(name);
+        if isempty(b) || isempty(c) || isnan(b) || isnan(c) || b <= 0
+            continue
+        end
+        if endsWith(name, '_time') && b < tol.min_time
+            continue
+        end
+        if c > (1 + tol.(name)) * b
+            regressions(end + 1) = regression(cur, name, b, c); %#ok<AGROW>
+        end
+    end
+end
+
+if isempty(regressions)
+    fprintf('No regressions against the baseline.\n');
+end
+for i = 1:numel(regressions)
+    r = regressions(i);
+    fprintf('REGRESSION %-12s %-7s %-18s %-5s %-7s %-13s %g -> %g (x%.2f)\n', ...
+        r.problem, r.size, r.backend, r.variant, r.threads, r.metric, ...
+        r.baseline, r.current, r.ratio);
+end
+end
+
+function report = load_report(report)
+if ischar(report) || isstring(report)
+    report = jsondecode(fileread(report));
+end
+end
+
+function key = case_key(r)
+key = strjoin({r.problem, r.size, r.backend, r.variant, r.threads}, '/');
+end
+
+function r = regression(cur, metric, b, c)
+r = struct('problem', cur.problem, 'size', cur.size, ...
+    'backend', cur.backend, 'variant', cur.variant, ...
+    'threads', cur.threads, 'metric', metric, 'baseline', b, ...
+    'current', c, 'ratio', c / b);
+end
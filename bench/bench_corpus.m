@@ -0,0 +1,138 @@
+function corpus = bench_corpus(sizes)
+% BENCH_CORPUS  Fixed, seeded set of benchmark problems in SCS form.
+%
+%   corpus = bench_corpus()
+%   corpus = bench_corpus(sizes)
+%
+%   Builds the problems of bench_suite for each size in sizes, a cell
+%   array of 'small', 'medium' and 'large' (default {'small', 'medium'}).
+%   The families follow the generators in examples/, written directly in
+%   SCS form so that no modelling tool is needed:
+%
+%     random_cone  feasible LP/SOC cone program with a zero cone, as in
+%                  random_cone_problem.m
+%     lasso        0.5*||A*x - b||^2 + mu*||x||_1 as a QP, as in
+%                  run_lasso_ex.m
+%     portfolio    factor-model portfolio QP with a budget constraint and
+%                  no shorting, as in run_portfolio_ex.m
+%
+%   Every problem is generated from its own fixed seed, so the corpus is
+%   the same on every run and machine (for a given MATLAB random number
+%   generator). corpus is a struct array with fields name, size, data, K.
+
+if nargin < 1 || isempty(sizes)
+    sizes = {'small', 'medium'};
+end
+if ischar(sizes)
+    sizes = {sizes};
+end
+
+corpus = struct('name', {}, 'size', {}, 'data', {}, 'K', {});
+for i = 1:numel(sizes)
+    switch sizes{i}
+        case 'small'
+            scale = 1;
+        case 'medium'
+            scale = 10;
+        case 'large'
+            scale = 100;
+        otherwise
+            error('Unknown size ''%s''.', sizes{i});
+    end
+    [data, K] = random_cone(scale, seed_of('random_cone', i));
+    corpus(end + 1) = struct('name', 'random_cone', 'size', sizes{i}, ...
+        'data', data, 'K', K); %#ok<AGROW>
+    [data, K] = lasso(scale, seed_of('lasso', i));
+    corpus(end + 1) = struct('name', 'lasso', 'size', sizes{i}, ...
+        'data', data, 'K', K); %#ok<AGROW>
+    [data, K] = portfolio(scale, seed_of('portfolio', i));
+    corpus(end + 1) = struct('name', 'portfolio', 'size', sizes{i}, ...
+        'data', data, 'K', K); %#ok<AGROW>
+end
+end
+
+function seed = seed_of(name, i)
+seed = sum(double(sprintf('scs_bench_%s_%i', name, i)));
+end
+
+function [data, K] = random_cone(scale, seed)
+% Primal-dual feasible: y in K*, s = y - z in K, s'y = 0.
+rng(seed, 'twister')
+K.z = 50 * scale;
+K.l = 600 * scale;
+K.q = repmat([3; 10; 50], 20 * scale, 1);
+m = K.z + K.l + sum(K.q);
+n = round(m / 3);
+
+z = randn(m, 1);
+y = z;
+y(K.z + 1:K.z + K.l) = max(z(K.z + 1:K.z + K.l), 0);
+idx = K.z + K.l;
+for j = 1:numel(K.q)
+    rows = idx + 1:idx + K.q(j);
+    y(rows) = proj_soc(z(rows));
+    idx = idx + K.q(j);
+end
+s = y - z;
+
+data.A = sprandn(m, n, min(1, 20 / m));
+x = randn(n, 1);
+data.c = -data.A' * y;
+data.b = data.A * x + s;
+end
+
+function v = proj_soc(v)
+t = v(1);
+nu = norm(v(2:end));
+if nu <= t
+    return
+elseif nu <= -t
+    v(:) = 0;
+else
+    v = (t + nu) / 2 * [1; v(2:end) / nu];
+end
+end
+
+function [data, K] = lasso(scale, seed)
+% Variables [x; t; r]: min 0.5*r'*r + mu*sum(t), r = A*x - b, -t <= x <= t
+rng(seed, 'twister')
+n = 1000 * scale;
+m = ceil(n / 5);
+nz = ceil(n / 10);
+x_true = [randn(nz, 1); zeros(n - nz, 1)];
+x_true = x_true(randperm(n));
+A = sprandn(m, n, min(1, 20 / m));
+b = A * x_true + 0.1 * randn(m, 1);
+mu = 1;
+
+I = speye(n);
+data.P = blkdiag(sparse(2 * n, 2 * n), speye(m));
+data.c = [zeros(n, 1); mu * ones(n, 1); zeros(m, 1)];
+data.A = [-A, sparse(m, n), speye(m);
+          I, -I, sparse(n, m);
+          -I, -I, sparse(n, m)];
+data.b = [-b; zeros(2 * n, 1)];
+K.z = m;
+K.l = 2 * n;
+end
+
+function [data, K] = portfolio(scale, seed)
+% Variables [x; y]: min -mu'*x + gamma*(y'*y + sum((D.*x).^2)),
+% y = F'*x, sum(x) = 1, x >= 0
+rng(seed, 'twister')
+n = 1000 * scale;
+k = 10 * scale;
+mu = exp(0.01 * randn(n, 1)) - 1;
+D = rand(n, 1) / 10;
+F = sprandn(n, k, 0.1) / 10;
+gamma = 1;
+
+data.P = 2 * gamma * blkdiag(spdiags(D.^2, 0, n, n), speye(k));
+data.c = [-mu; zeros(k, 1)];
+data.A = [F', -speye(k);
+          ones(1, n), sparse(1, k);
+          -speye(n), sparse(n, k)];
+data.b = [zeros(k, 1); 1; zeros(n, 1)];
+K.z = k + 1;
+K.l = n;
+end
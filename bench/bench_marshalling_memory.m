@@ -0,0 +1,61 @@
+function results = bench_marshalling_memory(ms, backend)
+% BENCH_MARSHALLING_MEMORY  Peak-RSS cost of moving data through the mex layer.
+%
+%   results = bench_marshalling_memory()
+%   results = bench_marshalling_memory(ms, backend)
+%
+%   Builds an LP with m rows (for each m in ms, default [1e6 4e6 1.6e7])
+%   and n = 10 columns, then runs a single-iteration warm-started solve so
+%   that solver work is negligible and the peak resident set size is
+%   dominated by how inputs, warm starts and outputs are marshalled.
+%
+%   For each size it reports the peak RSS growth during the call (MB) and
+%   that growth divided by the size of one m-vector, so builds can be
+%   compared: every extra copy of y or s on the way in or out adds about
+%   one unit per vector. Linux only (reads /proc/self/status and resets
+%   the high-water mark through /proc/self/clear_refs).
+%
+%   Run once per build (e.g. before/after a change) and compare the
+%   'vec_copies' column.
+
+if nargin < 1 || isempty(ms)
+    ms = [1e6, 4e6, 1.6e7];
+end
+if nargin < 2
+    backend = 'scs_indirect';
+end
+if ~isunix || ismac
+    error('bench_marshalling_memory needs Linux /proc accounting.');
+end
+
+n = 10;
+pars = struct('verbose', 0, 'max_iters', 1, 'normalize', 0, ...
+    'acceleration_lookback', 0);
+results = struct('m', {}, 'peak_mb', {}, 'vec_copies', {});
+
+for m = ms
+    rng(1)
+    data.A = sprandn(m, n, 1 / m * 5) + [speye(n); sparse(m - n, n)];
+    data.b = ones(m, 1);
+    data.c = zeros(n, 1);
+    data.x = zeros(n, 1);
+    data.y = ones(m, 1);
+    data.s = ones(m, 1);
+    cone = struct('l', m);
+
+    % one warm-up call so MATLAB/mex one-time allocations are excluded
+    feval(backend, data, cone, pars);
+
+    base = reset_peak();
+    [x, y, s] = feval(backend, data, cone, pars); %#ok<ASGLU>
+    peak = read_status_kb('VmHWM');
+    clear x y s
+
+    vec_mb = 8 * m / 2^20;
+    peak_mb = (peak - base) / 2^10;
+    results(end + 1) = struct('m', m, 'peak_mb', peak_mb, ...
+        'vec_copies', peak_mb / vec_mb); %#ok<AGROW>
+    fprintf('m = %9d  peak growth = %9.1f MB  (%5.2f m-vectors)\n', ...
+        m, peak_mb, peak_mb / vec_mb);
+end
+end
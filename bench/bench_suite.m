@@ -0,0 +1,190 @@
+function report = bench_suite(varargin)
+% BENCH_SUITE  Benchmark all backends on a fixed corpus and check regressions.
+%
+%   report = bench_suite()
+%   report = bench_suite('name', value, ...)
+%
+%   Runs every problem of bench_corpus on each backend in every variant
+%   and records status, iterations, setup/solve/lin_sys/cone/accel time
+%   (ms, best of 'repeats' runs) and peak memory growth (MB, Linux only,
+%   NaN elsewhere). Variants:
+%
+%     cold     one-shot solve from scratch (scs_xxx(data, K, pars))
+%     warm     scs_init, one solve, then b perturbed by 1e-3 and solved
+%              again warm-started from the first solution; the second
+%              solve is recorded
+%     serial / openmp
+%              for scs_matlab_direct and scs_supernodal,
+%              lin_sys_threads = 1 or the OpenMP default; the other
+%              backends take their thread count from OMP_NUM_THREADS at
+%              MATLAB start and are run once ('-')
+%
+%   Options:
+%     sizes       corpus sizes, see bench_corpus (default {'small'})
+%     backends    default {'scs_direct', 'scs_indirect', 'scs_dense',
+%                 'scs_matlab_direct', 'scs_supernodal'}; backends that
+%                 are not built are skipped, scs_dense runs on 'small'
+%                 problems only
+%     variants    default {'cold', 'warm'}
+%     repeats     runs per case, timings are the best (default 3)
+%     pars        extra solver settings (default eps_abs = eps_rel = 1e-5)
+%     output      write the report as JSON to this file ('' = don't)
+%     baseline    JSON report (or report struct) to compare against
+%     thresholds  struct of allowed relative increases, see bench_compare
+%
+%   report has fields meta (machine, MATLAB version, date, options) and
+%   results (one element per case), plus regressions when a baseline is
+%   given. Make a baseline by saving the report of a trusted build:
+%
+%     bench_suite('sizes', {'small', 'medium'}, 'output', 'base.json');
+%     % ... rebuild ...
+%     r = bench_suite('sizes', {'small', 'medium'}, 'baseline', 'base.json');
+%
+%   Timings only compare on the same machine and build configuration.
+
+opts = struct('sizes', {{'small'}}, ...
+    'backends', {{'scs_direct', 'scs_indirect', 'scs_dense', ...
+                  'scs_matlab_direct', 'scs_supernodal'}}, ...
+    'variants', {{'cold', 'warm'}}, 'repeats', 3, ...
+    'pars', struct('eps_abs', 1e-5, 'eps_rel', 1e-5), ...
+    'output', '', 'baseline', [], 'thresholds', struct());
+for i = 1:2:numel(varargin)
+    if ~isfield(opts, varargin{i})
+        error('Unknown option ''%s''.', varargin{i});
+    end
+    opts.(varargin{i}) = varargin{i + 1};
+end
+
+report.meta = struct('computer', computer, 'matlab', version, ...
+    'date', datestr(now, 'yyyy-mm-dd HH:MM:SS'), ...
+    'omp_num_threads', getenv('OMP_NUM_THREADS'), ...
+    'max_comp_threads', maxNumCompThreads, 'options', opts);
+report.results = struct('problem', {}, 'size', {}, 'backend', {}, ...
+    'variant', {}, 'threads', {}, 'status', {}, 'iter', {}, ...
+    'setup_time', {}, 'solve_time', {}, 'lin_sys_time', {}, ...
+    'cone_time', {}, 'accel_time', {}, 'peak_mb', {});
+
+corpus = bench_corpus(opts.sizes);
+for p = 1:numel(corpus)
+    prob = corpus(p);
+    for b = 1:numel(opts.backends)
+        backend = opts.backends{b};
+        if exist(backend, 'file') ~= 3
+            continue
+        end
+        if strcmp(backend, 'scs_dense') && ~strcmp(prob.size, 'small')
+            continue
+        end
+        if any(strcmp(backend, {'scs_matlab_direct', 'scs_supernodal'}))
+            threads = {'serial', 'openmp'};
+        else
+            threads = {'-'};
+        end
+        for v = 1:numel(opts.variants)
+            for t = 1:numel(threads)
+                r = run_case(prob, backend, opts.variants{v}, ...
+                    threads{t}, opts);
+                report.results(end + 1) = r;
+                fprintf(['%-12s %-7s %-18s %-5s %-7s %-8s %6d it  ' ...
+                    'setup %9.1f  solve %9.1f ms  peak %8.1f MB\n'], ...
+                    r.problem, r.size, r.backend, r.variant, r.threads, ...
+                    r.status, r.iter, r.setup_time, r.solve_time, r.peak_mb);
+            end
+        end
+    end
+end
+
+if ~isempty(opts.baseline)
+    report.regressions = bench_compare(report, opts.baseline, ...
+        opts.thresholds);
+end
+if ~isempty(opts.output)
+    fid = fopen(opts.output, 'w');
+    if fid < 0
+        error('Cannot write %s.', opts.output);
+    end
+    fprintf(fid, '%s', jsonencode(report));
+    fclose(fid);
+end
+end
+
+function r = run_case(prob, backend, variant, threads, opts)
+pars = opts.pars;
+pars.verbose = 0;
+switch threads
+    case 'serial'
+        pars.lin_sys_threads = 1;
+    case 'openmp'
+        pars.lin_sys_threads = 0;
+end
+names = {'setup_time', 'solve_time', 'lin_sys_time', 'cone_time', ...
+    'accel_time'};
+best = inf(1, numel(names));
+peak_mb = NaN;
+for rep = 1:opts.repeats
+    if rep == 1
+        base = peak_reset();
+    end
+    info = solve_variant(prob, backend, variant, pars);
+    if rep == 1
+        peak_mb = (peak_kb() - base) / 2^10;
+    end
+    for i = 1:numel(names)
+        best(i) = min(best(i), info.(names{i}));
+    end
+end
+r = struct('problem', prob.name, 'size', prob.size, 'backend', backend, ...
+    'variant', variant, 'threads', threads, 'status', info.status, ...
+    'iter', info.iter, 'setup_time', best(1), 'solve_time', best(2), ...
+    'lin_sys_time', best(3), 'cone_time', best(4), 'accel_time', best(5), ...
+    'peak_mb', peak_mb);
+end
+
+function info = solve_variant(prob, backend, variant, pars)
+switch variant
+    case 'cold'
+        [~, ~, ~, info] = feval(backend, prob.data, prob.K, pars);
+    case 'warm'
+        work = scs_init(prob.data, prob.K, backend_pars(backend, pars));
+        cleanup = onCleanup(@() scs_finish(work));
+        [x, y, s] = scs_solve(work);
+        rng(1, 'twister')
+        b = prob.data.b .* (1 + 1e-3 * randn(size(prob.data.b)));
+        scs_update(work, b, []);
+        [~, ~, ~, info] = scs_solve(work, struct('x', x, 'y', y, 's', s));
+    otherwise
+        error('Unknown variant ''%s''.', variant);
+end
+end
+
+function pars = backend_pars(backend, pars)
+% select backend through scs_init's flags
+switch backend
+    case 'scs_indirect'
+        pars.use_indirect = true;
+    case 'scs_dense'
+        pars.dense = true;
+    case 'scs_direct'
+        pars.use_qdldl = true;
+    case 'scs_gpu'
+        pars.gpu = true;
+    case 'scs_supernodal'
+        pars.supernodal = true;
+end
+end
+
+function kb = peak_reset()
+if isunix && ~ismac
+    kb = reset_peak();
+else
+    kb = NaN;
+end
+end
+
+function kb = peak_kb()
+if isunix && ~ismac
+    kb = read_status_kb('VmHWM');
+else
+    kb = NaN;
+end
+end
@@ -0,0 +1,59 @@
+function results = bench_trisolve(threads, ns)
+% BENCH_TRISOLVE  Per-iteration time of the MATLAB-LDL backend vs threads.
+%
+%   results = bench_trisolve()
+%   results = bench_trisolve(threads, ns)
+%
+%   Builds a sparse QP with n variables and 2n constraints (for each n in
+%   ns, default [2e4 1e5 4e5]) and runs a fixed number of iterations of
+%   scs_matlab_direct with lin_sys_threads set to each entry of threads
+%   (default [1 2 4 8]). Adaptive scaling is off, so there are no
+%   refactorizations and the iteration time is dominated by the
+%   triangular solves with the cached factors. lin_sys_threads = 1 is the
+%   serial sweep; the others use the level-scheduled parallel solve when
+%   the factor is large enough (needs an OpenMP build).
+%
+%   Reports the mean time per iteration (ms) and the speed-up over the
+%   serial sweep.
+
+if nargin < 1 || isempty(threads)
+    threads = [1 2 4 8];
+end
+if nargin < 2 || isempty(ns)
+    ns = [2e4, 1e5, 4e5];
+end
+
+iters = 50;
+pars = struct('verbose', 0, 'max_iters', iters, 'eps_abs', 1e-12, ...
+    'eps_rel', 1e-12, 'adaptive_scale', 0, 'acceleration_lookback', 0);
+results = struct('n', {}, 'threads', {}, 'ms_per_iter', {}, 'speedup', {});
+
+for n = ns
+    rng(1)
+    m = 2 * n;
+    data.P = sprandsym(n, 5 / n) + n * 1e-4 * speye(n);
+    data.P = data.P' * data.P;
+    data.A = [speye(n); sprandn(m - n, n, 5 / n)];
+    data.b = rand(m, 1);
+    data.c = randn(n, 1);
+    cone = struct('l', m);
+
+    serial = NaN;
+    for t = threads
+        pars.lin_sys_threads = t;
+        % best of three to reduce timer noise
+        best = Inf;
+        for rep = 1:3
+            [~, ~, ~, info] = scs_matlab_direct(data, cone, pars);
+            best = min(best, info.solve_time / info.iter);
+        end
+        if t == 1
+            serial = best;
+        end
+        results(end + 1) = struct('n', n, 'threads', t, ...
+            'ms_per_iter', best, 'speedup', serial / best); %#ok<AGROW>
+        fprintf('n = %7d  threads = %2d  %8.3f ms/iter  (x%.2f)\n', ...
+            n, t, best, serial / best);
+    end
+end
+end
@@ -0,0 +1,354 @@
+/* Native benchmark of the scs mex layer, linked against the stub MEX API in
+ * mex_stub/ (see the Makefile). Builds a seeded sparse LP or QP as mxArrays
+ * and times, per call of mexFunction:
+ *
+ *   one-shot  [x, y, s, info] = scs_xxx(data, cone, settings)
+ *   init      handle = scs_xxx('init', data, cone, settings)
+ *   solve     [x, y, s, info] = scs_xxx('solve', handle)
+ *
+ * next to the setup and solve times that SCS itself reports in info, so the
+ * difference is the cost of the mex layer (parsing, copies in and out,
+ * workspace bookkeeping). Intended to be run under perf, valgrind
+ * (callgrind, massif) or sanitizers.
+ *
+ * Usage: bench_mex [-n cols] [-m rows] [-d density] [-q] [-r reps]
+ *                  [-i max_iters] [-t lin_sys_threads] [-b backend] [-v]
+ *
+ * The problem has box constraints -1 <= x <= 1 in its first 2n rows, so
+ * m >= 2n (default 3n), and m - 2n random sparse rows below them with the
+ * given density; -q adds a tridiagonal positive definite P. -b sets the
+ * lin_sys_backend setting of the unified build (bench_mex_unified). */
+
+#define _POSIX_C_SOURCE 199309L /* clock_gettime */
+
+#include "mex.h"
+
+#include <math.h>
+#include <stddef.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+typedef struct {
+  size_t m, n;
+  double density;
+  int qp, reps, max_iters, threads, verbose;
+  const char *backend;
+} BenchOpts;
+
+typedef struct {
+  double wall, setup, solve, lin_sys; /* ms */
+  double iter;
+} BenchSample;
+
+static unsigned long long rng_state = 88172645463325252ULL;
+
+static double rand_unif(void) {
+  rng_state ^= rng_state << 13;
+  rng_state ^= rng_state >> 7;
+  rng_state ^= rng_state << 17;
+  return (double)(rng_state >> 11) / 9007199254740992.0;
+}
+
+static double rand_normal(void) {
+  double u = rand_unif(), v = rand_unif();
+  return sqrt(-2. * log(u + 1e-300)) * cos(6.283185307179586 * v);
+}
+
+static double now_ms(void) {
+  struct timespec t;
+  clock_gettime(CLOCK_MONOTONIC, &t);
+  return 1e3 * (double)t.tv_sec + 1e-6 * (double)t.tv_nsec;
+}
+
+static int cmp_double(const void *a, const void *b) {
+  double x = *(const double *)a, y = *(const double *)b;
+  return (x > y) - (x < y);
+}
+
+static int cmp_index(const void *a, const void *b) {
+  mwIndex x = *(const mwIndex *)a, y = *(const mwIndex *)b;
+  return (x > y) - (x < y);
+}
+
+/* A = [I; -I; R] with R random sparse, b = [1; 1; R x0 + s0] with
+ * |x0| < 1/2 and s0 > 0, so the problem is strictly feasible and bounded */
+static mxArray *create_data(const BenchOpts *o) {
+  const char *fields[] = {"A", "b", "c", "P"};
+  size_t m = o->m, n = o->n, mr = m - 2 * n, j, k, q, per_col;
+  mxArray *data = mxCreateStructMatrix(1, 1, o->qp ? 4 : 3, fields);
+  mxArray *A, *b, *c;
+  mwIndex *jc, *ir;
+  double *pr, *x0, *bx;
+
+  per_col = mr > 0 ? (size_t)ceil(o->density * (double)mr) : 0;
+  per_col = per_col > mr ? mr : per_col;
+  A = mxCreateSparse(m, n, n * (2 + per_col), mxREAL);
+  jc = mxGetJc(A);
+  ir = mxGetIr(A);
+  pr = mxGetPr(A);
+  q = 0;
+  for (j = 0; j < n; j++) {
+    size_t start, end;
+    jc[j] = q;
+    ir[q] = j;
+    pr[q++] = 1.;
+    ir[q] = n + j;
+    pr[q++] = -1.;
+    start = q;
+    for (k = 0; k < per_col; k++) {
+      ir[q++] = 2 * n + (mwIndex)(rand_unif() * (double)mr);
+    }
+    qsort(&ir[start], q - start, sizeof(mwIndex), cmp_index);
+    /* drop duplicate rows */
+    end = q;
+    q = start;
+    for (k = start; k < end; k++) {
+      if (q > start && ir[k] == ir[q - 1]) {
+        continue;
+      }
+      ir[q] = ir[k];
+      pr[q++] = rand_normal();
+    }
+  }
+  jc[n] = q;
+
+  x0 = (double *)calloc(n, sizeof(double));
+  b = mxCreateDoubleMatrix(m, 1, mxREAL);
+  c = mxCreateDoubleMatrix(n, 1, mxREAL);
+  bx = mxGetPr(b);
+  for (j = 0; j < n; j++) {
+    x0[j] = 0.5 * (2. * rand_unif() - 1.);
+    mxGetPr(c)[j] = rand_normal();
+  }
+  for (j = 0; j < n; j++) {
+    for (k = jc[j]; k < jc[j + 1]; k++) {
+      bx[ir[k]] += pr[k] * x0[j];
+    }
+  }
+  for (k = 0; k < m; k++) {
+    bx[k] = k < 2 * n ? 1. : bx[k] + rand_unif();
+  }
+  free(x0);
+  mxSetField(data, 0, "A", A);
+  mxSetField(data, 0, "b", b);
+  mxSetField(data, 0, "c", c);
+
+  if (o->qp) {
+    /* triu of tridiag(-1, 2.5, -1) */
+    mxArray *P = mxCreateSparse(n, n, 2 * n, mxREAL);
+    jc = mxGetJc(P);
+    ir = mxGetIr(P);
+    pr = mxGetPr(P);
+    q = 0;
+    for (j = 0; j < n; j++) {
+      jc[j] = q;
+      if (j > 0) {
+        ir[q] = j - 1;
+        pr[q++] = -1.;
+      }
+      ir[q] = j;
+      pr[q++] = 2.5;
+    }
+    jc[n] = q;
+    mxSetField(data, 0, "P", P);
+  }
+  return data;
+}
+
+static mxArray *create_cone(const BenchOpts *o) {
+  const char *fields[] = {"l"};
+  mxArray *cone = mxCreateStructMatrix(1, 1, 1, fields);
+  mxSetField(cone, 0, "l", mxCreateDoubleScalar((double)o->m));
+  return cone;
+}
+
+static mxArray *create_settings(const BenchOpts *o) {
+  const char *fields[] = {"verbose", "max_iters"};
+  mxArray *stgs = mxCreateStructMatrix(1, 1, 2, fields);
+  mxSetField(stgs, 0, "verbose", mxCreateDoubleScalar(o->verbose));
+  mxSetField(stgs, 0, "max_iters", mxCreateDoubleScalar(o->max_iters));
+  if (o->threads > 0) {
+    mxAddField(stgs, "lin_sys_threads");
+    mxSetField(stgs, 0, "lin_sys_threads", mxCreateDoubleScalar(o->threads));
+  }
+  if (o->backend) {
+    mxAddField(stgs, "lin_sys_backend");
+    mxSetField(stgs, 0, "lin_sys_backend", mxCreateString(o->backend));
+  }
+  return stgs;
+}
+
+static double info_field(const mxArray *info, const char *name) {
+  const mxArray *f = mxGetField(info, 0, name);
+  return f ? mxGetScalar(f) : 0.;
+}
+
+static void destroy_outputs(mxArray **plhs, int n) {
+  int i;
+  for (i = 0; i < n; i++) {
+    mxDestroyArray(plhs[i]);
+    plhs[i] = NULL;
+  }
+}
+
+static void call_or_die(int nlhs, mxArray **plhs, int nrhs,
+                        const mxArray **prhs) {
+  if (mexStubCall(nlhs, plhs, nrhs, prhs) < 0) {
+    fprintf(stderr, "mex error: %s\n", mexStubLastError());
+    exit(1);
+  }
+}
+
+/* Median and minimum of the samples' field at offset off */
+static void report(const char *name, BenchSample *s, int reps, size_t off) {
+  double *v = (double *)malloc(reps * sizeof(double));
+  int i;
+  for (i = 0; i < reps; i++) {
+    v[i] = *(double *)((char *)&s[i] + off);
+  }
+  qsort(v, reps, sizeof(double), cmp_double);
+  printf("  %-26s %12.3f %12.3f\n", name, v[reps / 2], v[0]);
+  free(v);
+}
+
+static void report_samples(const char *phase, BenchSample *s, int reps,
+                           int has_setup) {
+  int i;
+  printf("%s (%d calls, %.0f iterations)\n", phase, reps, s[0].iter);
+  printf("  %-26s %12s %12s\n", "ms", "median", "min");
+  report("wall", s, reps, offsetof(BenchSample, wall));
+  if (has_setup) {
+    report("scs setup", s, reps, offsetof(BenchSample, setup));
+  }
+  report("scs solve", s, reps, offsetof(BenchSample, solve));
+  report("  of which linear system", s, reps, offsetof(BenchSample, lin_sys));
+  /* mex overhead = wall - setup - solve */
+  for (i = 0; i < reps; i++) {
+    s[i].wall -= s[i].solve + (has_setup ? s[i].setup : 0.);
+  }
+  report("mex layer", s, reps, offsetof(BenchSample, wall));
+}
+
+static void sample_info(BenchSample *s, double wall, const mxArray *info) {
+  s->wall = wall;
+  s->setup = info_field(info, "setup_time");
+  s->solve = info_field(info, "solve_time");
+  s->lin_sys = info_field(info, "lin_sys_time");
+  s->iter = info_field(info, "iter");
+}
+
+static void usage(void) {
+  fprintf(stderr, "usage: bench_mex [-n cols] [-m rows] [-d density] [-q] "
+                  "[-r reps] [-i max_iters] [-t lin_sys_threads] "
+                  "[-b backend] [-v]\n");
+  exit(2);
+}
+
+int main(int argc, char **argv) {
+  BenchOpts o = {0, 10000, 1e-3, 0, 5, 100, 0, 0, NULL};
+  BenchSample *s;
+  mxArray *data, *cone, *stgs, *cmd, *handle;
+  mxArray *plhs[4] = {NULL, NULL, NULL, NULL};
+  const mxArray *prhs[4];
+  double t, init_ms;
+  char *solver, *status;
+  int i;
+
+  for (i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-q") == 0) {
+      o.qp = 1;
+    } else if (strcmp(argv[i], "-v") == 0) {
+      o.verbose = 1;
+    } else if (i + 1 < argc && strcmp(argv[i], "-n") == 0) {
+      o.n = (size_t)atol(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-m") == 0) {
+      o.m = (size_t)atol(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-d") == 0) {
+      o.density = atof(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-r") == 0) {
+      o.reps = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-i") == 0) {
+      o.max_iters = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-t") == 0) {
+      o.threads = atoi(argv[++i]);
+    } else if (i + 1 < argc && strcmp(argv[i], "-b") == 0) {
+      o.backend = argv[++i];
+    } else {
+      usage();
+    }
+  }
+  if (o.m == 0) {
+    o.m = 3 * o.n;
+  }
+  if (o.n == 0 || o.m < 2 * o.n || o.reps < 1) {
+    usage();
+  }
+  mexStubSetQuiet(!o.verbose);
+
+  data = create_data(&o);
+  cone = create_cone(&o);
+  stgs = create_settings(&o);
+  s = (BenchSample *)calloc(o.reps, sizeof(BenchSample));
+
+  /* one-shot */
+  prhs[0] = data;
+  prhs[1] = cone;
+  prhs[2] = stgs;
+  for (i = 0; i < o.reps; i++) {
+    t = now_ms();
+    call_or_die(4, plhs, 3, prhs);
+    sample_info(&s[i], now_ms() - t, plhs[3]);
+    if (i == 0) {
+      solver = mxArrayToString(mxGetField(plhs[3], 0, "lin_sys_solver"));
+      status = mxArrayToString(mxGetField(plhs[3], 0, "status"));
+      printf("%s: m = %zu, n = %zu, nnz(A) = %zu%s, status %s\n\n", solver,
+             o.m, o.n, (size_t)mxGetJc(mxGetField(data, 0, "A"))[o.n],
+             o.qp ? ", QP" : "", status);
+      mxFree(solver);
+      mxFree(status);
+    }
+    destroy_outputs(plhs, 4);
+  }
+  report_samples("one-shot", s, o.reps, 1);
+
+  /* workspace: init once, then repeated solves */
+  cmd = mxCreateString("init");
+  prhs[0] = cmd;
+  prhs[1] = data;
+  prhs[2] = cone;
+  prhs[3] = stgs;
+  t = now_ms();
+  call_or_die(1, plhs, 4, prhs);
+  init_ms = now_ms() - t;
+  handle = plhs[0];
+  plhs[0] = NULL;
+  mxDestroyArray(cmd);
+
+  cmd = mxCreateString("solve");
+  prhs[0] = cmd;
+  prhs[1] = handle;
+  for (i = 0; i < o.reps; i++) {
+    t = now_ms();
+    call_or_die(4, plhs, 2, prhs);
+    sample_info(&s[i], now_ms() - t, plhs[3]);
+    destroy_outputs(plhs, 4);
+  }
+  printf("\ninit: %.3f ms\n", init_ms);
+  report_samples("solve", s, o.reps, 0);
+  mxDestroyArray(cmd);
+
+  cmd = mxCreateString("finish");
+  prhs[0] = cmd;
+  call_or_die(0, plhs, 2, prhs);
+  mxDestroyArray(cmd);
+  mxDestroyArray(handle);
+
+  mexStubExit();
+  mxDestroyArray(data);
+  mxDestroyArray(cone);
+  mxDestroyArray(stgs);
+  free(s);
+  return 0;
+}
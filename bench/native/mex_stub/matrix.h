@@ -0,0 +1,122 @@
+#ifndef MATRIX_H_GUARD
+#define MATRIX_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stand-in for MATLAB's matrix.h: the part of the mxArray API used by
+ * src/scs_mex.c and the linear system backends, implemented on libc by
+ * mex_stub.c so that the mex sources build and run outside MATLAB. Layout
+ * follows the -largeArrayDims (64-bit index) API that make_scs.m builds
+ * with; arrays are real, dense numeric arrays are column-major and sparse
+ * ones are CSC with sorted row indices, as in MATLAB. */
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+typedef struct mxArray_tag mxArray;
+
+typedef size_t mwSize;
+typedef size_t mwIndex;
+typedef ptrdiff_t mwSignedIndex;
+typedef uint16_t mxChar;
+
+typedef uint64_t uint64_T;
+typedef int64_t int64_T;
+typedef uint32_t uint32_T;
+typedef int32_t int32_T;
+
+typedef enum {
+  mxUNKNOWN_CLASS,
+  mxCELL_CLASS,
+  mxSTRUCT_CLASS,
+  mxLOGICAL_CLASS,
+  mxCHAR_CLASS,
+  mxVOID_CLASS,
+  mxDOUBLE_CLASS,
+  mxSINGLE_CLASS,
+  mxINT8_CLASS,
+  mxUINT8_CLASS,
+  mxINT16_CLASS,
+  mxUINT16_CLASS,
+  mxINT32_CLASS,
+  mxUINT32_CLASS,
+  mxINT64_CLASS,
+  mxUINT64_CLASS
+} mxClassID;
+
+typedef enum { mxREAL, mxCOMPLEX } mxComplexity;
+
+/* Memory: plain malloc, nothing is freed automatically when a mex call
+ * returns (MATLAB frees non-persistent mxMalloc memory there) */
+void *mxMalloc(size_t n);
+void *mxCalloc(size_t n, size_t size);
+void *mxRealloc(void *ptr, size_t size);
+void mxFree(void *ptr);
+
+/* Creation and destruction. Only mxREAL is supported. */
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag);
+mxArray *mxCreateDoubleScalar(double value);
+mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID classid,
+                               mxComplexity flag);
+mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims,
+                              mxClassID classid, mxComplexity flag);
+mxArray *mxCreateSparse(mwSize m, mwSize n, mwSize nzmax, mxComplexity flag);
+mxArray *mxCreateString(const char *str);
+mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfields,
+                              const char **fieldnames);
+mxArray *mxCreateStructArray(mwSize ndim, const mwSize *dims, int nfields,
+                             const char **fieldnames);
+mxArray *mxDuplicateArray(const mxArray *pa);
+void mxDestroyArray(mxArray *pa);
+
+/* Type queries */
+mxClassID mxGetClassID(const mxArray *pa);
+bool mxIsDouble(const mxArray *pa);
+bool mxIsSingle(const mxArray *pa);
+bool mxIsUint64(const mxArray *pa);
+bool mxIsNumeric(const mxArray *pa);
+bool mxIsChar(const mxArray *pa);
+bool mxIsStruct(const mxArray *pa);
+bool mxIsSparse(const mxArray *pa);
+bool mxIsComplex(const mxArray *pa);
+bool mxIsEmpty(const mxArray *pa);
+
+/* Dimensions */
+mwSize mxGetNumberOfDimensions(const mxArray *pa);
+const mwSize *mxGetDimensions(const mxArray *pa);
+size_t mxGetM(const mxArray *pa);
+size_t mxGetN(const mxArray *pa);
+size_t mxGetNumberOfElements(const mxArray *pa);
+
+/* Data */
+double *mxGetPr(const mxArray *pa);
+void *mxGetData(const mxArray *pa);
+double mxGetScalar(const mxArray *pa);
+double mxGetNaN(void);
+double mxGetInf(void);
+
+/* Sparse accessors */
+mwIndex *mxGetIr(const mxArray *pa);
+mwIndex *mxGetJc(const mxArray *pa);
+mwSize mxGetNzmax(const mxArray *pa);
+
+/* Strings. mxArrayToString returns mxMalloc'd memory. */
+char *mxArrayToString(const mxArray *pa);
+int mxGetString(const mxArray *pa, char *buf, mwSize buflen);
+
+/* Struct fields. mxSetField neither frees the old value nor creates the
+ * field; mxAddField returns the new field number or -1. */
+int mxGetNumberOfFields(const mxArray *pa);
+const char *mxGetFieldNameByNumber(const mxArray *pa, int n);
+int mxGetFieldNumber(const mxArray *pa, const char *name);
+mxArray *mxGetField(const mxArray *pa, mwIndex i, const char *name);
+void mxSetField(mxArray *pa, mwIndex i, const char *name, mxArray *value);
+int mxAddField(mxArray *pa, const char *name);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
@@ -0,0 +1,75 @@
+#ifndef MEX_H_GUARD
+#define MEX_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Stand-in for MATLAB's mex.h, see matrix.h. The mexStub* functions are not
+ * part of the MATLAB API: they are how a native driver calls a mex file
+ * built against this stub and plugs in the MATLAB functions it calls back
+ * (mexCallMATLAB / mexCallMATLABWithTrap). */
+
+#include "matrix.h"
+
+#if defined(__GNUC__)
+#define MEX_STUB_NORETURN __attribute__((noreturn))
+#else
+#define MEX_STUB_NORETURN
+#endif
+
+/* Entry point of the mex file under test */
+void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+
+/* Errors unwind to the enclosing mexStubCall (abort outside of one) */
+MEX_STUB_NORETURN void mexErrMsgTxt(const char *msg);
+MEX_STUB_NORETURN void mexErrMsgIdAndTxt(const char *id, const char *fmt,
+                                         ...);
+void mexWarnMsgTxt(const char *msg);
+int mexPrintf(const char *fmt, ...);
+
+int mexAtExit(void (*exit_fcn)(void));
+void mexMakeArrayPersistent(mxArray *pa);
+void mexMakeMemoryPersistent(void *ptr);
+int mexEvalString(const char *str);
+
+/* Calls a function registered with mexStubRegister. mexCallMATLAB raises
+ * its error with mexErrMsgTxt; mexCallMATLABWithTrap returns it as a struct
+ * with fields 'identifier' and 'message' (an MException in MATLAB), NULL
+ * on success. */
+int mexCallMATLAB(int nlhs, mxArray *plhs[], int nrhs, mxArray *prhs[],
+                  const char *name);
+mxArray *mexCallMATLABWithTrap(int nlhs, mxArray *plhs[], int nrhs,
+                               mxArray *prhs[], const char *name);
+
+/* ---- Stub driver API ---- */
+
+/* A MATLAB function stand-in. Returns NULL on success, else the error
+ * message. */
+typedef const char *(*MexStubFunction)(int nlhs, mxArray *plhs[], int nrhs,
+                                       mxArray *prhs[]);
+
+/* Registers (or replaces) the stand-in for name. 'ldl' is built in (see
+ * mex_stub_ldl.c). Returns 0, -1 if the table is full. */
+int mexStubRegister(const char *name, MexStubFunction fn);
+
+/* Calls mexFunction. Returns 0, or -1 if it raised an error, whose message
+ * mexStubLastError then returns. Outputs set before the error are left in
+ * plhs. */
+int mexStubCall(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]);
+const char *mexStubLastError(void);
+
+/* Drops (quiet = 1) or restores mexPrintf output */
+void mexStubSetQuiet(int quiet);
+
+/* Runs the mexAtExit function, as MATLAB does on 'clear mex' */
+void mexStubExit(void);
+
+/* Built-in stand-in for [L, D, p] = ldl(K, 'vector') */
+const char *mex_stub_ldl(int nlhs, mxArray *plhs[], int nrhs,
+                         mxArray *prhs[]);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
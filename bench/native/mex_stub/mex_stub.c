@@ -0,0 +1,669 @@
+/* libc implementation of the MEX API subset declared in mex.h / matrix.h */
+
+#include "mex.h"
+
+#include <math.h>
+#include <setjmp.h>
+#include <stdarg.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MEX_STUB_MAX_FUNCTIONS (16)
+#define MEX_STUB_MSG_LEN (1024)
+
+struct mxArray_tag {
+  mxClassID classid;
+  bool sparse;
+  mwSize ndim;
+  mwSize *dims;
+  /* Elements (nzmax values if sparse); mxChar for strings; numel x nfields
+   * mxArray pointers, element-major, for structs */
+  void *data;
+  mwIndex *ir, *jc; /* sparse only */
+  mwSize nzmax;
+  int nfields;
+  char **fieldnames;
+};
+
+typedef struct {
+  const char *name;
+  MexStubFunction fn;
+} MexStubEntry;
+
+static MexStubEntry registry[MEX_STUB_MAX_FUNCTIONS];
+static int n_registered = 0;
+static void (*exit_fcn)(void) = NULL;
+static jmp_buf *err_jmp = NULL;
+static char err_msg[MEX_STUB_MSG_LEN];
+static int quiet = 0;
+
+/* ======================== Memory ======================== */
+
+void *mxMalloc(size_t n) {
+  return malloc(n);
+}
+
+void *mxCalloc(size_t n, size_t size) {
+  return calloc(n, size);
+}
+
+void *mxRealloc(void *ptr, size_t size) {
+  return realloc(ptr, size);
+}
+
+void mxFree(void *ptr) {
+  free(ptr);
+}
+
+static void *stub_calloc(size_t n, size_t size) {
+  /* never NULL for an empty array, and out of memory is fatal as in MATLAB */
+  void *p = calloc(n > 0 ? n : 1, size);
+  if (!p) {
+    mexErrMsgTxt("Out of memory.");
+  }
+  return p;
+}
+
+static char *stub_strdup(const char *s) {
+  size_t len = strlen(s) + 1;
+  char *t = (char *)stub_calloc(len, 1);
+  memcpy(t, s, len);
+  return t;
+}
+
+/* ======================== Creation ======================== */
+
+static size_t element_size(mxClassID classid) {
+  switch (classid) {
+  case mxDOUBLE_CLASS:
+  case mxINT64_CLASS:
+  case mxUINT64_CLASS:
+    return 8;
+  case mxSINGLE_CLASS:
+  case mxINT32_CLASS:
+  case mxUINT32_CLASS:
+    return 4;
+  case mxCHAR_CLASS:
+  case mxINT16_CLASS:
+  case mxUINT16_CLASS:
+    return 2;
+  case mxLOGICAL_CLASS:
+  case mxINT8_CLASS:
+  case mxUINT8_CLASS:
+    return 1;
+  case mxSTRUCT_CLASS:
+  case mxCELL_CLASS:
+    return sizeof(mxArray *);
+  default:
+    return 0;
+  }
+}
+
+/* Array header with dims; trailing singleton dimensions past the second are
+ * dropped as in MATLAB */
+static mxArray *create_header(mxClassID classid, mwSize ndim,
+                              const mwSize *dims) {
+  mxArray *pa = (mxArray *)stub_calloc(1, sizeof(mxArray));
+  mwSize i;
+
+  while (ndim > 2 && dims[ndim - 1] == 1) {
+    ndim--;
+  }
+  pa->classid = classid;
+  pa->ndim = ndim < 2 ? 2 : ndim;
+  pa->dims = (mwSize *)stub_calloc(pa->ndim, sizeof(mwSize));
+  for (i = 0; i < pa->ndim; i++) {
+    pa->dims[i] = i < ndim ? dims[i] : 1;
+  }
+  return pa;
+}
+
+mxArray *mxCreateNumericArray(mwSize ndim, const mwSize *dims,
+                              mxClassID classid, mxComplexity flag) {
+  mxArray *pa;
+
+  if (flag != mxREAL) {
+    mexErrMsgTxt("mex stub: complex arrays are not supported.");
+  }
+  if (element_size(classid) == 0 || classid == mxSTRUCT_CLASS ||
+      classid == mxCELL_CLASS) {
+    mexErrMsgTxt("mex stub: unsupported numeric class.");
+  }
+  pa = create_header(classid, ndim, dims);
+  pa->data = stub_calloc(mxGetNumberOfElements(pa), element_size(classid));
+  return pa;
+}
+
+mxArray *mxCreateNumericMatrix(mwSize m, mwSize n, mxClassID classid,
+                               mxComplexity flag) {
+  mwSize dims[2];
+  dims[0] = m;
+  dims[1] = n;
+  return mxCreateNumericArray(2, dims, classid, flag);
+}
+
+mxArray *mxCreateDoubleMatrix(mwSize m, mwSize n, mxComplexity flag) {
+  return mxCreateNumericMatrix(m, n, mxDOUBLE_CLASS, flag);
+}
+
+mxArray *mxCreateDoubleScalar(double value) {
+  mxArray *pa = mxCreateDoubleMatrix(1, 1, mxREAL);
+  *(double *)pa->data = value;
+  return pa;
+}
+
+mxArray *mxCreateSparse(mwSize m, mwSize n, mwSize nzmax, mxComplexity flag) {
+  mwSize dims[2];
+  mxArray *pa;
+
+  if (flag != mxREAL) {
+    mexErrMsgTxt("mex stub: complex arrays are not supported.");
+  }
+  dims[0] = m;
+  dims[1] = n;
+  pa = create_header(mxDOUBLE_CLASS, 2, dims);
+  pa->sparse = true;
+  pa->nzmax = nzmax > 0 ? nzmax : 1;
+  pa->data = stub_calloc(pa->nzmax, sizeof(double));
+  pa->ir = (mwIndex *)stub_calloc(pa->nzmax, sizeof(mwIndex));
+  pa->jc = (mwIndex *)stub_calloc(n + 1, sizeof(mwIndex));
+  return pa;
+}
+
+mxArray *mxCreateString(const char *str) {
+  mwSize dims[2];
+  mxArray *pa;
+  size_t i, len = str ? strlen(str) : 0;
+
+  dims[0] = len > 0 ? 1 : 0;
+  dims[1] = len;
+  pa = create_header(mxCHAR_CLASS, 2, dims);
+  pa->data = stub_calloc(len, sizeof(mxChar));
+  for (i = 0; i < len; i++) {
+    ((mxChar *)pa->data)[i] = (mxChar)(unsigned char)str[i];
+  }
+  return pa;
+}
+
+mxArray *mxCreateStructArray(mwSize ndim, const mwSize *dims, int nfields,
+                             const char **fieldnames) {
+  mxArray *pa = create_header(mxSTRUCT_CLASS, ndim, dims);
+  int f;
+
+  pa->nfields = nfields;
+  pa->fieldnames = (char **)stub_calloc(nfields, sizeof(char *));
+  for (f = 0; f < nfields; f++) {
+    pa->fieldnames[f] = stub_strdup(fieldnames[f]);
+  }
+  pa->data = stub_calloc(mxGetNumberOfElements(pa) * nfields,
+                         sizeof(mxArray *));
+  return pa;
+}
+
+mxArray *mxCreateStructMatrix(mwSize m, mwSize n, int nfields,
+                              const char **fieldnames) {
+  mwSize dims[2];
+  dims[0] = m;
+  dims[1] = n;
+  return mxCreateStructArray(2, dims, nfields, fieldnames);
+}
+
+mxArray *mxDuplicateArray(const mxArray *pa) {
+  mxArray *pb;
+  size_t i, numel;
+
+  if (!pa) {
+    return NULL;
+  }
+  numel = mxGetNumberOfElements(pa);
+  if (pa->classid == mxSTRUCT_CLASS) {
+    mxArray **src = (mxArray **)pa->data, **dst;
+    pb = mxCreateStructArray(pa->ndim, pa->dims, pa->nfields,
+                             (const char **)pa->fieldnames);
+    dst = (mxArray **)pb->data;
+    for (i = 0; i < numel * (size_t)pa->nfields; i++) {
+      dst[i] = mxDuplicateArray(src[i]);
+    }
+    return pb;
+  }
+  if (pa->sparse) {
+    mwSize n = mxGetN(pa);
+    pb = mxCreateSparse(mxGetM(pa), n, pa->nzmax, mxREAL);
+    memcpy(pb->data, pa->data, pa->nzmax * sizeof(double));
+    memcpy(pb->ir, pa->ir, pa->nzmax * sizeof(mwIndex));
+    memcpy(pb->jc, pa->jc, (n + 1) * sizeof(mwIndex));
+    return pb;
+  }
+  pb = create_header(pa->classid, pa->ndim, pa->dims);
+  pb->data = stub_calloc(numel, element_size(pa->classid));
+  memcpy(pb->data, pa->data, numel * element_size(pa->classid));
+  return pb;
+}
+
+void mxDestroyArray(mxArray *pa) {
+  int f;
+
+  if (!pa) {
+    return;
+  }
+  if (pa->classid == mxSTRUCT_CLASS) {
+    mxArray **fields = (mxArray **)pa->data;
+    size_t i, len = mxGetNumberOfElements(pa) * (size_t)pa->nfields;
+    for (i = 0; i < len; i++) {
+      mxDestroyArray(fields[i]);
+    }
+    for (f = 0; f < pa->nfields; f++) {
+      free(pa->fieldnames[f]);
+    }
+    free(pa->fieldnames);
+  }
+  free(pa->data);
+  free(pa->ir);
+  free(pa->jc);
+  free(pa->dims);
+  free(pa);
+}
+
+/* ======================== Queries ======================== */
+
+mxClassID mxGetClassID(const mxArray *pa) {
+  return pa->classid;
+}
+
+bool mxIsDouble(const mxArray *pa) {
+  return pa->classid == mxDOUBLE_CLASS;
+}
+
+bool mxIsSingle(const mxArray *pa) {
+  return pa->classid == mxSINGLE_CLASS;
+}
+
+bool mxIsUint64(const mxArray *pa) {
+  return pa->classid == mxUINT64_CLASS;
+}
+
+bool mxIsNumeric(const mxArray *pa) {
+  return pa->classid >= mxDOUBLE_CLASS;
+}
+
+bool mxIsChar(const mxArray *pa) {
+  return pa->classid == mxCHAR_CLASS;
+}
+
+bool mxIsStruct(const mxArray *pa) {
+  return pa->classid == mxSTRUCT_CLASS;
+}
+
+bool mxIsSparse(const mxArray *pa) {
+  return pa->sparse;
+}
+
+bool mxIsComplex(const mxArray *pa) {
+  (void)pa;
+  return false;
+}
+
+bool mxIsEmpty(const mxArray *pa) {
+  return mxGetNumberOfElements(pa) == 0;
+}
+
+mwSize mxGetNumberOfDimensions(const mxArray *pa) {
+  return pa->ndim;
+}
+
+const mwSize *mxGetDimensions(const mxArray *pa) {
+  return pa->dims;
+}
+
+size_t mxGetM(const mxArray *pa) {
+  return pa->dims[0];
+}
+
+size_t mxGetN(const mxArray *pa) {
+  size_t n = 1;
+  mwSize i;
+  for (i = 1; i < pa->ndim; i++) {
+    n *= pa->dims[i];
+  }
+  return n;
+}
+
+size_t mxGetNumberOfElements(const mxArray *pa) {
+  return pa->dims[0] * mxGetN(pa);
+}
+
+/* ======================== Data ======================== */
+
+double *mxGetPr(const mxArray *pa) {
+  return pa->classid == mxDOUBLE_CLASS ? (double *)pa->data : NULL;
+}
+
+void *mxGetData(const mxArray *pa) {
+  return pa->data;
+}
+
+double mxGetScalar(const mxArray *pa) {
+  if (mxIsEmpty(pa) || (pa->sparse && pa->jc[mxGetN(pa)] == 0)) {
+    return 0.;
+  }
+  switch (pa->classid) {
+  case mxDOUBLE_CLASS:
+    return *(double *)pa->data;
+  case mxSINGLE_CLASS:
+    return *(float *)pa->data;
+  case mxINT64_CLASS:
+    return (double)*(int64_t *)pa->data;
+  case mxUINT64_CLASS:
+    return (double)*(uint64_t *)pa->data;
+  case mxINT32_CLASS:
+    return *(int32_t *)pa->data;
+  case mxUINT32_CLASS:
+    return *(uint32_t *)pa->data;
+  case mxCHAR_CLASS:
+  case mxUINT16_CLASS:
+    return *(uint16_t *)pa->data;
+  case mxINT16_CLASS:
+    return *(int16_t *)pa->data;
+  case mxINT8_CLASS:
+    return *(int8_t *)pa->data;
+  case mxLOGICAL_CLASS:
+  case mxUINT8_CLASS:
+    return *(uint8_t *)pa->data;
+  default:
+    return 0.;
+  }
+}
+
+double mxGetNaN(void) {
+  return NAN;
+}
+
+double mxGetInf(void) {
+  return INFINITY;
+}
+
+mwIndex *mxGetIr(const mxArray *pa) {
+  return pa->ir;
+}
+
+mwIndex *mxGetJc(const mxArray *pa) {
+  return pa->jc;
+}
+
+mwSize mxGetNzmax(const mxArray *pa) {
+  return pa->nzmax;
+}
+
+char *mxArrayToString(const mxArray *pa) {
+  size_t i, len;
+  char *s;
+
+  if (!mxIsChar(pa)) {
+    return NULL;
+  }
+  len = mxGetNumberOfElements(pa);
+  s = (char *)mxMalloc(len + 1);
+  if (!s) {
+    return NULL;
+  }
+  for (i = 0; i < len; i++) {
+    s[i] = (char)((mxChar *)pa->data)[i];
+  }
+  s[len] = '\0';
+  return s;
+}
+
+int mxGetString(const mxArray *pa, char *buf, mwSize buflen) {
+  size_t i, len;
+
+  if (!mxIsChar(pa) || buflen == 0) {
+    return 1;
+  }
+  len = mxGetNumberOfElements(pa);
+  for (i = 0; i < len && i + 1 < buflen; i++) {
+    buf[i] = (char)((mxChar *)pa->data)[i];
+  }
+  buf[i] = '\0';
+  return i < len;
+}
+
+/* ======================== Structs ======================== */
+
+int mxGetNumberOfFields(const mxArray *pa) {
+  return pa->classid == mxSTRUCT_CLASS ? pa->nfields : 0;
+}
+
+const char *mxGetFieldNameByNumber(const mxArray *pa, int n) {
+  if (pa->classid != mxSTRUCT_CLASS || n < 0 || n >= pa->nfields) {
+    return NULL;
+  }
+  return pa->fieldnames[n];
+}
+
+int mxGetFieldNumber(const mxArray *pa, const char *name) {
+  int f;
+  if (pa->classid != mxSTRUCT_CLASS) {
+    return -1;
+  }
+  for (f = 0; f < pa->nfields; f++) {
+    if (strcmp(pa->fieldnames[f], name) == 0) {
+      return f;
+    }
+  }
+  return -1;
+}
+
+mxArray *mxGetField(const mxArray *pa, mwIndex i, const char *name) {
+  int f = mxGetFieldNumber(pa, name);
+  if (f < 0 || i >= mxGetNumberOfElements(pa)) {
+    return NULL;
+  }
+  return ((mxArray **)pa->data)[i * pa->nfields + f];
+}
+
+void mxSetField(mxArray *pa, mwIndex i, const char *name, mxArray *value) {
+  int f = mxGetFieldNumber(pa, name);
+  if (f < 0 || i >= mxGetNumberOfElements(pa)) {
+    return;
+  }
+  ((mxArray **)pa->data)[i * pa->nfields + f] = value;
+}
+
+int mxAddField(mxArray *pa, const char *name) {
+  size_t i, numel;
+  int f, nf;
+  mxArray **old, **fields;
+
+  if (pa->classid != mxSTRUCT_CLASS) {
+    return -1;
+  }
+  f = mxGetFieldNumber(pa, name);
+  if (f >= 0) {
+    return f;
+  }
+  nf = pa->nfields;
+  numel = mxGetNumberOfElements(pa);
+  old = (mxArray **)pa->data;
+  fields = (mxArray **)stub_calloc(numel * (nf + 1), sizeof(mxArray *));
+  for (i = 0; i < numel; i++) {
+    memcpy(&fields[i * (nf + 1)], &old[i * nf], nf * sizeof(mxArray *));
+  }
+  pa->fieldnames =
+      (char **)realloc(pa->fieldnames, (nf + 1) * sizeof(char *));
+  if (!pa->fieldnames) {
+    mexErrMsgTxt("Out of memory.");
+  }
+  pa->fieldnames[nf] = stub_strdup(name);
+  pa->data = fields;
+  pa->nfields = nf + 1;
+  free(old);
+  return nf;
+}
+
+/* ======================== mex functions ======================== */
+
+void mexErrMsgTxt(const char *msg) {
+  if (msg != err_msg) {
+    snprintf(err_msg, MEX_STUB_MSG_LEN, "%s", msg);
+  }
+  if (err_jmp) {
+    longjmp(*err_jmp, 1);
+  }
+  fprintf(stderr, "mex error outside of mexStubCall: %s\n", err_msg);
+  abort();
+}
+
+void mexErrMsgIdAndTxt(const char *id, const char *fmt, ...) {
+  va_list args;
+  (void)id;
+  va_start(args, fmt);
+  vsnprintf(err_msg, MEX_STUB_MSG_LEN, fmt, args);
+  va_end(args);
+  mexErrMsgTxt(err_msg);
+}
+
+void mexWarnMsgTxt(const char *msg) {
+  if (!quiet) {
+    fprintf(stderr, "Warning: %s\n", msg);
+  }
+}
+
+int mexPrintf(const char *fmt, ...) {
+  va_list args;
+  int len;
+  if (quiet) {
+    return 0;
+  }
+  va_start(args, fmt);
+  len = vprintf(fmt, args);
+  va_end(args);
+  return len;
+}
+
+int mexAtExit(void (*fcn)(void)) {
+  exit_fcn = fcn;
+  return 0;
+}
+
+void mexMakeArrayPersistent(mxArray *pa) {
+  (void)pa;
+}
+
+void mexMakeMemoryPersistent(void *ptr) {
+  (void)ptr;
+}
+
+int mexEvalString(const char *str) {
+  (void)str;
+  return 0;
+}
+
+/* MATLAB's interrupt API (libut), declared by src/scs_ctrlc_mex.c itself */
+bool utIsInterruptPending(void) {
+  return false;
+}
+
+bool utSetInterruptEnabled(bool enabled) {
+  (void)enabled;
+  return false;
+}
+
+static MexStubFunction lookup(const char *name) {
+  int i;
+  for (i = 0; i < n_registered; i++) {
+    if (strcmp(registry[i].name, name) == 0) {
+      return registry[i].fn;
+    }
+  }
+  if (strcmp(name, "ldl") == 0) {
+    return mex_stub_ldl;
+  }
+  return NULL;
+}
+
+mxArray *mexCallMATLABWithTrap(int nlhs, mxArray *plhs[], int nrhs,
+                               mxArray *prhs[], const char *name) {
+  const char *fields[] = {"identifier", "message"};
+  char msg[MEX_STUB_MSG_LEN];
+  const char *err;
+  MexStubFunction fn = lookup(name);
+  mxArray *ex;
+
+  if (fn) {
+    err = fn(nlhs, plhs, nrhs, prhs);
+  } else {
+    snprintf(msg, MEX_STUB_MSG_LEN, "Undefined function '%s'.", name);
+    err = msg;
+  }
+  if (!err) {
+    return NULL;
+  }
+  ex = mxCreateStructMatrix(1, 1, 2, fields);
+  mxSetField(ex, 0, "identifier", mxCreateString("MexStub:error"));
+  mxSetField(ex, 0, "message", mxCreateString(err));
+  return ex;
+}
+
+int mexCallMATLAB(int nlhs, mxArray *plhs[], int nrhs, mxArray *prhs[],
+                  const char *name) {
+  mxArray *ex = mexCallMATLABWithTrap(nlhs, plhs, nrhs, prhs, name);
+  if (ex) {
+    char *msg = mxArrayToString(mxGetField(ex, 0, "message"));
+    snprintf(err_msg, MEX_STUB_MSG_LEN, "%s", msg ? msg : name);
+    mxFree(msg);
+    mxDestroyArray(ex);
+    mexErrMsgTxt(err_msg);
+  }
+  return 0;
+}
+
+/* ======================== Stub driver API ======================== */
+
+int mexStubRegister(const char *name, MexStubFunction fn) {
+  int i;
+  for (i = 0; i < n_registered; i++) {
+    if (strcmp(registry[i].name, name) == 0) {
+      registry[i].fn = fn;
+      return 0;
+    }
+  }
+  if (n_registered == MEX_STUB_MAX_FUNCTIONS) {
+    return -1;
+  }
+  registry[n_registered].name = name;
+  registry[n_registered].fn = fn;
+  n_registered++;
+  return 0;
+}
+
+int mexStubCall(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
+  jmp_buf env;
+  jmp_buf *outer = err_jmp;
+
+  err_jmp = &env;
+  if (setjmp(env)) {
+    err_jmp = outer;
+    return -1;
+  }
+  mexFunction(nlhs, plhs, nrhs, prhs);
+  err_jmp = outer;
+  err_msg[0] = '\0';
+  return 0;
+}
+
+const char *mexStubLastError(void) {
+  return err_msg;
+}
+
+void mexStubSetQuiet(int q) {
+  quiet = q;
+}
+
+void mexStubExit(void) {
+  if (exit_fcn) {
+    void (*fcn)(void) = exit_fcn;
+    exit_fcn = NULL;
+    fcn();
+  }
+}
@@ -0,0 +1,227 @@
+/* Stand-in for MATLAB's [L, D, p] = ldl(K, 'vector') on the bundled AMD and
+ * QDLDL, for matrices that need no pivoting such as the quasi-definite SCS
+ * KKT matrix (MATLAB's MA57 may return 2x2 blocks in D; this never does).
+ * Like ldl(), it orders K itself: K(p, p) = L * D * L' with L unit lower
+ * triangular, D diagonal and p a 1-based row vector. */
+
+#include "external/amd/amd.h"
+#include "external/qdldl/qdldl.h"
+#include "glbopts.h"
+#include "mex.h"
+
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct {
+  scs_int *Up, *Ui, *Cp, *Ci, *perm, *pinv, *cnt;
+  scs_float *Ux, *Cx;
+  scs_int *etree, *Lnz, *Lp, *Li, *iwork;
+  scs_float *Lx, *D, *Dinv, *fwork;
+  QDLDL_bool *bwork;
+} LdlStubWork;
+
+static void free_work(LdlStubWork *w) {
+  free(w->Up);
+  free(w->Ui);
+  free(w->Ux);
+  free(w->Cp);
+  free(w->Ci);
+  free(w->Cx);
+  free(w->perm);
+  free(w->pinv);
+  free(w->cnt);
+  free(w->etree);
+  free(w->Lnz);
+  free(w->Lp);
+  free(w->Li);
+  free(w->Lx);
+  free(w->D);
+  free(w->Dinv);
+  free(w->iwork);
+  free(w->fwork);
+  free(w->bwork);
+}
+
+/* Upper triangle of the full symmetric K (mwIndex, double) as scs_int CSC */
+static const char *upper_triangle(const mxArray *K, scs_int n,
+                                  LdlStubWork *w) {
+  const mwIndex *jc = mxGetJc(K), *ir = mxGetIr(K);
+  const double *pr = mxGetPr(K);
+  scs_int j, nz = 0;
+  mwIndex k;
+
+  w->Up = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  w->Ui = (scs_int *)malloc((jc[n] + 1) * sizeof(scs_int));
+  w->Ux = (scs_float *)malloc((jc[n] + 1) * sizeof(scs_float));
+  if (!w->Up || !w->Ui || !w->Ux) {
+    return "ldl stub: out of memory.";
+  }
+  for (j = 0; j < n; j++) {
+    w->Up[j] = nz;
+    for (k = jc[j]; k < jc[j + 1]; k++) {
+      if ((scs_int)ir[k] <= j) {
+        w->Ui[nz] = (scs_int)ir[k];
+        w->Ux[nz] = (scs_float)pr[k];
+        nz++;
+      }
+    }
+  }
+  w->Up[n] = nz;
+  return NULL;
+}
+
+/* C = upper triangle of K(perm, perm) */
+static const char *permute(scs_int n, LdlStubWork *w) {
+  scs_int i, j, k, r, c, q, nz = w->Up[n];
+
+  w->pinv = (scs_int *)malloc(n * sizeof(scs_int));
+  w->cnt = (scs_int *)calloc(n, sizeof(scs_int));
+  w->Cp = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  w->Ci = (scs_int *)malloc((nz + 1) * sizeof(scs_int));
+  w->Cx = (scs_float *)malloc((nz + 1) * sizeof(scs_float));
+  if (!w->pinv || !w->cnt || !w->Cp || !w->Ci || !w->Cx) {
+    return "ldl stub: out of memory.";
+  }
+  for (k = 0; k < n; k++) {
+    w->pinv[w->perm[k]] = k;
+  }
+  for (j = 0; j < n; j++) {
+    for (k = w->Up[j]; k < w->Up[j + 1]; k++) {
+      i = w->Ui[k];
+      w->cnt[MAX(w->pinv[i], w->pinv[j])]++;
+    }
+  }
+  w->Cp[0] = 0;
+  for (j = 0; j < n; j++) {
+    w->Cp[j + 1] = w->Cp[j] + w->cnt[j];
+    w->cnt[j] = w->Cp[j];
+  }
+  for (j = 0; j < n; j++) {
+    for (k = w->Up[j]; k < w->Up[j + 1]; k++) {
+      i = w->Ui[k];
+      r = MIN(w->pinv[i], w->pinv[j]);
+      c = MAX(w->pinv[i], w->pinv[j]);
+      q = w->cnt[c]++;
+      w->Ci[q] = r;
+      w->Cx[q] = w->Ux[k];
+    }
+  }
+  return NULL;
+}
+
+static const char *factor(scs_int n, LdlStubWork *w) {
+  scs_float info[AMD_INFO];
+  const char *err;
+  scs_int sum_Lnz;
+
+  w->perm = (scs_int *)malloc(n * sizeof(scs_int));
+  if (!w->perm) {
+    return "ldl stub: out of memory.";
+  }
+  if (amd_order(n, w->Up, w->Ui, w->perm, (scs_float *)SCS_NULL, info) < 0) {
+    return "ldl stub: AMD ordering failed.";
+  }
+  err = permute(n, w);
+  if (err) {
+    return err;
+  }
+  w->etree = (scs_int *)malloc(n * sizeof(scs_int));
+  w->Lnz = (scs_int *)malloc(n * sizeof(scs_int));
+  w->iwork = (scs_int *)malloc(3 * n * sizeof(scs_int));
+  w->bwork = (QDLDL_bool *)malloc(n * sizeof(QDLDL_bool));
+  w->fwork = (scs_float *)malloc(n * sizeof(scs_float));
+  w->D = (scs_float *)malloc(n * sizeof(scs_float));
+  w->Dinv = (scs_float *)malloc(n * sizeof(scs_float));
+  w->Lp = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  if (!w->etree || !w->Lnz || !w->iwork || !w->bwork || !w->fwork || !w->D ||
+      !w->Dinv || !w->Lp) {
+    return "ldl stub: out of memory.";
+  }
+  sum_Lnz = QDLDL_etree(n, w->Cp, w->Ci, w->iwork, w->Lnz, w->etree);
+  if (sum_Lnz < 0) {
+    return "ldl stub: matrix has an empty column or is not symmetric.";
+  }
+  w->Li = (scs_int *)malloc((sum_Lnz + 1) * sizeof(scs_int));
+  w->Lx = (scs_float *)malloc((sum_Lnz + 1) * sizeof(scs_float));
+  if (!w->Li || !w->Lx) {
+    return "ldl stub: out of memory.";
+  }
+  if (QDLDL_factor(n, w->Cp, w->Ci, w->Cx, w->Lp, w->Li, w->Lx, w->D, w->Dinv,
+                   w->Lnz, w->etree, w->bwork, w->iwork, w->fwork) < 0) {
+    return "ldl stub: zero pivot (the matrix needs pivoting).";
+  }
+  return NULL;
+}
+
+const char *mex_stub_ldl(int nlhs, mxArray *plhs[], int nrhs,
+                         mxArray *prhs[]) {
+  LdlStubWork w;
+  const char *err;
+  char *opt;
+  scs_int n, j, k;
+  mwIndex q;
+  mwIndex *jc, *ir;
+  double *pr;
+
+  if (nrhs != 2 || nlhs != 3) {
+    return "ldl stub: only [L, D, p] = ldl(K, 'vector') is supported.";
+  }
+  opt = mxArrayToString(prhs[1]);
+  if (!opt || strcmp(opt, "vector") != 0) {
+    mxFree(opt);
+    return "ldl stub: only [L, D, p] = ldl(K, 'vector') is supported.";
+  }
+  mxFree(opt);
+  if (!mxIsSparse(prhs[0]) || mxGetM(prhs[0]) != mxGetN(prhs[0])) {
+    return "ldl stub: K must be square and sparse.";
+  }
+
+  n = (scs_int)mxGetN(prhs[0]);
+  memset(&w, 0, sizeof(LdlStubWork));
+  err = upper_triangle(prhs[0], n, &w);
+  if (!err) {
+    err = factor(n, &w);
+  }
+  if (err) {
+    free_work(&w);
+    return err;
+  }
+
+  /* L with its unit diagonal first in each column; QDLDL leaves the rows of
+   * a column in increasing order */
+  plhs[0] = mxCreateSparse(n, n, (mwSize)(w.Lp[n] + n), mxREAL);
+  jc = mxGetJc(plhs[0]);
+  ir = mxGetIr(plhs[0]);
+  pr = mxGetPr(plhs[0]);
+  q = 0;
+  for (j = 0; j < n; j++) {
+    jc[j] = q;
+    ir[q] = (mwIndex)j;
+    pr[q++] = 1.;
+    for (k = w.Lp[j]; k < w.Lp[j + 1]; k++) {
+      ir[q] = (mwIndex)w.Li[k];
+      pr[q++] = (double)w.Lx[k];
+    }
+  }
+  jc[n] = q;
+
+  plhs[1] = mxCreateSparse(n, n, (mwSize)n, mxREAL);
+  jc = mxGetJc(plhs[1]);
+  ir = mxGetIr(plhs[1]);
+  pr = mxGetPr(plhs[1]);
+  for (j = 0; j < n; j++) {
+    jc[j] = (mwIndex)j;
+    ir[j] = (mwIndex)j;
+    pr[j] = (double)w.D[j];
+  }
+  jc[n] = (mwIndex)n;
+
+  plhs[2] = mxCreateDoubleMatrix(1, n, mxREAL);
+  pr = mxGetPr(plhs[2]);
+  for (j = 0; j < n; j++) {
+    pr[j] = (double)(w.perm[j] + 1);
+  }
+
+  free_work(&w);
+  return NULL;
+}
@@ -0,0 +1,7 @@
+function kb = read_status_kb(field)
+% READ_STATUS_KB  A kB field of /proc/self/status, e.g. 'VmRSS' or 'VmHWM'.
+
+txt = fileread('/proc/self/status');
+tok = regexp(txt, [field ':\s*(\d+)\s*kB'], 'tokens', 'once');
+kb = str2double(tok{1});
+end
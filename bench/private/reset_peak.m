@@ -0,0 +1,13 @@
+function rss_kb = reset_peak()
+% RESET_PEAK  Reset the peak RSS (VmHWM) to the current RSS; returns it (kB).
+%
+%   Writing 5 to clear_refs resets VmHWM to the current RSS (Linux >= 4.0).
+
+fid = fopen('/proc/self/clear_refs', 'w');
+if fid < 0
+    error('Cannot reset peak RSS (/proc/self/clear_refs not writable).');
+end
+fprintf(fid, '5');
+fclose(fid);
+rss_kb = read_status_kb('VmRSS');
+end
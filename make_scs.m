@@ -8,6 +8,9 @@ addpath(src_dir);
 addpath(matlab_dir);
 
 gpu = false; % compile the gpu version of SCS
+% also compile scs_unified, one mex file with every CPU backend, selected
+% per workspace at runtime (pars.unified = true in scs, scs_init, ...)
+unified = false;
 float = false; % using single precision (rather than double) floating points
 int = false; % use 32 bit integers for indexing
 % OpenMP parallelizes the matrix multiply for the indirect solver (using CG)
@@ -25,6 +28,7 @@ use_open_mp = false;
 % Interactive users editing the file directly are unaffected: an unset
 % env var leaves the value at its literal default above.
 if strcmpi(getenv('SCS_BUILD_GPU'), 'true');    gpu = true;         end
+if strcmpi(getenv('SCS_BUILD_UNIFIED'), 'true'); unified = true;    end
 if strcmpi(getenv('SCS_USE_FLOAT'), 'true');    float = true;       end
 if strcmpi(getenv('SCS_USE_INT'), 'true');      int = true;         end
 if strcmpi(getenv('SCS_USE_OPENMP'), 'true');   use_open_mp = true; end
@@ -37,7 +41,7 @@ flags.LOCS = '';
 
 common_scs = [ ...
     'scs/src/linalg.c scs/src/cones.c scs/src/exp_cone.c scs/src/aa.c ' ...
-    'scs/src/util.c scs/src/scs.c scs/src/ctrlc.c scs/src/normalize.c ' ...
+    'scs/src/util.c scs/src/scs.c scs/src/normalize.c ' ...
     'scs/src/scs_version.c scs/linsys/scs_matrix.c scs/linsys/csparse.c ' ...
     'scs/src/rw.c ' ...
     'scs/src/spectral_cones/logdeterminant/log_cone_Newton.c ' ...
@@ -49,7 +53,7 @@ common_scs = [ ...
     'scs/src/spectral_cones/sum-largest/sum_largest_cone.c ' ...
     'scs/src/spectral_cones/sum-largest/sum_largest_eval_cone.c ' ...
     'scs/src/spectral_cones/util_spectral_cones.c ' ...
-    'src/scs_mex.c'];
+    'src/scs_ctrlc_mex.c src/scs_mex.c'];
 
 if contains(computer, '64')
     flags.arr = '-largeArrayDims';
@@ -177,6 +181,11 @@ compile_direct(flags, common_scs);
 compile_indirect(flags, common_scs);
 compile_dense(flags, common_scs);
 compile_matlab_direct(flags, common_scs);
+compile_supernodal(flags, common_scs);
+
+if unified
+    compile_unified(flags, common_scs);
+end
 
 if gpu
     compile_gpu(flags, common_scs);
@@ -6,9 +6,11 @@ if nargin < 3
     pars = [];
 end
 
-data = scs_prepare_data(data);
-
-if isfield(pars, 'use_indirect') && pars.use_indirect
+if isfield(pars, 'unified') && pars.unified
+    [x, y, s, info] = scs_unified(data, K, scs_unified_pars(data, K, pars));
+elseif isfield(pars, 'backend') && strcmp(pars.backend, 'auto')
+    [x, y, s, info] = feval(scs_auto_backend(data, K, pars), data, K, pars);
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
     [x, y, s, info] = scs_indirect(data, K, pars);
 elseif isfield(pars, 'gpu') && pars.gpu
     [x, y, s, info] = scs_gpu(data, K, pars);
@@ -16,6 +18,8 @@ elseif isfield(pars, 'dense') && pars.dense
     [x, y, s, info] = scs_dense(data, K, pars);
 elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
     [x, y, s, info] = scs_direct(data, K, pars);
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    [x, y, s, info] = scs_supernodal(data, K, pars);
 else
     [x, y, s, info] = scs_matlab_direct(data, K, pars);
 end
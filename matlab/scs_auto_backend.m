@@ -0,0 +1,153 @@
+function [backend, reason] = scs_auto_backend(data, K, pars)
+% SCS_AUTO_BACKEND  Backend chosen by pars.backend = 'auto'.
+%
+%   backend = scs_auto_backend(data, K, pars)
+%   [backend, reason] = scs_auto_backend(data, K, pars)
+%
+%   Picks one of the compiled backends from the problem structure:
+%
+%     scs_dense          A is dense (density > 0.3), or n is tiny next to
+%                        m, and A fits in memory as a full matrix
+%     scs_indirect       the estimated LDL factor of the KKT matrix is too
+%                        large (over 1e8 nonzeros or 50x fill)
+%     scs_direct         small factor (under 1e6 nonzeros), or PSD cones
+%                        dominate so that setup cost matters most
+%     scs_supernodal     everything else, if built; else scs_matlab_direct
+%
+%   The factor size comes from symbfact on the AMD-ordered KKT pattern.
+%   With pars.auto_probe = true the best two candidates are also run for
+%   pars.auto_probe_iters iterations (default 25) and the one with the
+%   lower setup time plus 100 times its time per iteration wins.
+%
+%   The decision is cached for the session per problem structure (sizes,
+%   nonzero positions of A and P and cone sizes), so repeated calls on
+%   the same structure cost nothing; 'clear scs_auto_backend' resets the
+%   cache. reason says why the backend was chosen.
+%
+%   See also: scs, scs_init
+
+persistent cache
+if isempty(cache)
+    cache = containers.Map('KeyType', 'char', 'ValueType', 'any');
+end
+if nargin < 3
+    pars = [];
+end
+
+% the key only holds sizes, nnz and cones; a hit also needs the same
+% nonzero positions
+[key, pattern] = signature(data, K);
+if isKey(cache, key)
+    hit = cache(key);
+    if isequal(hit{3}, pattern)
+        backend = hit{1};
+        reason = ['cached: ', hit{2}];
+        return
+    end
+end
+
+[candidates, reason] = rank_backends(data, K);
+backend = candidates{1};
+if isfield(pars, 'auto_probe') && pars.auto_probe && numel(candidates) > 1
+    [backend, reason] = probe(candidates(1:2), data, K, pars);
+end
+cache(key) = {backend, reason, pattern};
+end
+
+function [candidates, reason] = rank_backends(data, K)
+[m, n] = size(data.A);
+nnz_A = nnz(data.A);
+has = @(b) exist(b, 'file') == 3;
+fits_dense = m * n <= 5e7;
+
+if has('scs_dense') && fits_dense && nnz_A > 0.3 * m * n
+    candidates = {'scs_dense', 'scs_matlab_direct', 'scs_indirect'};
+    reason = sprintf('dense A (density %.2f)', nnz_A / (m * n));
+elseif has('scs_dense') && fits_dense && n <= 2000 && 20 * n <= m
+    candidates = {'scs_dense', 'scs_indirect', 'scs_matlab_direct'};
+    reason = sprintf('n = %d much smaller than m = %d', n, m);
+else
+    [nnz_L, fill] = factor_estimate(data);
+    psd_rows = cone_rows(K, 's') + cone_rows(K, 'cs');
+    if nnz_L > 1e8 || fill > 50
+        candidates = {'scs_indirect', 'scs_matlab_direct'};
+        reason = sprintf('large factor (nnz(L) ~ %.3g, fill %.1f)', ...
+            nnz_L, fill);
+    elseif nnz_L < 1e6 || psd_rows > m / 2
+        candidates = {'scs_direct', 'scs_matlab_direct', 'scs_indirect'};
+        reason = sprintf('small factor (nnz(L) ~ %.3g) or PSD-bound', ...
+            nnz_L);
+    else
+        candidates = {'scs_supernodal', 'scs_matlab_direct', ...
+            'scs_direct', 'scs_indirect'};
+        reason = sprintf('sparse factor (nnz(L) ~ %.3g, fill %.1f)', ...
+            nnz_L, fill);
+    end
+end
+candidates = candidates(cellfun(has, candidates));
+if isempty(candidates)
+    candidates = {'scs_matlab_direct'};
+end
+end
+
+function [nnz_L, fill] = factor_estimate(data)
+% Column counts of the Cholesky factor of the AMD-ordered KKT pattern
+[m, n] = size(data.A);
+A = spones(sparse(data.A));
+if isfield(data, 'P') && ~isempty(data.P)
+    P = spones(sparse(data.P));
+    P = P + P';
+else
+    P = sparse(n, n);
+end
+KKT = [P + speye(n), A'; A, speye(m)];
+p = amd(KKT);
+nnz_L = sum(symbfact(KKT(p, p), 'sym'));
+fill = nnz_L / nnz(triu(KKT));
+end
+
+function rows = cone_rows(K, field)
+rows = 0;
+if isfield(K, field)
+    rows = sum(K.(field)(:) .^ 2);
+end
+end
+
+function [backend, reason] = probe(candidates, data, K, pars)
+iters = 25;
+if isfield(pars, 'auto_probe_iters')
+    iters = pars.auto_probe_iters;
+end
+pars.verbose = 0;
+pars.max_iters = iters;
+score = inf(size(candidates));
+for i = 1:numel(candidates)
+    [~, ~, ~, info] = feval(candidates{i}, data, K, pars);
+    score(i) = info.setup_time + 100 * info.solve_time / max(info.iter, 1);
+end
+[~, best] = min(score);
+backend = candidates{best};
+reason = sprintf('probe: %s %.1f ms vs %s %.1f ms', candidates{1}, ...
+    score(1), candidates{2}, score(2));
+end
+
+function [key, pattern] = signature(data, K)
+[m, n] = size(data.A);
+pattern = {find(data.A), []};
+parts = {sprintf('%d,%d,%d', m, n, numel(pattern{1}))};
+if isfield(data, 'P') && ~isempty(data.P)
+    pattern{2} = find(data.P);
+    parts{end + 1} = sprintf('P%d', numel(pattern{2}));
+end
+fields = sort(fieldnames(K));
+for i = 1:numel(fields)
+    v = K.(fields{i});
+    if any(strcmp(fields{i}, {'bl', 'bu', 'p'}))
+        % parameters, not structure
+        v = numel(v);
+    end
+    parts{end + 1} = sprintf('%s:%s', fields{i}, ...
+        sprintf('%.17g,', double(v(:)))); %#ok<AGROW>
+end
+key = strjoin(parts, ';');
+end
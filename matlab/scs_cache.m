@@ -0,0 +1,40 @@
+function stats = scs_cache(arg)
+% SCS_CACHE  Setup cache of repeated one-shot scs calls.
+%
+%   stats = scs_cache()
+%   stats = scs_cache(backend)
+%   scs_cache('clear')
+%
+%   With pars.cache_bytes > 0, scs(data, K, pars) keeps the workspace of
+%   the solve, factorization included, and a later call with the same A,
+%   P, cones and setup settings (normalize, scale, rho_x,
+%   acceleration_lookback and the backend options) reuses it: only b and
+%   c are updated. The other settings (tolerances, max_iters, ...) are
+%   taken from each call. When a workspace is added, the least recently
+%   used ones are dropped until all fit in cache_bytes (an estimate of
+%   their memory). The cache is skipped when write_data_filename or
+%   log_csv_filename is set. info reports cache_hit for the call and the
+%   running cache_hits and cache_misses.
+%
+%   Each backend (mex file) has its own cache. The first two forms return
+%   the cache of backend ('scs_matlab_direct' by default) as a struct
+%   with fields entries, bytes, hits and misses. The third empties the
+%   caches of all backends and resets their counts; 'clear mex' does too.
+%
+%   See also: scs, scs_init
+
+if nargin < 1
+    arg = 'scs_matlab_direct';
+end
+if strcmp(arg, 'clear')
+    backends = {'scs_matlab_direct', 'scs_direct', 'scs_indirect', ...
+        'scs_dense', 'scs_supernodal', 'scs_unified', 'scs_gpu'};
+    for i = 1:numel(backends)
+        if exist(backends{i}, 'file') == 3
+            feval(backends{i}, 'cache_clear');
+        end
+    end
+    stats = [];
+else
+    stats = feval(arg, 'cache');
+end
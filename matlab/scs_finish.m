@@ -4,8 +4,9 @@ function scs_finish(work)
 %   scs_finish(work)
 %
 %   Frees the workspace allocated by scs_init. Must be called when
-%   done to avoid memory leaks.
+%   done to avoid memory leaks. Other workspaces are unaffected, and
+%   using work after this call raises an error.
 %
 %   See also: scs_init, scs_solve, scs_update
 
-feval(work.backend, 'finish');
+feval(work.backend, 'finish', work.handle);
@@ -47,6 +47,9 @@ function [x, y, s, info] = scs_indirect(data, cone, params)
 %   time_limit_secs        : time limit in seconds
 %   write_data_filename    : if set, dump raw problem data to file
 %   log_csv_filename       : if set, log progress to csv file
+%   presolve               : drop fixed variables, empty and duplicate zero
+%                            and linear cone rows and empty columns before
+%                            the solve (0 or 1); info.presolve reports them
 %
 % to warm-start the solver add guesses for (x, y, s) to the data struct
 %
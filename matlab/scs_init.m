@@ -10,15 +10,32 @@ function work = scs_init(data, K, pars)
 %   This is useful when solving a sequence of problems where only b
 %   and/or c change, avoiding repeated factorization.
 %
+%   Each call creates an independent workspace; any number of them can
+%   be alive at once (e.g., one per model), and each keeps its own
+%   factorization until scs_finish is called on it.
+%
+%   pars.backend = 'auto' picks the backend from the problem structure
+%   (see scs_auto_backend). With pars.unified = true the workspace lives
+%   in scs_unified, whose backend can be changed later (see scs_lin_sys).
+%
+%   With pars.presolve = true the workspace holds the presolved problem.
+%   scs_solve returns x, y, s of the problem as given, scs_update maps the
+%   new b and c through the same reductions and fails if they break one
+%   (e.g. a dropped row that no longer holds). scs_solve_batch,
+%   scs_solve_path, scs_save and matrix updates are not supported then.
+%
 %   See also: scs_solve, scs_update, scs_finish, scs
 
 if nargin < 3
     pars = [];
 end
 
-data = scs_prepare_data(data);
-
-if isfield(pars, 'use_indirect') && pars.use_indirect
+if isfield(pars, 'unified') && pars.unified
+    work.backend = 'scs_unified';
+    pars = scs_unified_pars(data, K, pars);
+elseif isfield(pars, 'backend') && strcmp(pars.backend, 'auto')
+    work.backend = scs_auto_backend(data, K, pars);
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
     work.backend = 'scs_indirect';
 elseif isfield(pars, 'gpu') && pars.gpu
     work.backend = 'scs_gpu';
@@ -26,6 +43,8 @@ elseif isfield(pars, 'dense') && pars.dense
     work.backend = 'scs_dense';
 elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
     work.backend = 'scs_direct';
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    work.backend = 'scs_supernodal';
 else
     work.backend = 'scs_matlab_direct';
 end
@@ -33,4 +52,4 @@ end
 work.n = size(data.A, 2);
 work.m = size(data.A, 1);
 
-feval(work.backend, 'init', data, K, pars);
+work.handle = feval(work.backend, 'init', data, K, pars);
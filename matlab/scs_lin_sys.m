@@ -0,0 +1,30 @@
+function name = scs_lin_sys(work, pars)
+% SCS_LIN_SYS  Linear system backend of an scs_unified workspace.
+%
+%   name = scs_lin_sys(work)
+%   scs_lin_sys(work, pars)
+%
+%   The first form returns the backend of work ('matlab_direct', 'direct',
+%   'indirect', 'dense' or 'supernodal'). The second moves work to the
+%   backend pars.lin_sys_backend, with the backend options in pars (e.g.
+%   lin_sys_threads). The new linear system is set up from the problem
+%   the workspace holds, including the changes made by scs_update and
+%   scs_update_matrix; nothing is passed from MATLAB again. The iterates
+%   start afresh, so pass the last solution to scs_solve as a warm start
+%   to continue from it. The handle stays the same.
+%
+%   work must come from scs_init, scs_load or scs_read_init with
+%   pars.unified = true.
+%
+%   See also: scs_unified, scs_init, scs_solve
+
+if ~strcmp(work.backend, 'scs_unified')
+    error('scs:notUnified', ...
+        'scs_lin_sys needs a workspace created with pars.unified = true.');
+end
+if nargin < 2
+    name = scs_unified('lin_sys', work.handle);
+else
+    scs_unified('lin_sys', work.handle, pars);
+    name = pars.lin_sys_backend;
+end
@@ -0,0 +1,41 @@
+function work = scs_load(filename, pars)
+% SCS_LOAD  Create an SCS workspace from a file written by scs_save.
+%
+%   work = scs_load(filename)
+%   work = scs_load(filename, pars)
+%
+%   The file is memory-mapped. With the default backend the stored
+%   ordering is reused (MATLAB's ldl() is not called) and, if the KKT
+%   matrix is unchanged, so is the stored factor, whose pages are then
+%   shared between all workspaces and MATLAB processes that load the same
+%   file. The data is still equilibrated again, and the other backends
+%   factorize the KKT matrix as scs_init does. The stored matrices are
+%   checked before use. pars only selects the backend, as in scs_init;
+%   the solver settings are those stored in the file. With
+%   pars.unified = true the backend is the one that wrote the file.
+%
+%   See also: scs_save, scs_init, scs_solve, scs_finish
+
+if nargin < 2
+    pars = [];
+end
+
+if isfield(pars, 'unified') && pars.unified
+    work.backend = 'scs_unified';
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
+    work.backend = 'scs_indirect';
+elseif isfield(pars, 'gpu') && pars.gpu
+    work.backend = 'scs_gpu';
+elseif isfield(pars, 'dense') && pars.dense
+    work.backend = 'scs_dense';
+elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
+    work.backend = 'scs_direct';
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    work.backend = 'scs_supernodal';
+else
+    work.backend = 'scs_matlab_direct';
+end
+
+[work.handle, dims] = feval(work.backend, 'load', filename);
+work.m = dims(1);
+work.n = dims(2);
@@ -11,8 +11,11 @@ function [x, y, s, info] = scs_matlab_direct(data, cone, params)
 % where x \in R^n, s \in R^m
 %
 % This uses MATLAB's native ldl() function instead of the bundled QDLDL
-% solver. Factorization calls into MATLAB's ldl(), but the per-iteration
-% forward/diagonal/backward solves run entirely in C with no MATLAB callbacks.
+% solver for the initial factorization and fill-reducing ordering. Later
+% refactorizations (when adaptive_scale changes the diagonal) reuse that
+% ordering and are numeric only, done in C; ldl() is called again only if
+% one breaks down. The per-iteration forward/diagonal/backward solves run
+% entirely in C with no MATLAB callbacks.
 %
 % K is product of cones in this particular order:
 % zero cone, lp cone, box cone, second order cone(s), semi-definite
@@ -49,6 +52,29 @@ function [x, y, s, info] = scs_matlab_direct(data, cone, params)
 %   time_limit_secs        : time limit in seconds
 %   write_data_filename    : if set, dump raw problem data to file
 %   log_csv_filename       : if set, log progress to csv file
+%   presolve               : drop fixed variables, empty and duplicate zero
+%                            and linear cone rows and empty columns before
+%                            the solve (0 or 1); info.presolve reports them
+%   lin_sys_threads        : threads for the parallel triangular solves in an
+%                            OpenMP build (0 = OpenMP default, 1 = serial)
+%   refactor_tol           : largest relative change of the KKT diagonal a
+%                            scale update may make without refactorizing;
+%                            solves then refine with the stale factors
+%                            (0 = always refactorize, the default)
+%   refine_steps           : max refinement steps per solve with stale
+%                            factors before refactorizing (default 5)
+%   factor_single          : keep the factor of L in single precision (0 or
+%                            1); solves refine back to double accuracy
+%   trace_iters            : if set, keep the last trace_iters iterations in
+%                            info.trace (see below)
+%
+% info.factorizations is the number of KKT factorizations done.
+%
+% With trace_iters, info.trace has one row per iteration with the columns
+%   iter, res_pri, res_dual, gap, scale, accel_accepted, accel_rejected,
+%   lin_sys_time, other_time
+% (times in ms, accel columns count AA steps of that iteration). It is
+% recorded in memory inside the iteration loop, with no I/O.
 %
 % to warm-start the solver add guesses for (x, y, s) to the data struct
 %
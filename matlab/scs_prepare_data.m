@@ -1,5 +1,14 @@
 function data = scs_prepare_data(data)
 % SCS_PREPARE_DATA Normalize input matrices/vectors and validate dimensions.
+%
+%   data = scs_prepare_data(data)
+%
+%   Returns data in the form the solver uses: A and P sparse, P upper
+%   triangular (triu(P + P') / 2 unless P already is), b and c columns.
+%   scs and scs_init do not call this: the mex files do the same
+%   conversion and checks in C while reading data, without the MATLAB
+%   copies of P made here. It is kept for code that wants that form in
+%   MATLAB.
 
 if isfield(data, 'P')
     data.P = sparse(data.P);
@@ -0,0 +1,39 @@
+function [x, y, s, info] = scs_read(filename, pars)
+% SCS_READ  Solve a problem from a file written via write_data_filename.
+%
+%   [x, y, s, info] = scs_read(filename)
+%   [x, y, s, info] = scs_read(filename, pars)
+%
+%   Reads a problem dumped by SCS (pars.write_data_filename) and solves
+%   it. The file is read in C straight into the solver's data, without
+%   building MATLAB arrays, so large problems are not copied through
+%   MATLAB. The solver settings are those stored in the file; fields set
+%   in pars override them, and pars selects the backend as in scs.
+%
+%   The file must come from an SCS build with the same version and the
+%   same int and float sizes.
+%
+%   See also: scs_read_init, scs
+
+if nargin < 2
+    pars = [];
+end
+
+if isfield(pars, 'unified') && pars.unified
+    backend = 'scs_unified';
+    pars = scs_unified_pars([], [], pars);
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
+    backend = 'scs_indirect';
+elseif isfield(pars, 'gpu') && pars.gpu
+    backend = 'scs_gpu';
+elseif isfield(pars, 'dense') && pars.dense
+    backend = 'scs_dense';
+elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
+    backend = 'scs_direct';
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    backend = 'scs_supernodal';
+else
+    backend = 'scs_matlab_direct';
+end
+
+[x, y, s, info] = feval(backend, 'read', filename, pars);
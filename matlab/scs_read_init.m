@@ -0,0 +1,38 @@
+function work = scs_read_init(filename, pars)
+% SCS_READ_INIT  Create an SCS workspace from a write_data_filename file.
+%
+%   work = scs_read_init(filename)
+%   work = scs_read_init(filename, pars)
+%
+%   Like scs_init, for a problem dumped by SCS (pars.write_data_filename).
+%   The file is read in C straight into the workspace, without building
+%   MATLAB arrays. The solver settings are those stored in the file;
+%   fields set in pars override them, and pars selects the backend as in
+%   scs_init.
+%
+%   See also: scs_read, scs_init, scs_solve, scs_update, scs_finish
+
+if nargin < 2
+    pars = [];
+end
+
+if isfield(pars, 'unified') && pars.unified
+    work.backend = 'scs_unified';
+    pars = scs_unified_pars([], [], pars);
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
+    work.backend = 'scs_indirect';
+elseif isfield(pars, 'gpu') && pars.gpu
+    work.backend = 'scs_gpu';
+elseif isfield(pars, 'dense') && pars.dense
+    work.backend = 'scs_dense';
+elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
+    work.backend = 'scs_direct';
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    work.backend = 'scs_supernodal';
+else
+    work.backend = 'scs_matlab_direct';
+end
+
+[work.handle, dims] = feval(work.backend, 'read_init', filename, pars);
+work.m = dims(1);
+work.n = dims(2);
@@ -0,0 +1,19 @@
+function scs_save(work, filename)
+% SCS_SAVE  Write an SCS workspace to a file.
+%
+%   scs_save(work, filename)
+%
+%   Stores the problem the workspace was created from (data with the
+%   current b and c, cones and settings) and, for the default backend, its
+%   KKT ordering and factorization in a binary file that scs_load can map
+%   back in without refactorizing. The equilibrated data is not stored,
+%   and the other backends (scs_direct included) keep no factor in the
+%   file; scaling and factorization are redone on load. Save right after
+%   scs_init (before any solve with adaptive scaling) to keep the factor
+%   of the initial KKT matrix. The file is specific to the SCS build that
+%   wrote it. An existing file is replaced rather than rewritten in place,
+%   so workspaces loaded from it keep working.
+%
+%   See also: scs_load, scs_init
+
+feval(work.backend, 'save', work.handle, filename);
@@ -0,0 +1,27 @@
+function [X, Y, S, info] = scs_solve_batch(work, B, C)
+% SCS_SOLVE_BATCH  Solve many (b, c) scenarios with one SCS workspace.
+%
+%   [X, Y, S, info] = scs_solve_batch(work, B, C)
+%   [X, Y, S, info] = scs_solve_batch(work, B, [])   % vary only b
+%   [X, Y, S, info] = scs_solve_batch(work, [], C)   % vary only c
+%
+%   Solves the problem in work once per column of B (m x k) and C
+%   (n x k), as if calling scs_update and scs_solve for each column.
+%   Pass [] to keep the workspace's current b or c for every column.
+%   Returns X (n x k), Y and S (m x k) and a 1 x k struct array info.
+%
+%   The first (or only) thread solves on the workspace itself, whose b
+%   and c are restored afterwards; a later scs_solve starts from its
+%   final scale. When SCS is built with OpenMP the columns are solved in
+%   parallel, each further thread on its own copy of the workspace
+%   (created on first use and kept until scs_finish). The default
+%   backend always runs on one thread, since its refactorizations may
+%   call back into MATLAB.
+%
+%   See also: scs_init, scs_solve, scs_update, scs_finish
+
+if nargin < 3
+    C = [];
+end
+
+[X, Y, S, info] = feval(work.backend, 'solve_batch', work.handle, B, C);
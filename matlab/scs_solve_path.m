@@ -0,0 +1,27 @@
+function [X, Y, S, info] = scs_solve_path(work, B, C, warm)
+% SCS_SOLVE_PATH  Solve a sequence of (b, c) problems with warm-start chaining.
+%
+%   [X, Y, S, info] = scs_solve_path(work, B, C)
+%   [X, Y, S, info] = scs_solve_path(work, B, [])      % b moves, c fixed
+%   [X, Y, S, info] = scs_solve_path(work, [], C)      % c moves, b fixed
+%   [X, Y, S, info] = scs_solve_path(work, B, C, warm) % warm-start point 1
+%
+%   Solves the path points (B(:,j), C(:,j)) in order, e.g. a
+%   regularization path. Each point is warm-started inside the solver
+%   from the previous point's (x, y, s) and, with adaptive_scale, from
+%   its final scale, so nothing is copied back through MATLAB between
+%   points. Returns X (n x k), Y and S (m x k) and a 1 x k struct array
+%   info. Afterwards the workspace holds the last point's b and c.
+%
+%   See also: scs_init, scs_solve, scs_solve_batch, scs_update
+
+if nargin < 3
+    C = [];
+end
+
+if nargin < 4
+    [X, Y, S, info] = feval(work.backend, 'solve_path', work.handle, B, C);
+else
+    [X, Y, S, info] = feval(work.backend, 'solve_path', work.handle, ...
+        B, C, warm);
+end
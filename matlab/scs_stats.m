@@ -0,0 +1,29 @@
+function stats = scs_stats(work)
+% SCS_STATS  Factorization cost and memory of an SCS workspace.
+%
+%   stats = scs_stats(work)
+%
+%   Returns a struct with the size of the KKT system (kkt_nnz, the upper
+%   triangle) and of its factor (L_nnz, strictly lower; fill_ratio is
+%   nnz of L with its diagonal over kkt_nnz), the work done so far
+%   (factorizations, of which ldl_calls by MATLAB's ldl(); solves; their
+%   total factor_time and solve_time in ms; refine_steps) and, in
+%   stats.bytes, the memory held by each part of the workspace:
+%
+%     data      problem copy kept for updates and batch solves
+%     kkt       KKT matrix (and its copy for ldl())
+%     factor    L, D and the ordering
+%     symbolic  symbolic analysis for numeric refactorizations
+%     solve     CSR copy of L, parallel schedules, solve vectors
+%     solver    SCS iterates, scaled data and AA memory (estimate)
+%     batch     per-thread workspaces of scs_solve_batch
+%     file      workspace file mapped by scs_load (shared)
+%     total     all of the above except file
+%
+%   The linear system figures are NaN for backends other than the
+%   default one. info from scs_solve reports factorizations, factor_time
+%   and lin_sys_solves for each solve.
+%
+%   See also: scs_init, scs_solve
+
+stats = feval(work.backend, 'stats', work.handle);
@@ -0,0 +1,36 @@
+function [x, y, s, info] = scs_unified(data, cone, params)
+% Operator-splitting method for solving cone problems (all CPU backends)
+%
+% This implements a cone solver. It solves:
+%
+% min. 0.5 * x'Px + c'x
+% subject to Ax + s = b
+% s \in K
+%
+% where x \in R^n, s \in R^m
+%
+% One mex file with every CPU linear system backend, picked per call or
+% per workspace by params.lin_sys_backend:
+%
+%   'matlab_direct'  MATLAB's ldl() and numeric refactorizations in C
+%                    (the default, as scs_matlab_direct)
+%   'direct'         bundled QDLDL (as scs_direct)
+%   'indirect'       conjugate gradient (as scs_indirect)
+%   'dense'          Gram matrix and LAPACK Cholesky (as scs_dense)
+%   'supernodal'     in-tree supernodal LDL' (as scs_supernodal)
+%
+% The solver is loaded once for all of them, and a workspace from
+% scs_init can be moved to another backend with scs_lin_sys without
+% parsing the problem again. It is built by make_scs with unified = true
+% (or SCS_BUILD_UNIFIED=true) and used by scs, scs_init, scs_load,
+% scs_read and scs_read_init with params.unified = true, which map the
+% usual backend flags to lin_sys_backend (see scs_unified_pars).
+%
+% data, cone, the warm start and the optional fields of params are as for
+% the separate backends (see scs_matlab_direct, scs_supernodal): the
+% backend options (lin_sys_threads, refactor_tol, refine_steps,
+% factor_single, trace_iters) apply to the backends that have them.
+%
+% to warm-start the solver add guesses for (x, y, s) to the data struct
+%
+error ('scs_unified mexFunction not found') ;
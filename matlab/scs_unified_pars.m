@@ -0,0 +1,35 @@
+function pars = scs_unified_pars(data, K, pars)
+% SCS_UNIFIED_PARS  Settings for scs_unified from the backend flags.
+%
+%   pars = scs_unified_pars(data, K, pars)
+%
+%   Used by scs, scs_init, scs_read and scs_read_init when pars.unified is
+%   true: sets pars.lin_sys_backend, unless given, from the flags that
+%   otherwise select a separate mex file (use_indirect, dense, use_qdldl,
+%   supernodal, backend = 'auto'). data and K are only used by 'auto' and
+%   may be [] otherwise. The GPU backend is not part of scs_unified.
+%
+%   See also: scs_unified, scs_lin_sys
+
+if isfield(pars, 'lin_sys_backend') && ~isempty(pars.lin_sys_backend)
+    return
+end
+if isfield(pars, 'gpu') && pars.gpu
+    error('scs:unifiedNoGpu', ...
+        'The GPU backend is not part of scs_unified; unset pars.unified.');
+end
+
+if isfield(pars, 'backend') && strcmp(pars.backend, 'auto') && ~isempty(data)
+    backend = regexprep(scs_auto_backend(data, K, pars), '^scs_', '');
+elseif isfield(pars, 'use_indirect') && pars.use_indirect
+    backend = 'indirect';
+elseif isfield(pars, 'dense') && pars.dense
+    backend = 'dense';
+elseif isfield(pars, 'use_qdldl') && pars.use_qdldl
+    backend = 'direct';
+elseif isfield(pars, 'supernodal') && pars.supernodal
+    backend = 'supernodal';
+else
+    backend = 'matlab_direct';
+end
+pars.lin_sys_backend = backend;
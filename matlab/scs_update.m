@@ -1,18 +1,47 @@
-function scs_update(work, b, c)
+function scs_update(work, b, c, varargin)
 % SCS_UPDATE  Update b and/or c without re-factorizing.
 %
 %   scs_update(work, b_new, c_new)
 %   scs_update(work, b_new, [])    % update only b
 %   scs_update(work, [], c_new)    % update only c
+%   scs_update(work, b_new, c_new, A_new, P_new)
+%   scs_update(work, b_new, c_new, K_new)
+%   scs_update(work, b_new, c_new, A_new, P_new, K_new)
 %
 %   Updates the b and/or c vectors in the workspace. Pass [] to leave
 %   a vector unchanged. After updating, call scs_solve to re-solve.
 %
+%   A_new and P_new give new values for A and P with the sparsity pattern
+%   used at scs_init (P as its upper triangle, a full symmetric P is
+%   converted as in scs_init). Each is either a sparse matrix with that
+%   pattern or a vector of its nonzero values in column-major order; the
+%   vector form keeps entries that become zero, which sparse() would drop.
+%   A pattern change is an error. This re-equilibrates and refactorizes
+%   the workspace; the default backend reuses its ordering and symbolic
+%   analysis, so only the numeric factorization is redone.
+%
+%   K_new is a struct with new box cone bounds (bl, bu) and/or power cone
+%   exponents (p), each of the size given at scs_init. These do not affect
+%   the factorization and are swapped in directly.
+%
 %   See also: scs_init, scs_solve, scs_finish
 
 if nargin < 3
     c = [];
 end
+K = [];
+if ~isempty(varargin) && isstruct(varargin{end})
+    K = varargin{end};
+    varargin(end) = [];
+end
+A = [];
+P = [];
+if numel(varargin) >= 1
+    A = varargin{1};
+end
+if numel(varargin) >= 2
+    P = varargin{2};
+end
 
 if size(b, 2) > 1
     b = b(:);
@@ -20,5 +49,13 @@ end
 if size(c, 2) > 1
     c = c(:);
 end
+if issparse(P) && ~istriu(P)
+    P = triu(P + P') / 2;
+end
 
-feval(work.backend, 'update', b, c);
+if ~isempty(b) || ~isempty(c) || ~isempty(K)
+    feval(work.backend, 'update', work.handle, b, c, K);
+end
+if ~isempty(A) || ~isempty(P)
+    feval(work.backend, 'update_matrix', work.handle, A, P);
+end
@@ -54,6 +54,7 @@ function package_scs()
             fullfile(projectRoot, 'make_scs.m'), ...
             fullfile(projectRoot, 'package_scs.m'), ...
             fullfile(projectRoot, 'test'), ...
+            fullfile(projectRoot, 'bench'), ...
             fullfile(projectRoot, 'scs', '.git'), ...
             fullfile(projectRoot, 'scs', '.github'), ...
             fullfile(projectRoot, 'scs', 'test'), ...
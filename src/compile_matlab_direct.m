@@ -1,8 +1,10 @@
 function compile_matlab_direct(flags, common_scs)
-% compile MATLAB LDL direct solver (uses MATLAB's built-in ldl())
+% compile MATLAB LDL direct solver (uses MATLAB's built-in ldl() for the
+% initial factorization and QDLDL for numeric refactorizations)
 cmd = sprintf(['mex -O -v %s %s %s %s COMPFLAGS="$COMPFLAGS %s" CFLAGS="$CFLAGS %s" ' ...
-    '-Iscs -Iscs/linsys -Iscs/include -Isrc/matlab_linsys ' ...
-    'src/matlab_linsys/matlab_ldl_linsys.c %s %s %s %s -output matlab/scs_matlab_direct'], ...
+    '-DMATLAB_LDL -Iscs -Iscs/linsys -Iscs/include -Isrc/matlab_linsys ' ...
+    'src/matlab_linsys/matlab_ldl_linsys.c src/matlab_linsys/matlab_ldl_kernels.c ' ...
+    'scs/linsys/external/qdldl/qdldl.c %s %s %s %s -output matlab/scs_matlab_direct'], ...
     flags.arr, flags.LCFLAG, flags.INCS, flags.INT, flags.COMPFLAGS, ...
     flags.CFLAGS, common_scs, flags.link, flags.LOCS, flags.BLASLIB);
 disp(cmd);
@@ -0,0 +1,21 @@
+function compile_supernodal(flags, common_scs)
+% compile supernodal direct solver (in-tree supernodal LDL' on BLAS, AMD
+% ordering from the bundled sources)
+cmd = sprintf(['mex -O -v %s %s %s %s COMPFLAGS="$COMPFLAGS %s" CFLAGS="$CFLAGS %s" ' ...
+    '-DSUPERNODAL_LDL -Iscs -Iscs/linsys -Iscs/include -Isrc/supernodal_linsys'], ...
+    flags.arr, flags.LCFLAG, flags.INCS, flags.INT, flags.COMPFLAGS, flags.CFLAGS);
+
+amd_files = {'amd_order', 'amd_dump', 'amd_postorder', 'amd_post_tree', ...
+    'amd_aat', 'amd_2', 'amd_1', 'amd_defaults', 'amd_control', ...
+    'amd_info', 'amd_valid', 'amd_global', 'amd_preprocess', ...
+    'SuiteSparse_config'} ;
+for i = 1 : length (amd_files)
+    cmd = sprintf ('%s scs/linsys/external/amd/%s.c', cmd, amd_files {i}) ;
+end
+
+cmd = sprintf (['%s %s src/supernodal_linsys/sn_ldl.c ' ...
+    'src/supernodal_linsys/supernodal_linsys.c %s %s %s ' ...
+    '-output matlab/scs_supernodal'], ...
+    cmd, common_scs, flags.link, flags.LOCS, flags.BLASLIB);
+disp(cmd);
+eval(cmd);
@@ -0,0 +1,32 @@
+function compile_unified(flags, common_scs)
+% compile every CPU backend into one mex file, scs_unified, whose
+% workspaces pick their linear system backend at runtime (settings field
+% lin_sys_backend). Each backend is compiled once, in its own translation
+% unit under src/unified_linsys with its linsys.h functions renamed.
+cmd = sprintf(['mex -O -v %s %s %s %s COMPFLAGS="$COMPFLAGS %s" CFLAGS="$CFLAGS %s" ' ...
+    '-DUNIFIED_LINSYS -DMATLAB_LDL -DSUPERNODAL_LDL -Iscs -Iscs/linsys ' ...
+    '-Iscs/include -Isrc/unified_linsys -Isrc/matlab_linsys ' ...
+    '-Isrc/supernodal_linsys'], ...
+    flags.arr, flags.LCFLAG, flags.INCS, flags.INT, flags.COMPFLAGS, flags.CFLAGS);
+
+amd_files = {'amd_order', 'amd_dump', 'amd_postorder', 'amd_post_tree', ...
+    'amd_aat', 'amd_2', 'amd_1', 'amd_defaults', 'amd_control', ...
+    'amd_info', 'amd_valid', 'amd_global', 'amd_preprocess', ...
+    'SuiteSparse_config'} ;
+for i = 1 : length (amd_files)
+    cmd = sprintf ('%s scs/linsys/external/amd/%s.c', cmd, amd_files {i}) ;
+end
+
+backend_files = {'unified_linsys', 'lin_sys_matlab_direct', ...
+    'lin_sys_direct', 'lin_sys_indirect', 'lin_sys_dense', ...
+    'lin_sys_supernodal'};
+for i = 1 : length (backend_files)
+    cmd = sprintf ('%s src/unified_linsys/%s.c', cmd, backend_files {i}) ;
+end
+
+cmd = sprintf (['%s %s scs/linsys/external/qdldl/qdldl.c ' ...
+    'src/matlab_linsys/matlab_ldl_kernels.c src/supernodal_linsys/sn_ldl.c ' ...
+    '%s %s %s -output matlab/scs_unified'], ...
+    cmd, common_scs, flags.link, flags.LOCS, flags.BLASLIB);
+disp(cmd);
+eval(cmd);
@@ -0,0 +1,223 @@
+#include "matlab_ldl_kernels.h"
+
+/* x86 SIMD kernels are compiled per function with target attributes, so the
+ * rest of the mex needs no special flags and runs on any x86-64 CPU. Only
+ * double precision is vectorized. */
+#if (defined(__GNUC__) || defined(__clang__)) &&                               \
+    (defined(__x86_64__) || defined(__i386__)) && !defined(SFLOAT)
+#define LDL_X86_SIMD (1)
+#include <immintrin.h>
+#else
+#define LDL_X86_SIMD (0)
+#endif
+
+/* Triangular sweeps as one sparse dot product per row (CSR L) or column
+ * (CSC L), for a given target attribute, value type and dot product. */
+#define DEFINE_SWEEPS(ATTR, name, vtype, sdot)                                 \
+  ATTR static void lsolve_##name(scs_int n, const scs_int *Ltp,                \
+                                 const scs_int *Lti, const vtype *Ltx,         \
+                                 scs_float *x) {                               \
+    scs_int i;                                                                 \
+    for (i = 0; i < n; i++) {                                                  \
+      x[i] -= sdot(Ltp[i + 1] - Ltp[i], &Ltx[Ltp[i]], &Lti[Ltp[i]], x);        \
+    }                                                                          \
+  }                                                                            \
+  ATTR static void ltsolve_##name(scs_int n, const scs_int *Lp,                \
+                                  const scs_int *Li, const vtype *Lx,          \
+                                  scs_float *x) {                              \
+    scs_int i;                                                                 \
+    for (i = n - 1; i >= 0; i--) {                                             \
+      x[i] -= sdot(Lp[i + 1] - Lp[i], &Lx[Lp[i]], &Li[Lp[i]], x);              \
+    }                                                                          \
+  }                                                                            \
+  ATTR static scs_float sdot_##name##_fn(scs_int len, const vtype *v,          \
+                                         const scs_int *idx,                   \
+                                         const scs_float *x) {                 \
+    return sdot(len, v, idx, x);                                               \
+  }
+
+#define NO_ATTR
+
+/* ---- Scalar ---- */
+
+static inline scs_float sdot_scalar(scs_int len, const scs_float *v,
+                                    const scs_int *idx, const scs_float *x) {
+  scs_float acc = 0.0;
+  scs_int k;
+  for (k = 0; k < len; k++) {
+    acc += v[k] * x[idx[k]];
+  }
+  return acc;
+}
+
+static inline scs_float sdot_scalar_s(scs_int len, const float *v,
+                                      const scs_int *idx, const scs_float *x) {
+  scs_float acc = 0.0;
+  scs_int k;
+  for (k = 0; k < len; k++) {
+    acc += (scs_float)v[k] * x[idx[k]];
+  }
+  return acc;
+}
+
+static void gather_scalar(scs_int n, const scs_int *idx, const scs_float *src,
+                          scs_float *dst) {
+  scs_int i;
+  for (i = 0; i < n; i++) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+DEFINE_SWEEPS(NO_ATTR, scalar, scs_float, sdot_scalar)
+DEFINE_SWEEPS(NO_ATTR, scalar_s, float, sdot_scalar_s)
+
+static const ScsLdlKernels kernels_scalar = {
+    "scalar",          sdot_scalar_fn, gather_scalar,   lsolve_scalar,
+    ltsolve_scalar,    sdot_scalar_s_fn, lsolve_scalar_s, ltsolve_scalar_s};
+
+#if LDL_X86_SIMD
+
+/* ---- AVX2 (4 doubles per gather) ---- */
+
+#define AVX2 __attribute__((target("avx2,fma")))
+
+#ifdef DLONG
+#define GATHER4(x, idx)                                                        \
+  _mm256_i64gather_pd((x), _mm256_loadu_si256((const __m256i *)(idx)), 8)
+#else
+#define GATHER4(x, idx)                                                        \
+  _mm256_i32gather_pd((x), _mm_loadu_si128((const __m128i *)(idx)), 8)
+#endif
+
+/* values as 4 doubles, from double or float storage */
+#define LOAD4_D(v) _mm256_loadu_pd(v)
+#define LOAD4_S(v) _mm256_cvtps_pd(_mm_loadu_ps(v))
+
+#define DEFINE_SDOT_AVX2(name, vtype, LOAD4)                                   \
+  AVX2 static inline scs_float name(scs_int len, const vtype *v,               \
+                                    const scs_int *idx, const scs_float *x) {  \
+    __m256d acc0 = _mm256_setzero_pd(), acc1 = _mm256_setzero_pd();            \
+    __m128d lo;                                                                \
+    scs_float acc;                                                             \
+    scs_int k = 0;                                                             \
+    for (; k + 8 <= len; k += 8) {                                             \
+      acc0 = _mm256_fmadd_pd(LOAD4(&v[k]), GATHER4(x, &idx[k]), acc0);        \
+      acc1 = _mm256_fmadd_pd(LOAD4(&v[k + 4]), GATHER4(x, &idx[k + 4]),       \
+                             acc1);                                            \
+    }                                                                          \
+    for (; k + 4 <= len; k += 4) {                                             \
+      acc0 = _mm256_fmadd_pd(LOAD4(&v[k]), GATHER4(x, &idx[k]), acc0);        \
+    }                                                                          \
+    acc0 = _mm256_add_pd(acc0, acc1);                                          \
+    lo = _mm_add_pd(_mm256_castpd256_pd128(acc0),                              \
+                    _mm256_extractf128_pd(acc0, 1));                           \
+    acc = _mm_cvtsd_f64(_mm_add_sd(lo, _mm_unpackhi_pd(lo, lo)));              \
+    for (; k < len; k++) {                                                     \
+      acc += (scs_float)v[k] * x[idx[k]];                                      \
+    }                                                                          \
+    return acc;                                                                \
+  }
+
+DEFINE_SDOT_AVX2(sdot_avx2, scs_float, LOAD4_D)
+DEFINE_SDOT_AVX2(sdot_avx2_s, float, LOAD4_S)
+
+AVX2 static void gather_avx2(scs_int n, const scs_int *idx,
+                             const scs_float *src, scs_float *dst) {
+  scs_int i = 0;
+  for (; i + 4 <= n; i += 4) {
+    _mm256_storeu_pd(&dst[i], GATHER4(src, &idx[i]));
+  }
+  for (; i < n; i++) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+DEFINE_SWEEPS(AVX2, avx2, scs_float, sdot_avx2)
+DEFINE_SWEEPS(AVX2, avx2_s, float, sdot_avx2_s)
+
+static const ScsLdlKernels kernels_avx2 = {
+    "avx2",       sdot_avx2_fn,   gather_avx2,   lsolve_avx2,
+    ltsolve_avx2, sdot_avx2_s_fn, lsolve_avx2_s, ltsolve_avx2_s};
+
+/* ---- AVX-512 (8 doubles per gather) ---- */
+
+#define AVX512 __attribute__((target("avx512f")))
+
+#ifdef DLONG
+#define GATHER8(x, idx)                                                        \
+  _mm512_i64gather_pd(_mm512_loadu_si512((const void *)(idx)), (x), 8)
+#define MASK_GATHER8(mask, x, idx)                                             \
+  _mm512_mask_i64gather_pd(_mm512_setzero_pd(), (mask),                        \
+                           _mm512_maskz_loadu_epi64((mask), (idx)), (x), 8)
+#else
+#define GATHER8(x, idx)                                                        \
+  _mm512_i32gather_pd(_mm256_loadu_si256((const __m256i *)(idx)), (x), 8)
+#define MASK_GATHER8(mask, x, idx)                                             \
+  _mm512_mask_i32gather_pd(                                                    \
+      _mm512_setzero_pd(), (mask),                                             \
+      _mm512_castsi512_si256(                                                  \
+          _mm512_maskz_loadu_epi32((__mmask16)(mask), (idx))),                 \
+      (x), 8)
+#endif
+
+/* values as 8 doubles (masked: lanes past the mask are zero) */
+#define LOAD8_D(v) _mm512_loadu_pd(v)
+#define MASK_LOAD8_D(mask, v) _mm512_maskz_loadu_pd((mask), (v))
+#define LOAD8_S(v) _mm512_cvtps_pd(_mm256_loadu_ps(v))
+#define MASK_LOAD8_S(mask, v)                                                  \
+  _mm512_cvtps_pd(_mm512_castps512_ps256(                                      \
+      _mm512_maskz_loadu_ps((__mmask16)(mask), (v))))
+
+#define DEFINE_SDOT_AVX512(name, vtype, LOAD8, MASK_LOAD8)                     \
+  AVX512 static inline scs_float name(scs_int len, const vtype *v,             \
+                                      const scs_int *idx,                      \
+                                      const scs_float *x) {                    \
+    __m512d acc0 = _mm512_setzero_pd();                                        \
+    scs_int k = 0;                                                             \
+    for (; k + 8 <= len; k += 8) {                                             \
+      acc0 = _mm512_fmadd_pd(LOAD8(&v[k]), GATHER8(x, &idx[k]), acc0);        \
+    }                                                                          \
+    if (k < len) {                                                             \
+      /* masked tail: lanes past len load nothing */                           \
+      __mmask8 mask = (__mmask8)((1u << (len - k)) - 1u);                      \
+      acc0 = _mm512_fmadd_pd(MASK_LOAD8(mask, &v[k]),                          \
+                             MASK_GATHER8(mask, x, &idx[k]), acc0);            \
+    }                                                                          \
+    return _mm512_reduce_add_pd(acc0);                                         \
+  }
+
+DEFINE_SDOT_AVX512(sdot_avx512, scs_float, LOAD8_D, MASK_LOAD8_D)
+DEFINE_SDOT_AVX512(sdot_avx512_s, float, LOAD8_S, MASK_LOAD8_S)
+
+AVX512 static void gather_avx512(scs_int n, const scs_int *idx,
+                                 const scs_float *src, scs_float *dst) {
+  scs_int i = 0;
+  for (; i + 8 <= n; i += 8) {
+    _mm512_storeu_pd(&dst[i], GATHER8(src, &idx[i]));
+  }
+  for (; i < n; i++) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+DEFINE_SWEEPS(AVX512, avx512, scs_float, sdot_avx512)
+DEFINE_SWEEPS(AVX512, avx512_s, float, sdot_avx512_s)
+
+static const ScsLdlKernels kernels_avx512 = {
+    "avx512",       sdot_avx512_fn,   gather_avx512,   lsolve_avx512,
+    ltsolve_avx512, sdot_avx512_s_fn, lsolve_avx512_s, ltsolve_avx512_s};
+
+#endif /* LDL_X86_SIMD */
+
+const ScsLdlKernels *scs_ldl_kernels(void) {
+#if LDL_X86_SIMD
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f")) {
+    return &kernels_avx512;
+  }
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    return &kernels_avx2;
+  }
+#endif
+  return &kernels_scalar;
+}
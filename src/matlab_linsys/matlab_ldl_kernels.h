@@ -0,0 +1,44 @@
+#ifndef MATLAB_LDL_KERNELS_H_GUARD
+#define MATLAB_LDL_KERNELS_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "glbopts.h"
+
+/* Kernels for the solves with the cached LDL factors. Every triangular sweep
+ * is written as a sequence of sparse dot products (gathers), so L is walked
+ * in CSR order for L y = b and in CSC order for L' x = y, and there are no
+ * scatters. The set is chosen once at runtime for the CPU (AVX-512, AVX2 or
+ * scalar); all sets give the same results up to summation order. */
+typedef struct {
+  const char *isa;
+  /* sum_k v[k] * x[idx[k]], k = 0..len-1 */
+  scs_float (*sdot)(scs_int len, const scs_float *v, const scs_int *idx,
+                    const scs_float *x);
+  /* dst[i] = src[idx[i]], i = 0..n-1 */
+  void (*gather)(scs_int n, const scs_int *idx, const scs_float *src,
+                 scs_float *dst);
+  /* (L + I) x = b in place, L strictly lower triangular in CSR */
+  void (*lsolve)(scs_int n, const scs_int *Ltp, const scs_int *Lti,
+                 const scs_float *Ltx, scs_float *x);
+  /* (L + I)' x = b in place, L strictly lower triangular in CSC */
+  void (*ltsolve)(scs_int n, const scs_int *Lp, const scs_int *Li,
+                  const scs_float *Lx, scs_float *x);
+  /* The same three with float32 factor values (mixed-precision mode);
+   * x and the accumulation stay in scs_float */
+  scs_float (*sdot_s)(scs_int len, const float *v, const scs_int *idx,
+                      const scs_float *x);
+  void (*lsolve_s)(scs_int n, const scs_int *Ltp, const scs_int *Lti,
+                   const float *Ltx, scs_float *x);
+  void (*ltsolve_s)(scs_int n, const scs_int *Lp, const scs_int *Li,
+                    const float *Lx, scs_float *x);
+} ScsLdlKernels;
+
+const ScsLdlKernels *scs_ldl_kernels(void);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
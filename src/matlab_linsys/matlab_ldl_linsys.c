@@ -1,10 +1,192 @@
 #include "matlab_ldl_linsys.h"
+#include "util.h"
 #include <string.h>
 
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+/* The level-scheduled triangular solves are only used when L has at least
+ * this many entries and the levels hold this many rows on average; below
+ * that the barriers between levels cost more than the serial sweep. */
+#define PAR_TRISOLVE_MIN_NNZ (50000)
+#define PAR_TRISOLVE_MIN_ROWS_PER_LEVEL (64)
+
+/* Refinement with a stale factor stops once the last correction is below
+ * this relative to the solution */
+#define REFINE_TOL (1e-10)
+
+struct SCS_LIN_SYS_WORK {
+  scs_int m, n;
+  ScsMatrix *kkt;        /* KKT matrix in CSC format (upper triangular) */
+  scs_int *diag_r_idxs;  /* indices of R diagonal entries in kkt->x */
+  scs_float *diag_p;     /* diagonal of P (objective matrix) */
+
+  /* Cached LDL factors from MATLAB's ldl() */
+  ScsMatrix *L;          /* Lower triangular L factor (unit diagonal NOT stored) */
+  scs_float *D_diag;     /* Main diagonal of D, length n+m */
+  scs_float *D_sub;      /* Sub-diagonal of D, length n+m-1 (for 2x2 blocks) */
+  scs_int *perm;         /* Fill-reducing permutation (0-indexed) */
+  scs_int *pinv;         /* Inverse of perm */
+  scs_float *bp, *bq;    /* Workspaces for permuted RHS */
+  scs_float *D_inv_diag; /* D^{-1}: diagonal and sub-diagonal (2x2 blocks) */
+  scs_float *D_inv_sub;
+  scs_int D_has_2x2;
+  const ScsLdlKernels *kern; /* solve kernels for this CPU */
+  scs_int L_cap;         /* Allocated length of L->i and L->x */
+
+  /* Symbolic analysis for numeric-only refactorization, computed once for
+   * the ordering returned by ldl() */
+  ScsMatrix *kkt_perm;   /* Upper triangle of KKT(perm, perm) */
+  scs_int *kkt_perm_map; /* kkt->x index -> kkt_perm->x index */
+  scs_int *etree;        /* Elimination tree of kkt_perm */
+  scs_int *Lnz;          /* Column counts of L */
+  scs_float *Dinv;       /* QDLDL workspaces */
+  scs_int *iwork;
+  QDLDL_bool *bwork;
+  scs_float *fwork;
+
+  /* CSR copy of L and level schedules for the parallel triangular solves,
+   * rebuilt whenever the pattern of L changes (see trisolve_analyse) */
+  ScsMatlabLdlOpts opts;
+  scs_int L_pattern_dirty; /* L pattern changed since the last analysis */
+  scs_int L_from_qdldl;    /* L currently has the QDLDL (etree) pattern */
+  scs_int L_shared;        /* L->p, L->i, L->x borrowed from a preset factor */
+  scs_int fwd_par, bwd_par; /* use the level-scheduled solve */
+  scs_int *Ltp, *Lti;    /* L in CSR (row pointers, column indices) */
+  scs_float *Ltx;
+  scs_int *Lt_map;       /* L->x index -> Ltx index */
+  float *Lx_s, *Ltx_s;   /* float32 values of L and its CSR copy, used
+                          * instead of L->x (then freed) and Ltx with
+                          * opts.factor_single; written directly by
+                          * numeric refactorizations */
+  scs_int n_fwd_lvls, *fwd_lvl_ptr, *fwd_lvl_rows;
+  scs_int n_bwd_lvls, *bwd_lvl_ptr, *bwd_lvl_rows;
+
+  /* Stale-factor solves (see scs_update_lin_sys_diag_r) */
+  scs_float *diag_fact;  /* KKT diagonal the cached factors are for */
+  scs_int stale;         /* kkt diagonal differs from diag_fact */
+  scs_float *rhs, *dx;   /* refinement workspaces */
+  scs_int refine_steps;  /* refinement steps taken so far */
+
+  scs_int factorizations; /* all numeric factorizations */
+  scs_int ldl_calls;      /* of which done by MATLAB's ldl() */
+  scs_float factor_time;  /* ms spent in them */
+  scs_int solves;         /* calls of scs_solve_lin_sys */
+  scs_float solve_time;   /* ms spent in them */
+
+  ScsMatlabLdlSolveHook solve_hook; /* see scs_matlab_ldl_set_solve_hook */
+  void *solve_hook_ctx;
+};
+
+static ScsMatlabLdlOpts ldl_opts = {0, 0.0, 5, 0};
+
 const char *scs_get_lin_sys_method(void) {
   return "sparse-direct-matlab-ldl";
 }
 
+void scs_matlab_ldl_default_opts(ScsMatlabLdlOpts *opts) {
+  opts->threads = 0;
+  opts->refactor_tol = 0.0;
+  opts->refine_steps = 5;
+  opts->factor_single = 0;
+}
+
+void scs_matlab_ldl_set_opts(const ScsMatlabLdlOpts *opts) {
+  ldl_opts = *opts;
+}
+
+static ScsLinSysWork **ldl_reuse_from = SCS_NULL;
+static const ScsMatlabLdlFactor *ldl_preset = SCS_NULL;
+
+void scs_matlab_ldl_reuse_symbolic(ScsLinSysWork **from) {
+  ldl_reuse_from = from;
+}
+
+void scs_matlab_ldl_preset_factor(const ScsMatlabLdlFactor *f) {
+  ldl_preset = f;
+}
+
+void scs_matlab_ldl_get_stats(const ScsLinSysWork *p, ScsMatlabLdlStats *st) {
+  size_t N = (size_t)(p->n + p->m);
+  size_t I = sizeof(scs_int), F = sizeof(scs_float);
+  size_t kkt_nnz = (size_t)p->kkt->p[N];
+  size_t L_nnz = (size_t)p->L->p[N];
+
+  memset(st, 0, sizeof(ScsMatlabLdlStats));
+  st->kkt_nnz = (scs_int)kkt_nnz;
+  st->L_nnz = (scs_int)L_nnz;
+  st->factorizations = p->factorizations;
+  st->ldl_calls = p->ldl_calls;
+  st->solves = p->solves;
+  st->refine_steps = p->refine_steps;
+  st->factor_time = p->factor_time;
+  st->solve_time = p->solve_time;
+
+  st->kkt_bytes = (N + 1) * I + kkt_nnz * (I + F) + N * I + p->n * F;
+
+  /* D and its inverse (diagonal and subdiagonal), perm, pinv, diag_fact */
+  st->factor_bytes = 4 * N * F + 2 * N * I + N * F;
+  if (!p->L_shared) {
+    st->factor_bytes += (N + 1) * I + (size_t)p->L_cap * I;
+    if (p->L->x) {
+      st->factor_bytes += (size_t)p->L_cap * F;
+    }
+  }
+  if (p->Lx_s) {
+    st->factor_bytes += L_nnz * sizeof(float);
+  }
+
+  if (p->kkt_perm) {
+    st->symbolic_bytes = (N + 1) * I + kkt_nnz * (I + F) + kkt_nnz * I +
+                         5 * N * I + 2 * N * F + N * sizeof(QDLDL_bool);
+  }
+
+  /* bp, bq, rhs, dx */
+  st->solve_bytes = 4 * N * F;
+  if (p->Ltp) {
+    st->solve_bytes += (N + 1) * I + 2 * L_nnz * I +
+                       L_nnz * (p->Ltx_s ? sizeof(float) : F);
+  }
+  if (p->fwd_lvl_ptr) {
+    st->solve_bytes += ((size_t)p->n_fwd_lvls + 1 + N) * I;
+  }
+  if (p->bwd_lvl_ptr) {
+    st->solve_bytes += ((size_t)p->n_bwd_lvls + 1 + N) * I;
+  }
+}
+
+void scs_matlab_ldl_get_factor(const ScsLinSysWork *p, ScsMatlabLdlFactor *f) {
+  scs_int n_plus_m = p->n + p->m;
+
+  memset(f, 0, sizeof(ScsMatlabLdlFactor));
+  f->n_plus_m = n_plus_m;
+  f->kkt_nnz = p->kkt->p[n_plus_m];
+  f->kkt_x = p->kkt->x;
+  f->perm = p->perm;
+  if (!p->stale && p->L->x) {
+    f->L_nnz = p->L->p[n_plus_m];
+    f->L_from_qdldl = p->L_from_qdldl;
+    f->Lp = p->L->p;
+    f->Li = p->L->i;
+    f->Lx = p->L->x;
+    f->D_diag = p->D_diag;
+    f->D_sub = p->D_sub;
+  }
+}
+
+/* Free L, whose arrays may be borrowed (see scs_matlab_ldl_preset_factor). */
+static void free_L(ScsLinSysWork *p) {
+  if (p->L_shared) {
+    scs_free(p->L);
+  } else {
+    SCS(cs_spfree)(p->L);
+  }
+  p->L = SCS_NULL;
+  p->L_shared = 0;
+  p->L_cap = 0;
+}
+
 /* Convert upper-triangular ScsMatrix (CSC) to full symmetric MATLAB sparse.
  * For each off-diagonal entry (i,j) with i < j, we store both (i,j) and (j,i).
  * This avoids calling MATLAB functions for the symmetrization.
@@ -20,7 +202,10 @@ const char *scs_get_lin_sys_method(void) {
  *
  * The "upper triangle only" documentation likely means that for a structurally
  * symmetric input, ldl only *reads* the upper triangle for efficiency. It does
- * NOT mean you can omit the lower triangle entries from the sparsity pattern. */
+ * NOT mean you can omit the lower triangle entries from the sparsity pattern.
+ *
+ * The result is about twice the size of M, so it only lives for one ldl()
+ * call (see matlab_ldl_factor). */
 static mxArray *scs_to_mxsparse_symmetric(const ScsMatrix *M) {
   scs_int n = M->n;
   scs_int j, k, nnz_upper, nnz_full;
@@ -114,7 +299,8 @@ static mxArray *scs_to_mxsparse_symmetric(const ScsMatrix *M) {
 
 /* Extract L factor from MATLAB sparse mxArray into C ScsMatrix.
  * MATLAB's ldl returns L with unit diagonal stored; we strip the diagonal
- * to match QDLDL convention (only strictly lower-triangular entries). */
+ * to match QDLDL convention (only strictly lower-triangular entries).
+ * The existing L storage is reused when it is large enough. */
 static scs_int extract_L(ScsLinSysWork *p, const mxArray *L_mx) {
   scs_int n_plus_m = p->n + p->m;
   mwIndex *jc = mxGetJc(L_mx);
@@ -133,29 +319,35 @@ static scs_int extract_L(ScsLinSysWork *p, const mxArray *L_mx) {
     }
   }
 
-  /* Free old L if present */
-  if (p->L) {
-    SCS(cs_spfree)(p->L);
-  }
+  if (!p->L || p->L_shared || nnz_nodiag > p->L_cap ||
+      (nnz_nodiag > 0 && !p->L->x)) {
+    /* Free old L if present */
+    free_L(p);
 
-  /* Allocate new L */
-  p->L = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
-  if (!p->L) {
-    return -1;
-  }
-  p->L->m = n_plus_m;
-  p->L->n = n_plus_m;
-  p->L->p = (scs_int *)scs_calloc(n_plus_m + 1, sizeof(scs_int));
-  if (nnz_nodiag > 0) {
-    p->L->i = (scs_int *)scs_calloc(nnz_nodiag, sizeof(scs_int));
-    p->L->x = (scs_float *)scs_calloc(nnz_nodiag, sizeof(scs_float));
-  }
-  if (!p->L->p || (nnz_nodiag > 0 && (!p->L->i || !p->L->x))) {
-    SCS(cs_spfree)(p->L);
-    p->L = SCS_NULL;
-    return -1;
+    /* Allocate new L */
+    p->L = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+    p->L_cap = 0;
+    if (!p->L) {
+      return -1;
+    }
+    p->L->m = n_plus_m;
+    p->L->n = n_plus_m;
+    p->L->p = (scs_int *)scs_calloc(n_plus_m + 1, sizeof(scs_int));
+    if (nnz_nodiag > 0) {
+      p->L->i = (scs_int *)scs_calloc(nnz_nodiag, sizeof(scs_int));
+      p->L->x = (scs_float *)scs_calloc(nnz_nodiag, sizeof(scs_float));
+    }
+    if (!p->L->p || (nnz_nodiag > 0 && (!p->L->i || !p->L->x))) {
+      SCS(cs_spfree)(p->L);
+      p->L = SCS_NULL;
+      return -1;
+    }
+    p->L_cap = nnz_nodiag;
   }
 
+  p->L_pattern_dirty = 1;
+  p->L_from_qdldl = 0;
+
   /* Fill L, skipping diagonal entries */
   {
     scs_int write_idx = 0;
@@ -203,7 +395,8 @@ static scs_int extract_D(ScsLinSysWork *p, const mxArray *D_mx) {
   return 0;
 }
 
-/* Extract permutation vector from MATLAB double array to 0-indexed C array. */
+/* Extract permutation vector from MATLAB double array to 0-indexed C array,
+ * along with its inverse. */
 static void extract_perm(ScsLinSysWork *p, const mxArray *perm_mx) {
   scs_int n_plus_m = p->n + p->m;
   double *pr = mxGetPr(perm_mx);
@@ -211,40 +404,48 @@ static void extract_perm(ScsLinSysWork *p, const mxArray *perm_mx) {
 
   for (i = 0; i < n_plus_m; i++) {
     p->perm[i] = (scs_int)(pr[i] - 1); /* MATLAB 1-indexed to C 0-indexed */
+    p->pinv[p->perm[i]] = i;
   }
 }
 
 /* Factorize KKT matrix using MATLAB's ldl().
  * Calls [L, D, perm] = ldl(K_sym, 'vector') and extracts factors into C.
- * The KKT is stored as upper triangular in C; we build the full symmetric
- * MATLAB sparse matrix in C before calling ldl (see scs_to_mxsparse_symmetric
- * for why the full symmetric matrix is required).
+ * The KKT is stored as upper triangular in C; the full symmetric MATLAB
+ * sparse matrix is built for the call and freed right after it (see
+ * scs_to_mxsparse_symmetric for why the full symmetric matrix is required).
+ * ldl() only runs at init and when a numeric refactorization breaks down,
+ * so keeping it would double the KKT memory for little gain.
  *
- * This computes a full factorization including a new fill-reducing (AMD)
- * permutation every time it is called. Ideally we would separate the symbolic
- * analysis (which depends only on sparsity pattern) from the numeric
- * factorization (which depends on values). Unfortunately MATLAB's ldl() does
- * not expose separate symbolic/numeric phases — and while MATLAB does provide
- * amd() for computing orderings independently, there is no way to pass a
- * pre-computed permutation into ldl(). Under the hood ldl() uses HSL's MA57,
- * which does have separate analyze/factorize phases, but MATLAB's wrapper
- * bundles them into a single call. */
+ * This computes a full factorization including a new fill-reducing
+ * permutation every time it is called: MATLAB's ldl() does not expose
+ * separate symbolic/numeric phases, and there is no way to pass a
+ * pre-computed permutation into it (under the hood MA57 has separate
+ * analyze/factorize phases, but MATLAB's wrapper bundles them). We therefore
+ * only call it for the initial factorization, keep its ordering, and do all
+ * later refactorizations numerically in C (see ldl_symbolic and
+ * ldl_numeric_factor). */
 static scs_int matlab_ldl_factor(ScsLinSysWork *p) {
-  mxArray *K_sym, *rhs[2], *lhs[3];
+  mxArray *rhs[2], *lhs[3];
+  SCS(timer) timer;
+
+  SCS(tic)(&timer);
 
   /* Build full symmetric MATLAB sparse from upper-triangular C CSC */
-  K_sym = scs_to_mxsparse_symmetric(p->kkt);
+  rhs[0] = scs_to_mxsparse_symmetric(p->kkt);
+  if (!rhs[0]) {
+    return -1;
+  }
 
   /* [L, D, perm] = ldl(K_sym, 'vector') */
-  rhs[0] = K_sym;
   rhs[1] = mxCreateString("vector");
 
   {
     mxArray *err = mexCallMATLABWithTrap(3, lhs, 2, rhs, "ldl");
+    /* freed before the factors are copied out, to keep the peak down */
+    mxDestroyArray(rhs[0]);
+    mxDestroyArray(rhs[1]);
     if (err != NULL) {
       scs_printf("Error in MATLAB ldl() factorization.\n");
-      mxDestroyArray(K_sym);
-      mxDestroyArray(rhs[1]);
       mxDestroyArray(err);
       return -1;
     }
@@ -261,8 +462,6 @@ static scs_int matlab_ldl_factor(ScsLinSysWork *p) {
     }
 
     /* Clean up all MATLAB temporaries */
-    mxDestroyArray(K_sym);
-    mxDestroyArray(rhs[1]);
     mxDestroyArray(lhs[0]);
     mxDestroyArray(lhs[1]);
     mxDestroyArray(lhs[2]);
@@ -272,63 +471,705 @@ static scs_int matlab_ldl_factor(ScsLinSysWork *p) {
     }
   }
 
+  p->factorizations++;
+  p->ldl_calls++;
+  p->factor_time += SCS(tocq)(&timer);
+  return 0;
+}
+
+static void free_symbolic(ScsLinSysWork *p) {
+  SCS(cs_spfree)(p->kkt_perm);
+  p->kkt_perm = SCS_NULL;
+  scs_free(p->kkt_perm_map);
+  scs_free(p->etree);
+  scs_free(p->Lnz);
+  scs_free(p->Dinv);
+  scs_free(p->iwork);
+  scs_free(p->bwork);
+  scs_free(p->fwork);
+  p->kkt_perm_map = SCS_NULL;
+  p->etree = SCS_NULL;
+  p->Lnz = SCS_NULL;
+  p->Dinv = SCS_NULL;
+  p->iwork = SCS_NULL;
+  p->bwork = SCS_NULL;
+  p->fwork = SCS_NULL;
+}
+
+/* Symbolic analysis for the ordering in p->perm: form the upper triangle of
+ * KKT(perm, perm) once, together with the map from kkt->x positions into it,
+ * and compute its elimination tree and the column counts of L. Since the
+ * pattern never changes, every later refactorization is numeric only.
+ *
+ * The KKT matrix is quasi-definite, so it has an LDL' factorization with a
+ * diagonal D for any symmetric ordering; the 2x2 pivots MA57 may choose are
+ * not needed for existence. */
+static scs_int ldl_symbolic(ScsLinSysWork *p) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int *work, nnz_L;
+
+  free_symbolic(p);
+
+  p->kkt_perm_map = (scs_int *)scs_calloc(p->kkt->p[n_plus_m], sizeof(scs_int));
+  if (!p->kkt_perm_map) {
+    return -1;
+  }
+  p->kkt_perm = SCS(cs_symperm)(p->kkt, p->pinv, p->kkt_perm_map, 1);
+
+  work = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  p->etree = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  p->Lnz = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  p->Dinv = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->iwork = (scs_int *)scs_calloc(3 * n_plus_m, sizeof(scs_int));
+  p->bwork = (QDLDL_bool *)scs_calloc(n_plus_m, sizeof(QDLDL_bool));
+  p->fwork = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  if (!p->kkt_perm || !work || !p->etree || !p->Lnz || !p->Dinv ||
+      !p->iwork || !p->bwork || !p->fwork) {
+    scs_free(work);
+    return -1;
+  }
+
+  nnz_L = QDLDL_etree(n_plus_m, p->kkt_perm->p, p->kkt_perm->i, work, p->Lnz,
+                      p->etree);
+  scs_free(work);
+  if (nnz_L < 0) {
+    scs_printf("Error in LDL symbolic analysis (etree).\n");
+    return -1;
+  }
+  return 0;
+}
+
+/* Make room for nnz entries in L->i and L->x (contents are not kept). */
+static scs_int ensure_L_capacity(ScsLinSysWork *p, scs_int nnz) {
+  if (p->L_shared) {
+    /* stop borrowing the preset factor's arrays */
+    p->L->p = (scs_int *)scs_calloc(p->n + p->m + 1, sizeof(scs_int));
+    p->L->i = SCS_NULL;
+    p->L->x = SCS_NULL;
+    p->L_cap = 0;
+    p->L_shared = 0;
+    if (!p->L->p) {
+      return -1;
+    }
+  }
+  if (p->L_cap >= nnz) {
+    if (!p->L->x) {
+      /* dropped after rounding to float32 (opts.factor_single) */
+      p->L->x = (scs_float *)scs_calloc(MAX(p->L_cap, 1), sizeof(scs_float));
+      return p->L->x ? 0 : -1;
+    }
+    return 0;
+  }
+  scs_free(p->L->i);
+  scs_free(p->L->x);
+  p->L->i = (scs_int *)scs_calloc(MAX(nnz, 1), sizeof(scs_int));
+  p->L->x = (scs_float *)scs_calloc(MAX(nnz, 1), sizeof(scs_float));
+  if (!p->L->i || !p->L->x) {
+    p->L_cap = 0;
+    return -1;
+  }
+  p->L_cap = nnz;
+  return 0;
+}
+
+/* QDLDL_factor with the values of L kept in float32: the up-looking
+ * factorization of QDLDL, accumulating in double, that writes each entry of
+ * L rounded into p->Lx_s (and its CSR copy) and goes on with the rounded
+ * value. L->p and L->i must already hold the QDLDL pattern of this
+ * elimination tree, which the entries are produced in the order of, so no
+ * double copy of L is needed. Returns the number of positive pivots, or -1
+ * on a zero pivot. */
+static scs_int qdldl_factor_single(ScsLinSysWork *p) {
+  scs_int n = p->n + p->m;
+  const scs_int *Ap = p->kkt_perm->p, *Ai = p->kkt_perm->i;
+  const scs_float *Ax = p->kkt_perm->x;
+  const scs_int *Lp = p->L->p, *Li = p->L->i, *etree = p->etree;
+  float *Lx = p->Lx_s, *Ltx = p->Ltx_s;
+  scs_float *D = p->D_diag, *Dinv = p->Dinv, *y_vals = p->fwork;
+  scs_int *y_idx = p->iwork, *elim = p->iwork + n, *next = p->iwork + 2 * n;
+  QDLDL_bool *marked = p->bwork;
+  scs_int i, j, k, n_y, n_e, n_pos = 0;
+
+  for (i = 0; i < n; i++) {
+    marked[i] = 0;
+    y_vals[i] = 0.0;
+    D[i] = 0.0;
+    next[i] = Lp[i];
+  }
+  for (k = 0; k < n; k++) {
+    /* pattern of row k of L: the etree paths from the entries of column k
+     * of the upper triangle, in topological order */
+    n_y = 0;
+    for (j = Ap[k]; j < Ap[k + 1]; j++) {
+      i = Ai[j];
+      if (i == k) {
+        D[k] = Ax[j];
+        continue;
+      }
+      y_vals[i] = Ax[j];
+      for (n_e = 0; i >= 0 && i < k && !marked[i]; i = etree[i]) {
+        marked[i] = 1;
+        elim[n_e++] = i;
+      }
+      while (n_e) {
+        y_idx[n_y++] = elim[--n_e];
+      }
+    }
+    for (j = n_y - 1; j >= 0; j--) {
+      scs_int c = y_idx[j], q = next[c], r;
+      scs_float y_c = y_vals[c], l;
+      for (r = Lp[c]; r < q; r++) {
+        y_vals[Li[r]] -= (scs_float)Lx[r] * y_c;
+      }
+      Lx[q] = (float)(y_c * Dinv[c]);
+      Ltx[p->Lt_map[q]] = Lx[q];
+      l = (scs_float)Lx[q];
+      D[k] -= y_c * l;
+      next[c]++;
+      y_vals[c] = 0.0;
+      marked[c] = 0;
+    }
+    if (D[k] == 0.0) {
+      return -1;
+    }
+    if (D[k] > 0.0) {
+      n_pos++;
+    }
+    Dinv[k] = 1.0 / D[k];
+  }
+  return n_pos;
+}
+
+/* Numeric LDL' of kkt_perm with the fixed ordering and elimination tree from
+ * ldl_symbolic, written into the cached L / D_diag (D_sub is all zero since
+ * every pivot is 1x1). Fails if the pivots do not have the KKT inertia
+ * (n positive, m negative), which can only happen through rounding. With
+ * opts.factor_single, once L has the QDLDL pattern, the values go straight
+ * into the float32 arrays (qdldl_factor_single); only the first numeric
+ * factorization after an ldl() call needs a double L. */
+static scs_int ldl_numeric_factor(ScsLinSysWork *p) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int i, nnz_L = 0, n_pos;
+  SCS(timer) timer;
+
+  SCS(tic)(&timer);
+  if (p->opts.factor_single && p->L_from_qdldl && !p->L_pattern_dirty &&
+      p->Lx_s) {
+    n_pos = qdldl_factor_single(p);
+    p->factor_time += SCS(tocq)(&timer);
+    if (n_pos != p->n) {
+      return -1;
+    }
+    if (n_plus_m > 1) {
+      memset(p->D_sub, 0, (n_plus_m - 1) * sizeof(scs_float));
+    }
+    p->factorizations++;
+    return 0;
+  }
+  for (i = 0; i < n_plus_m; i++) {
+    nnz_L += p->Lnz[i];
+  }
+  if (ensure_L_capacity(p, nnz_L) < 0) {
+    return -1;
+  }
+  n_pos = QDLDL_factor(n_plus_m, p->kkt_perm->p, p->kkt_perm->i,
+                       p->kkt_perm->x, p->L->p, p->L->i, p->L->x, p->D_diag,
+                       p->Dinv, p->Lnz, p->etree, p->bwork, p->iwork,
+                       p->fwork);
+  p->factor_time += SCS(tocq)(&timer);
+  if (!p->L_from_qdldl) {
+    p->L_pattern_dirty = 1;
+    p->L_from_qdldl = 1;
+  }
+  if (n_pos != p->n) {
+    return -1;
+  }
+  if (n_plus_m > 1) {
+    memset(p->D_sub, 0, (n_plus_m - 1) * sizeof(scs_float));
+  }
   p->factorizations++;
   return 0;
 }
 
-/* Forward solve: (L + I) * x = b, where L is strictly lower-triangular.
- * Overwrites b with the solution. Same as QDLDL_Lsolve. */
-static void forward_solve(scs_int n, const scs_int *Lp, const scs_int *Li,
-                          const scs_float *Lx, scs_float *x) {
-  scs_int i, j;
+static void free_trisolve(ScsLinSysWork *p) {
+  scs_free(p->Ltp);
+  scs_free(p->Lti);
+  scs_free(p->Ltx);
+  scs_free(p->Lt_map);
+  scs_free(p->Lx_s);
+  scs_free(p->Ltx_s);
+  scs_free(p->fwd_lvl_ptr);
+  scs_free(p->fwd_lvl_rows);
+  scs_free(p->bwd_lvl_ptr);
+  scs_free(p->bwd_lvl_rows);
+  p->Ltp = SCS_NULL;
+  p->Lti = SCS_NULL;
+  p->Ltx = SCS_NULL;
+  p->Lt_map = SCS_NULL;
+  p->Lx_s = SCS_NULL;
+  p->Ltx_s = SCS_NULL;
+  p->fwd_lvl_ptr = SCS_NULL;
+  p->fwd_lvl_rows = SCS_NULL;
+  p->bwd_lvl_ptr = SCS_NULL;
+  p->bwd_lvl_rows = SCS_NULL;
+  p->n_fwd_lvls = 0;
+  p->n_bwd_lvls = 0;
+  p->fwd_par = 0;
+  p->bwd_par = 0;
+}
+
+/* CSR copy of L for the forward solve, so that both triangular solves are
+ * gathers (L y = b over the rows of L, L' x = y over its columns) and
+ * neither scatters into x. Lt_map[k] is the position of L->x[k] in Ltx. */
+static scs_int build_L_csr(ScsLinSysWork *p) {
+  scs_int n = p->n + p->m;
+  const scs_int *Lp = p->L->p, *Li = p->L->i;
+  scs_int nnz = Lp[n];
+  scs_int i, j, k, *next;
+
+  next = (scs_int *)scs_calloc(n + 1, sizeof(scs_int));
+  p->Ltp = (scs_int *)scs_calloc(n + 1, sizeof(scs_int));
+  p->Lti = (scs_int *)scs_calloc(MAX(nnz, 1), sizeof(scs_int));
+  p->Lt_map = (scs_int *)scs_calloc(MAX(nnz, 1), sizeof(scs_int));
+  if (p->opts.factor_single) {
+    p->Lx_s = (float *)scs_calloc(MAX(nnz, 1), sizeof(float));
+    p->Ltx_s = (float *)scs_calloc(MAX(nnz, 1), sizeof(float));
+  } else {
+    p->Ltx = (scs_float *)scs_calloc(MAX(nnz, 1), sizeof(scs_float));
+  }
+  if (!next || !p->Ltp || !p->Lti || !p->Lt_map ||
+      (p->opts.factor_single ? (!p->Lx_s || !p->Ltx_s) : !p->Ltx)) {
+    scs_free(next);
+    return -1;
+  }
+
+  for (k = 0; k < nnz; k++) {
+    p->Ltp[Li[k] + 1]++;
+  }
+  for (i = 0; i < n; i++) {
+    p->Ltp[i + 1] += p->Ltp[i];
+  }
+  memcpy(next, p->Ltp, (n + 1) * sizeof(scs_int));
+  for (j = 0; j < n; j++) {
+    for (k = Lp[j]; k < Lp[j + 1]; k++) {
+      scs_int pos = next[Li[k]]++;
+      p->Lti[pos] = j;
+      p->Lt_map[k] = pos;
+    }
+  }
+  scs_free(next);
+  return 0;
+}
+
+#ifdef _OPENMP
+static scs_int trisolve_threads(const ScsLinSysWork *p) {
+  return p->opts.threads > 0 ? p->opts.threads : omp_get_max_threads();
+}
+
+/* Bucket rows 0..n-1 by level (counting sort), so the rows of level l are
+ * rows[ptr[l]] .. rows[ptr[l+1]-1] in increasing order. */
+static scs_int bucket_levels(scs_int n, const scs_int *lvl, scs_int n_lvls,
+                             scs_int **ptr_out, scs_int **rows_out) {
+  scs_int i, l;
+  scs_int *ptr = (scs_int *)scs_calloc(n_lvls + 1, sizeof(scs_int));
+  scs_int *rows = (scs_int *)scs_calloc(MAX(n, 1), sizeof(scs_int));
+  if (!ptr || !rows) {
+    scs_free(ptr);
+    scs_free(rows);
+    return -1;
+  }
+  for (i = 0; i < n; i++) {
+    ptr[lvl[i] + 1]++;
+  }
+  for (l = 0; l < n_lvls; l++) {
+    ptr[l + 1] += ptr[l];
+  }
   for (i = 0; i < n; i++) {
-    scs_float val = x[i];
-    for (j = Lp[i]; j < Lp[i + 1]; j++) {
-      x[Li[j]] -= Lx[j] * val;
+    rows[ptr[lvl[i]]++] = i;
+  }
+  for (l = n_lvls; l > 0; l--) {
+    ptr[l] = ptr[l - 1];
+  }
+  ptr[0] = 0;
+  *ptr_out = ptr;
+  *rows_out = rows;
+  return 0;
+}
+
+/* Level sets of both triangular solves for the parallel solves. Row i of
+ * L y = b can be computed once every y(j) with L(i,j) != 0 is known, so its
+ * forward level is one more than the largest such level; backward levels
+ * are the same for L' (over the columns of L). Rows in one level are
+ * independent and are solved in parallel. */
+static scs_int build_levels(ScsLinSysWork *p) {
+  scs_int n = p->n + p->m;
+  const scs_int *Lp = p->L->p, *Li = p->L->i;
+  scs_int j, k, *lvl;
+
+  if (trisolve_threads(p) <= 1 || Lp[n] < PAR_TRISOLVE_MIN_NNZ) {
+    return 0;
+  }
+  lvl = (scs_int *)scs_calloc(MAX(n, 1), sizeof(scs_int));
+  if (!lvl) {
+    return -1;
+  }
+
+  /* Forward levels: columns in order, so lvl[j] is final when visited */
+  p->n_fwd_lvls = n > 0 ? 1 : 0;
+  for (j = 0; j < n; j++) {
+    for (k = Lp[j]; k < Lp[j + 1]; k++) {
+      lvl[Li[k]] = MAX(lvl[Li[k]], lvl[j] + 1);
+      p->n_fwd_lvls = MAX(p->n_fwd_lvls, lvl[Li[k]] + 1);
+    }
+  }
+  if (bucket_levels(n, lvl, p->n_fwd_lvls, &p->fwd_lvl_ptr,
+                    &p->fwd_lvl_rows) < 0) {
+    scs_free(lvl);
+    return -1;
+  }
+
+  /* Backward levels: x(j) needs every x(i) with L(i,j) != 0, i > j */
+  p->n_bwd_lvls = n > 0 ? 1 : 0;
+  for (j = n - 1; j >= 0; j--) {
+    lvl[j] = 0;
+    for (k = Lp[j]; k < Lp[j + 1]; k++) {
+      lvl[j] = MAX(lvl[j], lvl[Li[k]] + 1);
+    }
+    p->n_bwd_lvls = MAX(p->n_bwd_lvls, lvl[j] + 1);
+  }
+  if (bucket_levels(n, lvl, p->n_bwd_lvls, &p->bwd_lvl_ptr,
+                    &p->bwd_lvl_rows) < 0) {
+    scs_free(lvl);
+    return -1;
+  }
+  scs_free(lvl);
+
+  p->fwd_par = n >= PAR_TRISOLVE_MIN_ROWS_PER_LEVEL * p->n_fwd_lvls;
+  p->bwd_par = n >= PAR_TRISOLVE_MIN_ROWS_PER_LEVEL * p->n_bwd_lvls;
+  return 0;
+}
+
+/* Level-scheduled forward solve (L + I) * x = b using the CSR copy of L:
+ * within a level every row is an independent gather. */
+static void par_forward_solve(const ScsLinSysWork *p, scs_float *x) {
+  const scs_int *ptr = p->fwd_lvl_ptr, *rows = p->fwd_lvl_rows;
+  const scs_int *Ltp = p->Ltp, *Lti = p->Lti;
+  const scs_float *Ltx = p->Ltx;
+  const float *Ltx_s = p->Ltx_s;
+  const ScsLdlKernels *kern = p->kern;
+  scs_int n_lvls = p->n_fwd_lvls;
+
+#pragma omp parallel num_threads(trisolve_threads(p))
+  {
+    scs_int l, r, i;
+    for (l = 0; l < n_lvls; l++) {
+#pragma omp for schedule(static)
+      for (r = ptr[l]; r < ptr[l + 1]; r++) {
+        i = rows[r];
+        x[i] -= Ltx_s ? kern->sdot_s(Ltp[i + 1] - Ltp[i], &Ltx_s[Ltp[i]],
+                                     &Lti[Ltp[i]], x)
+                      : kern->sdot(Ltp[i + 1] - Ltp[i], &Ltx[Ltp[i]],
+                                   &Lti[Ltp[i]], x);
+      }
     }
   }
 }
 
-/* Backward solve: (L + I)' * x = b, where L is strictly lower-triangular.
- * Overwrites b with the solution. Same as QDLDL_Ltsolve. */
-static void backward_solve(scs_int n, const scs_int *Lp, const scs_int *Li,
-                           const scs_float *Lx, scs_float *x) {
-  scs_int i, j;
-  for (i = n - 1; i >= 0; i--) {
-    scs_float val = x[i];
-    for (j = Lp[i]; j < Lp[i + 1]; j++) {
-      val -= Lx[j] * x[Li[j]];
+/* Level-scheduled backward solve (L + I)' * x = b: column j of L holds
+ * exactly the entries of row j of L', so each row is a gather over it. */
+static void par_backward_solve(const ScsLinSysWork *p, scs_float *x) {
+  const scs_int *ptr = p->bwd_lvl_ptr, *rows = p->bwd_lvl_rows;
+  const scs_int *Lp = p->L->p, *Li = p->L->i;
+  const scs_float *Lx = p->L->x;
+  const float *Lx_s = p->Lx_s;
+  const ScsLdlKernels *kern = p->kern;
+  scs_int n_lvls = p->n_bwd_lvls;
+
+#pragma omp parallel num_threads(trisolve_threads(p))
+  {
+    scs_int l, r, j;
+    for (l = 0; l < n_lvls; l++) {
+#pragma omp for schedule(static)
+      for (r = ptr[l]; r < ptr[l + 1]; r++) {
+        j = rows[r];
+        x[j] -= Lx_s ? kern->sdot_s(Lp[j + 1] - Lp[j], &Lx_s[Lp[j]],
+                                    &Li[Lp[j]], x)
+                     : kern->sdot(Lp[j + 1] - Lp[j], &Lx[Lp[j]], &Li[Lp[j]],
+                                  x);
+      }
     }
-    x[i] = val;
   }
 }
+#endif
+
+/* Analyse a new pattern of L: the CSR copy, and with OpenMP the level
+ * schedules. Returns -1 only on allocation failure. */
+static scs_int trisolve_analyse(ScsLinSysWork *p) {
+  free_trisolve(p);
+  p->L_pattern_dirty = 0;
+  if (build_L_csr(p) < 0) {
+    free_trisolve(p);
+    return -1;
+  }
+#ifdef _OPENMP
+  if (build_levels(p) < 0) {
+    scs_printf("Warning: parallel triangular solve disabled (out of "
+               "memory).\n");
+    p->fwd_par = 0;
+    p->bwd_par = 0;
+  }
+#endif
+  return 0;
+}
 
-/* Block-diagonal solve: D * z = y, where D is tridiagonal with 1x1 and 2x2
- * Bunch-Kaufman blocks. Overwrites y with the solution. */
-static void diag_solve(scs_int n, const scs_float *D_diag,
-                       const scs_float *D_sub, scs_float *x) {
+/* Invert the 1x1 and 2x2 blocks of D once per factorization, so the
+ * block-diagonal solve is a branch-free tridiagonal multiply. Entries of
+ * D_inv_sub that do not couple a 2x2 block are zero. */
+static void invert_D(ScsLinSysWork *p) {
+  scs_int n = p->n + p->m;
   scs_int i = 0;
+
+  p->D_has_2x2 = 0;
   while (i < n) {
-    if (i < n - 1 && D_sub[i] != 0.0) {
+    if (i < n - 1 && p->D_sub[i] != 0.0) {
       /* 2x2 block: [a b; b d] */
-      scs_float a = D_diag[i], b = D_sub[i], d = D_diag[i + 1];
+      scs_float a = p->D_diag[i], b = p->D_sub[i], d = p->D_diag[i + 1];
       scs_float det = a * d - b * b;
-      scs_float y0 = x[i], y1 = x[i + 1];
-      x[i] = (d * y0 - b * y1) / det;
-      x[i + 1] = (a * y1 - b * y0) / det;
+      p->D_inv_diag[i] = d / det;
+      p->D_inv_diag[i + 1] = a / det;
+      p->D_inv_sub[i] = -b / det;
+      if (i + 1 < n - 1) {
+        p->D_inv_sub[i + 1] = 0.0;
+      }
+      p->D_has_2x2 = 1;
       i += 2;
     } else {
       /* 1x1 block */
-      x[i] /= D_diag[i];
+      p->D_inv_diag[i] = 1.0 / p->D_diag[i];
+      if (i < n - 1) {
+        p->D_inv_sub[i] = 0.0;
+      }
       i += 1;
     }
   }
 }
 
+/* Bring the solve data in line with a new factorization: the CSR copy of L
+ * (re-analysed if the pattern changed, otherwise only its values are
+ * refreshed) and the inverted blocks of D. With opts.factor_single a
+ * double L (from ldl(), a preset, or the first numeric factorization in a
+ * new pattern) is rounded to float32 here and dropped; D is O(n) and stays
+ * in double. */
+static scs_int prepare_solve(ScsLinSysWork *p) {
+  scs_int k, nnz;
+
+  if (p->L_pattern_dirty && trisolve_analyse(p) < 0) {
+    return -1;
+  }
+  nnz = p->L->p[p->n + p->m];
+  if (p->opts.factor_single) {
+    if (!p->L->x) {
+      /* written in float32 by qdldl_factor_single */
+      invert_D(p);
+      return 0;
+    }
+    for (k = 0; k < nnz; k++) {
+      p->Lx_s[k] = (float)p->L->x[k];
+      p->Ltx_s[p->Lt_map[k]] = p->Lx_s[k];
+    }
+    if (!p->L_shared) {
+      scs_free(p->L->x);
+    }
+    p->L->x = SCS_NULL;
+  } else {
+    for (k = 0; k < nnz; k++) {
+      p->Ltx[p->Lt_map[k]] = p->L->x[k];
+    }
+  }
+  invert_D(p);
+  return 0;
+}
+
+/* Block-diagonal solve z = D \ y with the inverted blocks from invert_D. */
+static void diag_solve(scs_int n, const scs_float *D_inv_diag,
+                       const scs_float *D_inv_sub, scs_int has_2x2,
+                       const scs_float *y, scs_float *z) {
+  scs_int i;
+  if (!has_2x2 || n < 2) {
+    for (i = 0; i < n; i++) {
+      z[i] = D_inv_diag[i] * y[i];
+    }
+    return;
+  }
+  z[0] = D_inv_diag[0] * y[0] + D_inv_sub[0] * y[1];
+  for (i = 1; i < n - 1; i++) {
+    z[i] = D_inv_sub[i - 1] * y[i - 1] + D_inv_diag[i] * y[i] +
+           D_inv_sub[i] * y[i + 1];
+  }
+  z[n - 1] = D_inv_sub[n - 2] * y[n - 2] + D_inv_diag[n - 1] * y[n - 1];
+}
+
+/* Numeric refactorization for the current KKT values, falling back to a full
+ * MATLAB ldl() (with its pivoting) and a new symbolic analysis for the
+ * ordering it returns if the fixed-ordering factorization breaks down. */
+static scs_int refactor(ScsLinSysWork *p) {
+  scs_int i;
+
+  if (ldl_numeric_factor(p) < 0) {
+    if (matlab_ldl_factor(p) < 0 || ldl_symbolic(p) < 0) {
+      scs_printf("Error in LDL refactorization.\n");
+      return -1;
+    }
+  }
+  if (prepare_solve(p) < 0) {
+    scs_printf("Error allocating memory for the LDL solve.\n");
+    return -1;
+  }
+  for (i = 0; i < p->n + p->m; i++) {
+    p->diag_fact[i] = p->kkt->x[p->diag_r_idxs[i]];
+  }
+  p->stale = 0;
+  return 0;
+}
+
+/* Whether the workspace q offered by scs_matlab_ldl_reuse_symbolic can
+ * take the newly formed p->kkt: same dimensions, KKT pattern and factor
+ * storage. */
+static scs_int same_kkt_pattern(const ScsLinSysWork *q,
+                                const ScsLinSysWork *p) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int nnz = p->kkt->p[n_plus_m];
+
+  return q->n == p->n && q->m == p->m && q->kkt_perm &&
+         q->opts.factor_single == p->opts.factor_single &&
+         q->kkt->p[n_plus_m] == nnz &&
+         !memcmp(q->kkt->p, p->kkt->p, (n_plus_m + 1) * sizeof(scs_int)) &&
+         !memcmp(q->kkt->i, p->kkt->i, nnz * sizeof(scs_int));
+}
+
+/* Move the new KKT values of p into q (see same_kkt_pattern), free p and
+ * refactorize q numerically with its ordering and elimination tree. */
+static scs_int reuse_symbolic(ScsLinSysWork *p, ScsLinSysWork *q) {
+  scs_int k, nnz = p->kkt->p[p->n + p->m];
+
+  SCS(cs_spfree)(q->kkt);
+  q->kkt = p->kkt;
+  p->kkt = SCS_NULL;
+  memcpy(q->diag_p, p->diag_p, p->n * sizeof(scs_float));
+  for (k = 0; k < nnz; k++) {
+    q->kkt_perm->x[q->kkt_perm_map[k]] = q->kkt->x[k];
+  }
+  q->opts = p->opts;
+  q->factorizations = 0;
+  q->ldl_calls = 0;
+  q->refine_steps = 0;
+  q->factor_time = 0.0;
+  q->solves = 0;
+  q->solve_time = 0.0;
+  scs_free_lin_sys_work(p);
+  return refactor(q);
+}
+
+/* Whether the preset factorization f fits p->kkt: the ordering is a
+ * permutation of the right size and L, if present, is strictly lower
+ * triangular CSC (the data come from a file). */
+static scs_int preset_fits(const ScsLinSysWork *p,
+                           const ScsMatlabLdlFactor *f) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int i, j, k;
+
+  if (f->n_plus_m != n_plus_m || f->kkt_nnz != p->kkt->p[n_plus_m]) {
+    return 0;
+  }
+  /* pinv as scratch to check that perm is a permutation */
+  for (i = 0; i < n_plus_m; i++) {
+    p->pinv[i] = -1;
+  }
+  for (i = 0; i < n_plus_m; i++) {
+    if (f->perm[i] < 0 || f->perm[i] >= n_plus_m || p->pinv[f->perm[i]] >= 0) {
+      return 0;
+    }
+    p->pinv[f->perm[i]] = i;
+  }
+  if (f->Lp) {
+    if (f->Lp[0] != 0 || f->Lp[n_plus_m] != f->L_nnz) {
+      return 0;
+    }
+    for (j = 0; j < n_plus_m; j++) {
+      if (f->Lp[j + 1] < f->Lp[j] || f->Lp[j + 1] > f->L_nnz) {
+        return 0;
+      }
+      for (k = f->Lp[j]; k < f->Lp[j + 1]; k++) {
+        if (f->Li[k] <= j || f->Li[k] >= n_plus_m) {
+          return 0;
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/* Factorize p->kkt with the ordering of the preset f (see preset_fits),
+ * taking L and D from f as they are if f factors exactly these KKT values.
+ * Falls back to ldl() as refactor does. */
+static scs_int use_preset(ScsLinSysWork *p, const ScsMatlabLdlFactor *f) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int j, L_from_qdldl = f->L_from_qdldl;
+
+  memcpy(p->perm, f->perm, n_plus_m * sizeof(scs_int));
+  if (ldl_symbolic(p) < 0) {
+    return -1;
+  }
+  /* qdldl_factor_single writes into the stored pattern of L as the etree's:
+   * trust the flag only if every column has the count ldl_symbolic found */
+  for (j = 0; L_from_qdldl && f->Lp && j < n_plus_m; j++) {
+    if (f->Lp[j + 1] - f->Lp[j] != p->Lnz[j]) {
+      L_from_qdldl = 0;
+    }
+  }
+  if (f->Lp && !memcmp(f->kkt_x, p->kkt->x, f->kkt_nnz * sizeof(scs_float))) {
+    p->L = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+    if (!p->L) {
+      return -1;
+    }
+    p->L->m = n_plus_m;
+    p->L->n = n_plus_m;
+    p->L->p = (scs_int *)f->Lp;
+    p->L->i = (scs_int *)f->Li;
+    p->L->x = (scs_float *)f->Lx;
+    p->L_shared = 1;
+    p->L_cap = f->L_nnz;
+    p->L_pattern_dirty = 1;
+    p->L_from_qdldl = L_from_qdldl;
+    memcpy(p->D_diag, f->D_diag, n_plus_m * sizeof(scs_float));
+    if (n_plus_m > 1) {
+      memcpy(p->D_sub, f->D_sub, (n_plus_m - 1) * sizeof(scs_float));
+    }
+    return prepare_solve(p);
+  }
+  p->L = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+  if (!p->L) {
+    return -1;
+  }
+  p->L->m = n_plus_m;
+  p->L->n = n_plus_m;
+  p->L->p = (scs_int *)scs_calloc(n_plus_m + 1, sizeof(scs_int));
+  if (!p->L->p) {
+    return -1;
+  }
+  return refactor(p);
+}
+
 ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
                                      const scs_float *diag_r) {
   scs_int n_plus_m = A->n + A->m;
+  scs_int i;
+  ScsLinSysWork **reuse_from = ldl_reuse_from;
+  const ScsMatlabLdlFactor *preset = ldl_preset;
   ScsLinSysWork *p = (ScsLinSysWork *)scs_calloc(1, sizeof(ScsLinSysWork));
+
+  ldl_reuse_from = SCS_NULL;
+  ldl_preset = SCS_NULL;
   if (!p) {
     return SCS_NULL;
   }
@@ -342,10 +1183,24 @@ ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
   p->D_sub = (scs_float *)scs_calloc(n_plus_m > 0 ? n_plus_m - 1 : 0,
                                       sizeof(scs_float));
   p->perm = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  p->pinv = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
   p->bp = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->bq = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->D_inv_diag = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->D_inv_sub = (scs_float *)scs_calloc(n_plus_m > 0 ? n_plus_m - 1 : 0,
+                                         sizeof(scs_float));
+  p->diag_fact = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->rhs = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
+  p->dx = (scs_float *)scs_calloc(n_plus_m, sizeof(scs_float));
   p->factorizations = 0;
+  p->ldl_calls = 0;
+  p->opts = ldl_opts;
+#ifdef SFLOAT
+  p->opts.factor_single = 0; /* factors are float32 already */
+#endif
+  p->kern = scs_ldl_kernels();
 
-  if (!p->diag_p || !p->diag_r_idxs || !p->D_diag || (n_plus_m > 1 && !p->D_sub) || !p->perm || !p->bp) {
+  if (!p->diag_p || !p->diag_r_idxs || !p->D_diag || (n_plus_m > 1 && !p->D_sub) || !p->perm || !p->pinv || !p->bp || !p->bq || !p->D_inv_diag || (n_plus_m > 1 && !p->D_inv_sub) || !p->diag_fact || !p->rhs || !p->dx) {
     scs_printf("Error allocating memory for linear system workspace.\n");
     scs_free_lin_sys_work(p);
     return SCS_NULL;
@@ -359,6 +1214,30 @@ ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
     return SCS_NULL;
   }
 
+  /* Same KKT pattern as an offered workspace: numeric refactorization only */
+  if (reuse_from && *reuse_from && same_kkt_pattern(*reuse_from, p)) {
+    ScsLinSysWork *q = *reuse_from;
+    *reuse_from = SCS_NULL;
+    if (reuse_symbolic(p, q) < 0) {
+      scs_free_lin_sys_work(q);
+      return SCS_NULL;
+    }
+    return q;
+  }
+
+  /* Stored factorization (workspace file): no ldl() call */
+  if (preset && preset_fits(p, preset)) {
+    if (use_preset(p, preset) < 0) {
+      scs_printf("Error in LDL factorization with the stored ordering.\n");
+      scs_free_lin_sys_work(p);
+      return SCS_NULL;
+    }
+    for (i = 0; i < n_plus_m; i++) {
+      p->diag_fact[i] = p->kkt->x[p->diag_r_idxs[i]];
+    }
+    return p;
+  }
+
   /* Factorize via MATLAB's ldl and cache factors in C */
   if (matlab_ldl_factor(p) < 0) {
     scs_printf("Error in initial LDL factorization.\n");
@@ -366,73 +1245,231 @@ ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
     return SCS_NULL;
   }
 
+  /* Keep ldl()'s ordering for all later (numeric-only) refactorizations */
+  if (ldl_symbolic(p) < 0) {
+    scs_printf("Error in LDL symbolic analysis.\n");
+    scs_free_lin_sys_work(p);
+    return SCS_NULL;
+  }
+
+  if (prepare_solve(p) < 0) {
+    scs_printf("Error allocating memory for the LDL solve.\n");
+    scs_free_lin_sys_work(p);
+    return SCS_NULL;
+  }
+  for (i = 0; i < n_plus_m; i++) {
+    p->diag_fact[i] = p->kkt->x[p->diag_r_idxs[i]];
+  }
+
   return p;
 }
 
-/* Solve the KKT system using cached LDL factors.
- * K(p,p) = L*D*L' => K = P'*L*D*L'*P.
- * Solution overwrites b. */
-scs_int scs_solve_lin_sys(ScsLinSysWork *p, scs_float *b, const scs_float *s,
-                          scs_float tol) {
+/* Solve with the cached LDL factors: K(p,p) = L*D*L' => K = P'*L*D*L'*P.
+ * x may alias b. */
+static void factor_solve(ScsLinSysWork *p, const scs_float *b, scs_float *x) {
   scs_int n_plus_m = p->n + p->m;
-  scs_int i;
 
   /* Permute: bp = b(perm) */
-  for (i = 0; i < n_plus_m; i++) {
-    p->bp[i] = b[p->perm[i]];
-  }
+  p->kern->gather(n_plus_m, p->perm, b, p->bp);
 
   /* Forward solve: L * y = bp */
-  forward_solve(n_plus_m, p->L->p, p->L->i, p->L->x, p->bp);
+#ifdef _OPENMP
+  if (p->fwd_par) {
+    par_forward_solve(p, p->bp);
+  } else
+#endif
+    if (p->opts.factor_single) {
+      p->kern->lsolve_s(n_plus_m, p->Ltp, p->Lti, p->Ltx_s, p->bp);
+    } else {
+      p->kern->lsolve(n_plus_m, p->Ltp, p->Lti, p->Ltx, p->bp);
+    }
 
   /* Block-diagonal solve: D * z = y */
-  diag_solve(n_plus_m, p->D_diag, p->D_sub, p->bp);
+  diag_solve(n_plus_m, p->D_inv_diag, p->D_inv_sub, p->D_has_2x2, p->bp,
+             p->bq);
 
   /* Backward solve: L' * x = z */
-  backward_solve(n_plus_m, p->L->p, p->L->i, p->L->x, p->bp);
+#ifdef _OPENMP
+  if (p->bwd_par) {
+    par_backward_solve(p, p->bq);
+  } else
+#endif
+    if (p->opts.factor_single) {
+      p->kern->ltsolve_s(n_plus_m, p->L->p, p->L->i, p->Lx_s, p->bq);
+    } else {
+      p->kern->ltsolve(n_plus_m, p->L->p, p->L->i, p->L->x, p->bq);
+    }
 
-  /* Inverse permute: b(perm) = bp */
-  for (i = 0; i < n_plus_m; i++) {
-    b[p->perm[i]] = p->bp[i];
+  /* Inverse permute: x = z(pinv), i.e. x(perm) = z */
+  p->kern->gather(n_plus_m, p->pinv, p->bq, x);
+}
+
+/* r = rhs - K x with the current KKT matrix (upper triangle in kkt). */
+static void kkt_residual(const ScsLinSysWork *p, const scs_float *rhs,
+                         const scs_float *x, scs_float *r) {
+  const ScsMatrix *K = p->kkt;
+  scs_int i, j, k;
+
+  memcpy(r, rhs, (p->n + p->m) * sizeof(scs_float));
+  for (j = 0; j < K->n; j++) {
+    for (k = K->p[j]; k < K->p[j + 1]; k++) {
+      i = K->i[k];
+      r[i] -= K->x[k] * x[j];
+      if (i != j) {
+        r[j] -= K->x[k] * x[i];
+      }
+    }
+  }
+}
+
+/* Iterative refinement x <- x + F \ (rhs - K x), where F is the matrix the
+ * cached factors represent: stale (K differs from F on the diagonal, see
+ * scs_update_lin_sys_diag_r) and/or rounded to float32. Starts from
+ * x = F \ rhs. Returns 1 once the last correction is below REFINE_TOL
+ * relative to x, 0 if it did not converge within opts.refine_steps steps or
+ * stopped contracting. */
+static scs_int refine_solve(ScsLinSysWork *p, const scs_float *rhs,
+                            scs_float *x) {
+  scs_int n_plus_m = p->n + p->m;
+  scs_int i, it;
+  scs_float dx_nrm, x_nrm, dx_prev = 0.0;
+
+  factor_solve(p, rhs, x);
+  for (it = 0; it < p->opts.refine_steps; it++) {
+    kkt_residual(p, rhs, x, p->dx);
+    factor_solve(p, p->dx, p->dx);
+    p->refine_steps++;
+    dx_nrm = 0.0;
+    x_nrm = 0.0;
+    for (i = 0; i < n_plus_m; i++) {
+      x[i] += p->dx[i];
+      dx_nrm = MAX(dx_nrm, ABS(p->dx[i]));
+      x_nrm = MAX(x_nrm, ABS(x[i]));
+    }
+    if (dx_nrm <= REFINE_TOL * x_nrm) {
+      return 1;
+    }
+    if (it > 0 && dx_nrm >= dx_prev) {
+      return 0; /* not contracting */
+    }
+    dx_prev = dx_nrm;
+  }
+  return 0;
+}
+
+/* Solve the KKT system using cached LDL factors.
+ * Solution overwrites b.
+ *
+ * Exact factors are used directly. Stale or float32 factors are refined
+ * (see refine_solve); if that fails with stale factors we refactorize now
+ * and solve again. Float32 factors of the current matrix are as good as
+ * they get, so their result is returned as is. */
+static scs_int ldl_solve(ScsLinSysWork *p, scs_float *b) {
+  scs_int n_plus_m = p->n + p->m;
+
+  if (!p->stale && !p->opts.factor_single) {
+    factor_solve(p, b, b);
+    return 0;
+  }
+
+  memcpy(p->rhs, b, n_plus_m * sizeof(scs_float));
+  if (refine_solve(p, p->rhs, b) || !p->stale) {
+    return 0;
   }
 
+  /* Drift too large for the stale factor */
+  if (refactor(p) < 0) {
+    return -1;
+  }
+  if (p->opts.factor_single) {
+    refine_solve(p, p->rhs, b);
+  } else {
+    factor_solve(p, p->rhs, b);
+  }
   return 0;
 }
 
+scs_int scs_solve_lin_sys(ScsLinSysWork *p, scs_float *b, const scs_float *s,
+                          scs_float tol) {
+  SCS(timer) timer;
+  scs_float solve_time;
+  scs_int status;
+
+  SCS(tic)(&timer);
+  status = ldl_solve(p, b);
+  solve_time = SCS(tocq)(&timer);
+  p->solves++;
+  p->solve_time += solve_time;
+  if (p->solve_hook) {
+    p->solve_hook(p->solve_hook_ctx, solve_time);
+  }
+  return status;
+}
+
+void scs_matlab_ldl_set_solve_hook(ScsLinSysWork *p, ScsMatlabLdlSolveHook hook,
+                                   void *ctx) {
+  p->solve_hook = hook;
+  p->solve_hook_ctx = ctx;
+}
+
 /* Update diagonal of R in the KKT matrix and refactorize.
- * Only the diagonal values change — the sparsity pattern is unchanged.
- * Despite this, matlab_ldl_factor recomputes the AMD permutation because
- * MATLAB's ldl() does not accept a pre-computed permutation (see comment
- * in matlab_ldl_factor for alternatives). */
+ * Only the diagonal values change — the sparsity pattern is unchanged, so
+ * this is a numeric refactorization with the ordering and elimination tree
+ * from init (see refactor).
+ *
+ * With opts.refactor_tol > 0, an update that moves every diagonal entry by
+ * at most that much relative to the factored diagonal is absorbed instead:
+ * the factors are kept and the difference is handled by refinement in
+ * scs_solve_lin_sys. */
 scs_int scs_update_lin_sys_diag_r(ScsLinSysWork *p, const scs_float *diag_r) {
   scs_int i;
+  scs_float val, drift = 0.0;
 
   for (i = 0; i < p->n; ++i) {
     /* top left: R_x + P */
-    p->kkt->x[p->diag_r_idxs[i]] = p->diag_p[i] + diag_r[i];
+    val = p->diag_p[i] + diag_r[i];
+    p->kkt->x[p->diag_r_idxs[i]] = val;
+    p->kkt_perm->x[p->kkt_perm_map[p->diag_r_idxs[i]]] = val;
   }
   for (i = p->n; i < p->n + p->m; ++i) {
     /* bottom right: -R_y */
-    p->kkt->x[p->diag_r_idxs[i]] = -diag_r[i];
+    val = -diag_r[i];
+    p->kkt->x[p->diag_r_idxs[i]] = val;
+    p->kkt_perm->x[p->kkt_perm_map[p->diag_r_idxs[i]]] = val;
   }
 
-  if (matlab_ldl_factor(p) < 0) {
-    scs_printf("Error in LDL refactorization.\n");
-    return -1;
+  if (p->opts.refactor_tol > 0) {
+    for (i = 0; i < p->n + p->m; ++i) {
+      val = p->kkt->x[p->diag_r_idxs[i]] - p->diag_fact[i];
+      drift = MAX(drift, ABS(val) / ABS(p->diag_fact[i]));
+    }
+    if (drift <= p->opts.refactor_tol) {
+      p->stale = drift > 0;
+      return 0;
+    }
   }
-  return 0;
+  return refactor(p);
 }
 
 void scs_free_lin_sys_work(ScsLinSysWork *p) {
   if (p) {
-    SCS(cs_spfree)(p->L);
+    free_L(p);
     SCS(cs_spfree)(p->kkt);
     scs_free(p->D_diag);
     scs_free(p->D_sub);
     scs_free(p->perm);
+    scs_free(p->pinv);
     scs_free(p->bp);
+    scs_free(p->bq);
+    scs_free(p->D_inv_diag);
+    scs_free(p->D_inv_sub);
+    scs_free(p->diag_fact);
+    scs_free(p->rhs);
+    scs_free(p->dx);
     scs_free(p->diag_r_idxs);
     scs_free(p->diag_p);
+    free_symbolic(p);
+    free_trisolve(p);
     scs_free(p);
   }
 }
@@ -6,28 +6,85 @@ extern "C" {
 #endif
 
 #include "csparse.h"
+#include "external/qdldl/qdldl.h"
 #include "glbopts.h"
 #include "linsys.h"
+#include "matlab_ldl_kernels.h"
 #include "scs_matrix.h"
 
 #include "mex.h"
 #include "matrix.h"
 
-struct SCS_LIN_SYS_WORK {
-  scs_int m, n;
-  ScsMatrix *kkt;        /* KKT matrix in CSC format (upper triangular) */
-  scs_int *diag_r_idxs;  /* indices of R diagonal entries in kkt->x */
-  scs_float *diag_p;     /* diagonal of P (objective matrix) */
-
-  /* Cached LDL factors from MATLAB's ldl() */
-  ScsMatrix *L;          /* Lower triangular L factor (unit diagonal NOT stored) */
-  scs_float *D_diag;     /* Main diagonal of D, length n+m */
-  scs_float *D_sub;      /* Sub-diagonal of D, length n+m-1 (for 2x2 blocks) */
-  scs_int *perm;         /* Fill-reducing permutation (0-indexed) */
-  scs_float *bp;         /* Workspace for permuted RHS */
-
-  scs_int factorizations;
-};
+/* Backend options, set by the mex layer before scs_init and copied into the
+ * linear system workspace when it is created */
+typedef struct {
+  scs_int threads; /* threads for the triangular solves, 0 = OpenMP default */
+  /* Largest relative change of the KKT diagonal that a scale update may make
+   * without a refactorization; solves then refine with the stale factor.
+   * 0 refactorizes on every update. */
+  scs_float refactor_tol;
+  scs_int refine_steps; /* max refinement steps per solve with stale factor */
+  /* Keep the factor values in float32 (no effect in SFLOAT builds); solves
+   * recover double accuracy by iterative refinement */
+  scs_int factor_single;
+} ScsMatlabLdlOpts;
+
+void scs_matlab_ldl_default_opts(ScsMatlabLdlOpts *opts);
+void scs_matlab_ldl_set_opts(const ScsMatlabLdlOpts *opts);
+/* Offer the linear system workspace *from to the next scs_init. If the new
+ * KKT matrix has the same pattern, that workspace is taken over (*from is
+ * set to NULL) and only refactorized numerically, keeping its ordering,
+ * symbolic analysis and solve schedules. The offer is withdrawn by the next
+ * scs_init either way. */
+void scs_matlab_ldl_reuse_symbolic(ScsLinSysWork **from);
+
+/* A factorization as written to and read from a workspace file. All arrays
+ * are borrowed. L (strictly lower, CSC) and D are optional (Lp is NULL if
+ * only the ordering is kept); kkt_x are the upper-triangular KKT values in
+ * CSC order that they factor. */
+typedef struct {
+  scs_int n_plus_m, kkt_nnz, L_nnz;
+  scs_int L_from_qdldl; /* L has the QDLDL (etree) pattern */
+  const scs_int *perm;
+  const scs_float *kkt_x;
+  const scs_int *Lp, *Li;
+  const scs_float *Lx, *D_diag, *D_sub;
+} ScsMatlabLdlFactor;
+
+/* Describe the current factorization of p (arrays point into p). The
+ * values of L and D are left out when they do not factor the current KKT
+ * matrix (stale) or are not kept in double (opts.factor_single). */
+void scs_matlab_ldl_get_factor(const ScsLinSysWork *p, ScsMatlabLdlFactor *f);
+/* Offer a stored factorization to the next scs_init, which then skips
+ * MATLAB's ldl() and keeps the stored ordering. If the new KKT matrix has
+ * the stored values, L is used in place (its arrays must outlive the
+ * workspace) and D is copied; otherwise the KKT matrix is refactorized
+ * numerically. The offer is withdrawn by the next scs_init either way. */
+void scs_matlab_ldl_preset_factor(const ScsMatlabLdlFactor *f);
+
+/* Size, work done so far and memory of a linear system workspace */
+typedef struct {
+  scs_int kkt_nnz; /* upper triangle of the KKT matrix */
+  scs_int L_nnz;   /* strictly lower triangle of L */
+  scs_int factorizations, ldl_calls, solves, refine_steps;
+  scs_float factor_time, solve_time; /* totals in ms */
+  /* Bytes held: KKT matrix (the full copy for ldl() only lives for the
+   * call); L, D and the ordering (L not counted when borrowed from a
+   * workspace file); symbolic analysis for refactorizations; CSR copy of
+   * L, level schedules and solve vectors */
+  size_t kkt_bytes, factor_bytes, symbolic_bytes, solve_bytes;
+} ScsMatlabLdlStats;
+
+void scs_matlab_ldl_get_stats(const ScsLinSysWork *p, ScsMatlabLdlStats *st);
+
+/* Called after every solve with the KKT matrix, i.e. once per SCS iteration
+ * plus the solves at setup and after scale updates, with the time the solve
+ * took in ms. Lets the mex layer observe the iteration loop. */
+typedef void (*ScsMatlabLdlSolveHook)(void *ctx, scs_float solve_time);
+
+/* Install (or with hook NULL, remove) the solve hook of p */
+void scs_matlab_ldl_set_solve_hook(ScsLinSysWork *p, ScsMatlabLdlSolveHook hook,
+                                   void *ctx);
 
 #ifdef __cplusplus
 }
@@ -0,0 +1,71 @@
+#include "ctrlc.h"
+
+/* Ctrl-C support for the mex files, built in place of scs/src/ctrlc.c.
+ * Every scs_solve polls for an interrupt, and with 'solve_batch' the solves
+ * run on OpenMP threads that must not call into MATLAB. Only the thread
+ * that entered the mex function asks MATLAB; the other threads see an
+ * interrupt through a flag it sets. The flag is cleared by the outermost
+ * listener, so a listener around a parallel loop lets every thread stop. */
+#if CTRLC > 0
+
+#include <stdbool.h>
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+extern bool utIsInterruptPending(void);
+extern bool utSetInterruptEnabled(bool);
+
+static int depth;       /* listeners open on the main thread */
+static bool istate;     /* interrupts enabled before the outermost one */
+static int interrupted; /* seen by the main thread since then */
+
+/* Whether this is the thread MATLAB called the mex function on, i.e.
+ * thread 0 of every enclosing parallel region */
+static int on_main_thread(void) {
+#ifdef _OPENMP
+  int l;
+  for (l = omp_get_level(); l > 0; l--) {
+    if (omp_get_ancestor_thread_num(l) != 0) {
+      return 0;
+    }
+  }
+#endif
+  return 1;
+}
+
+void scs_start_interrupt_listener(void) {
+  if (on_main_thread() && depth++ == 0) {
+    istate = utSetInterruptEnabled(true);
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    interrupted = 0;
+  }
+}
+
+void scs_end_interrupt_listener(void) {
+  if (on_main_thread() && --depth == 0) {
+    utSetInterruptEnabled(istate);
+  }
+}
+
+int scs_is_interrupted(void) {
+  int v;
+  if (on_main_thread() && utIsInterruptPending()) {
+#ifdef _OPENMP
+#pragma omp atomic write
+#endif
+    interrupted = 1;
+  }
+#ifdef _OPENMP
+#pragma omp atomic read
+#endif
+  v = interrupted;
+  return v;
+}
+
+#else
+/* Suppress the empty translation unit warning */
+typedef int scs_mex_no_ctrlc;
+#endif
@@ -1,301 +1,2197 @@
+#if !defined(_WIN32) && !defined(_POSIX_C_SOURCE)
+#define _POSIX_C_SOURCE 200809L /* mmap and friends for workspace files */
+#endif
+
+#include "cones.h"
+#include "ctrlc.h"
 #include "glbopts.h"
 #include "linalg.h"
+#include "linsys.h"
 #include "matrix.h"
 #include "mex.h"
+#include "rw.h"
 #include "scs.h"
 #include "scs_matrix.h"
+#include "scs_work.h"
 #include "util.h"
 
+#include <math.h>
+#include <stdlib.h>
 #include <string.h>
 
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef MATLAB_LDL
+#include "matlab_ldl_linsys.h"
+#endif
+#ifdef SUPERNODAL_LDL
+#include "supernodal_linsys.h"
+#endif
+
+/* The unified build (compiled with MATLAB_LDL and SUPERNODAL_LDL as well)
+ * links every CPU backend and picks the one of each workspace at runtime:
+ * ws_lookup selects the backend of the slot it returns, and USE_MATLAB_LDL
+ * and USE_SUPERNODAL tell which one is selected. The backend-specific
+ * functions take the backend's own workspace, LIN_SYS_WORK(w->p). The
+ * single-backend builds only compile the blocks of their backend. */
+#ifdef UNIFIED_LINSYS
+#if !defined(MATLAB_LDL) || !defined(SUPERNODAL_LDL)
+#error "UNIFIED_LINSYS needs MATLAB_LDL and SUPERNODAL_LDL"
+#endif
+#include "unified_linsys.h"
+#define USE_MATLAB_LDL (scs_unified_selected() == SCS_LIN_SYS_MATLAB_LDL)
+#define USE_SUPERNODAL (scs_unified_selected() == SCS_LIN_SYS_SUPERNODAL)
+#define LIN_SYS_WORK(p) ((ScsLinSysWork *)scs_unified_work(p))
+#else
+#define USE_MATLAB_LDL (1)
+#define USE_SUPERNODAL (1)
+#define LIN_SYS_WORK(p) (p)
+#endif
+
 void free_mex(ScsData *d, ScsCone *k, ScsSettings *stgs);
 
-/* ======================== Workspace state ======================== */
-static ScsWork *ws_work = SCS_NULL;
-static scs_int ws_n = 0;
-static scs_int ws_m = 0;
+/* ======================== Problem copies ======================== */
+/* Deep copies of the problem passed to 'init'. A workspace keeps these so it
+ * can create extra ScsWork instances from the original (unnormalized) data,
+ * e.g. the per-thread workspaces used by 'solve_batch'. */
 
-static void ws_cleanup(void) {
-  if (ws_work) {
-    scs_finish(ws_work);
-    ws_work = SCS_NULL;
-    ws_n = 0;
-    ws_m = 0;
+static ScsMatrix *copy_matrix(const ScsMatrix *src) {
+  ScsMatrix *dst;
+  scs_int nnz;
+  if (!src) {
+    return SCS_NULL;
+  }
+  nnz = src->p[src->n];
+  dst = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+  if (!dst) {
+    return SCS_NULL;
+  }
+  dst->m = src->m;
+  dst->n = src->n;
+  dst->p = (scs_int *)scs_calloc(src->n + 1, sizeof(scs_int));
+  dst->i = (scs_int *)scs_calloc(nnz > 0 ? nnz : 1, sizeof(scs_int));
+  dst->x = (scs_float *)scs_calloc(nnz > 0 ? nnz : 1, sizeof(scs_float));
+  if (!dst->p || !dst->i || !dst->x) {
+    if (dst->p) scs_free(dst->p);
+    if (dst->i) scs_free(dst->i);
+    if (dst->x) scs_free(dst->x);
+    scs_free(dst);
+    return SCS_NULL;
   }
+  memcpy(dst->p, src->p, (src->n + 1) * sizeof(scs_int));
+  memcpy(dst->i, src->i, nnz * sizeof(scs_int));
+  memcpy(dst->x, src->x, nnz * sizeof(scs_float));
+  return dst;
 }
 
-/* ======================== Helper functions ======================== */
+static void free_matrix_copy(ScsMatrix *M) {
+  if (M) {
+    scs_free(M->p);
+    scs_free(M->i);
+    scs_free(M->x);
+    scs_free(M);
+  }
+}
 
-scs_int parse_warm_start(const mxArray *p_mex, scs_float **p, scs_int l) {
-  if (p_mex == SCS_NULL) {
-    *p = (scs_float *)scs_calloc(l, sizeof(scs_float));
-    return 0;
-  } else if (mxIsSparse(p_mex) || (scs_int)mxGetNumberOfElements(p_mex) != l) {
-    *p = (scs_float *)scs_calloc(l, sizeof(scs_float));
-    scs_printf("Error parsing warm start input (make sure vectors are not "
-               "sparse and of correct size), running without full "
-               "warm-start\n");
-    return 0;
-  } else {
-#ifdef SFLOAT
-    *p = cast_to_scs_float_arr(mxGetPr(p_mex), l);
-#else
-    *p = (scs_float *)scs_calloc(l, sizeof(scs_float));
-    if (*p) {
-      memcpy(*p, mxGetPr(p_mex), l * sizeof(scs_float));
-    }
-#endif
-    return (*p != SCS_NULL);
+/* Empty m x n CSC matrix with room for nnz entries, freed with
+ * free_matrix_copy. */
+static ScsMatrix *alloc_matrix(scs_int m, scs_int n, scs_int nnz) {
+  ScsMatrix *M = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+  if (!M) {
+    return SCS_NULL;
   }
+  M->m = m;
+  M->n = n;
+  M->p = (scs_int *)scs_calloc(n + 1, sizeof(scs_int));
+  M->i = (scs_int *)scs_calloc(MAX(nnz, 1), sizeof(scs_int));
+  M->x = (scs_float *)scs_calloc(MAX(nnz, 1), sizeof(scs_float));
+  if (!M->p || !M->i || !M->x) {
+    free_matrix_copy(M);
+    return SCS_NULL;
+  }
+  return M;
 }
 
-#ifndef DLONG
-/* this memory must be freed */
-scs_int *cast_to_scs_int_arr(mwIndex *arr, scs_int len) {
-  scs_int i;
-  scs_int *arr_out = (scs_int *)scs_malloc(sizeof(scs_int) * len);
-  if (!arr_out) return SCS_NULL;
-  for (i = 0; i < len; i++) {
-    arr_out[i] = (scs_int)arr[i];
+static void free_data_copy(ScsData *d) {
+  if (d) {
+    free_matrix_copy(d->A);
+    free_matrix_copy(d->P);
+    if (d->b) scs_free(d->b);
+    if (d->c) scs_free(d->c);
+    scs_free(d);
   }
-  return arr_out;
 }
+
+static ScsData *copy_data(const ScsData *src) {
+  ScsData *d = (ScsData *)scs_calloc(1, sizeof(ScsData));
+  if (!d) {
+    return SCS_NULL;
+  }
+  d->m = src->m;
+  d->n = src->n;
+  d->b = (scs_float *)scs_calloc(src->m, sizeof(scs_float));
+  d->c = (scs_float *)scs_calloc(src->n, sizeof(scs_float));
+  d->A = copy_matrix(src->A);
+  d->P = copy_matrix(src->P);
+  if (!d->b || !d->c || !d->A || (src->P && !d->P)) {
+    free_data_copy(d);
+    return SCS_NULL;
+  }
+  memcpy(d->b, src->b, src->m * sizeof(scs_float));
+  memcpy(d->c, src->c, src->n * sizeof(scs_float));
+  return d;
+}
+
+/* Free with free_mex(NULL, k, NULL). */
+static ScsCone *copy_cone(const ScsCone *src) {
+  ScsCone *k = (ScsCone *)scs_calloc(1, sizeof(ScsCone));
+  scs_int ok = 1;
+  if (!k) {
+    return SCS_NULL;
+  }
+  *k = *src;
+
+#define COPY_CONE_ARR(field, len, type)                                        \
+  k->field = SCS_NULL;                                                         \
+  if (src->field && (len) > 0) {                                               \
+    k->field = (type *)scs_calloc((len), sizeof(type));                        \
+    if (k->field) {                                                            \
+      memcpy(k->field, src->field, (len) * sizeof(type));                      \
+    } else {                                                                   \
+      ok = 0;                                                                  \
+    }                                                                          \
+  }
+
+  COPY_CONE_ARR(q, src->qsize, scs_int);
+  COPY_CONE_ARR(s, src->ssize, scs_int);
+  COPY_CONE_ARR(cs, src->cssize, scs_int);
+  COPY_CONE_ARR(p, src->psize, scs_float);
+  COPY_CONE_ARR(bl, src->bsize - 1, scs_float);
+  COPY_CONE_ARR(bu, src->bsize - 1, scs_float);
+#ifdef USE_SPECTRAL_CONES
+  COPY_CONE_ARR(d, src->dsize, scs_int);
+  COPY_CONE_ARR(nuc_m, src->nucsize, scs_int);
+  COPY_CONE_ARR(nuc_n, src->nucsize, scs_int);
+  COPY_CONE_ARR(ell1, src->ell1_size, scs_int);
+  COPY_CONE_ARR(sl_n, src->sl_size, scs_int);
+  COPY_CONE_ARR(sl_k, src->sl_size, scs_int);
 #endif
 
-#ifdef SFLOAT
-/* this memory must be freed */
-scs_float *cast_to_scs_float_arr(double *arr, scs_int len) {
-  scs_int i;
-  scs_float *arr_out = (scs_float *)scs_malloc(sizeof(scs_float) * len);
-  if (!arr_out) return SCS_NULL;
-  for (i = 0; i < len; i++) {
-    arr_out[i] = (scs_float)arr[i];
+#undef COPY_CONE_ARR
+
+  if (!ok) {
+    free_mex(SCS_NULL, k, SCS_NULL);
+    return SCS_NULL;
   }
-  return arr_out;
+  return k;
 }
 
-double *cast_to_double_arr(scs_float *arr, scs_int len) {
-  scs_int i;
-  double *arr_out = (double *)scs_malloc(sizeof(double) * len);
-  if (!arr_out) return SCS_NULL;
-  for (i = 0; i < len; i++) {
-    arr_out[i] = (double)arr[i];
+/* File outputs are not carried over; free with free_mex(NULL, NULL, stgs). */
+static ScsSettings *copy_settings(const ScsSettings *src) {
+  ScsSettings *stgs = (ScsSettings *)scs_malloc(sizeof(ScsSettings));
+  if (!stgs) {
+    return SCS_NULL;
   }
-  return arr_out;
+  *stgs = *src;
+  stgs->write_data_filename = SCS_NULL;
+  stgs->log_csv_filename = SCS_NULL;
+  return stgs;
 }
-#endif
 
-void set_output_field(mxArray **pout, scs_float *out, scs_int len) {
+/* ======================== Presolve ======================== */
+/* With settings.presolve, simple reductions on the zero and linear cone rows
+ * are applied before the problem reaches SCS, and the solution is mapped
+ * back to the problem as given (postsolve):
+ *  - a zero cone row with one nonzero a_ij fixes x_j = b_i / a_ij, and x_j
+ *    is substituted out of b, c (through P) and the other rows,
+ *  - a zero or linear cone row with no nonzeros left after that is dropped
+ *    if it holds (b_i == 0, resp. b_i >= 0),
+ *  - a zero cone row equal to an earlier one, b_i included, is dropped,
+ *  - a column without nonzeros in A and P and with c_j == 0 is dropped.
+ * A reduction that does not hold (an empty row with b_i != 0, say) is left
+ * to SCS, which then reports the infeasibility. The other cones are passed
+ * through unchanged. The original problem is kept so that 'update' can map
+ * new b and c through the same reductions (presolve_map). */
+
+#define PRESOLVE_KEEP (0)
+#define PRESOLVE_EMPTY (1)  /* row: no nonzeros left, and it holds */
+#define PRESOLVE_DUP (2)    /* row: equal to row twin[i] */
+#define PRESOLVE_FIX (3)    /* row: singleton that fixes its column */
+#define PRESOLVE_FIXED (1)  /* column: fixed by row fix_row[j] */
+#define PRESOLVE_FREE (2)   /* column: empty, x_j = 0 */
+
+/* Relative tolerance on b_i == 0 for a zero cone row emptied by fixing */
+#define PRESOLVE_TOL (1e-12)
+
+typedef struct {
+  scs_int m, n;         /* original sizes */
+  scs_int m_red, n_red; /* sizes passed to SCS */
+  scs_int z, l;         /* original zero and linear cone sizes */
+  ScsMatrix *A, *P;     /* original A and upper triangular P */
+  scs_float *b, *c;     /* original b and c, following 'update' */
+  scs_int *row_kind, *row_map; /* row_map: reduced row, -1 if removed */
+  scs_int *col_kind, *col_map;
+  scs_int *twin;        /* of PRESOLVE_DUP rows */
+  scs_int *fix_row;     /* of PRESOLVE_FIXED columns */
+  scs_float *fix_coef;  /* a_ij of fix_row[j] */
+  scs_float *v;         /* values of the fixed columns, 0 elsewhere */
+  scs_float *r;         /* b - A v */
+  scs_float *q;         /* length n work vector */
+  scs_int empty_rows, duplicate_rows, fixed_vars, empty_cols;
+  scs_float time; /* ms */
+} ScsMexPresolve;
+
+typedef struct {
+  uint64_T h;
   scs_int i;
-  *pout = mxCreateDoubleMatrix(len, 1, mxREAL);
-  if (out != SCS_NULL) {
-#ifdef SFLOAT
-    double *pr = mxGetPr(*pout);
-    for (i = 0; i < len; i++) {
-      pr[i] = (double)out[i];
-    }
-#else
-    memcpy(mxGetPr(*pout), out, len * sizeof(scs_float));
-#endif
-    scs_free(out);
+} ScsMexRowHash;
+
+/* 64-bit multiply-xorshift hash of len bytes, continuing from h */
+static uint64_T hash_bytes(uint64_T h, const void *buf, size_t len) {
+  const unsigned char *p = (const unsigned char *)buf;
+  uint64_T w;
+  for (; len >= sizeof(uint64_T);
+       p += sizeof(uint64_T), len -= sizeof(uint64_T)) {
+    memcpy(&w, p, sizeof(uint64_T));
+    h = (h ^ w) * 0x100000001b3ULL;
+    h ^= h >> 29;
+  }
+  for (; len > 0; p++, len--) {
+    h = (h ^ *p) * 0x100000001b3ULL;
   }
+  return h;
 }
 
-/* Get length of a MATLAB array (handles row and column vectors) */
-static scs_int get_mex_length(const mxArray *arr) {
-  scs_int ndim = (scs_int)mxGetNumberOfDimensions(arr);
-  const size_t *dims = mxGetDimensions(arr);
-  scs_int len = (scs_int)dims[0];
-  if (ndim > 1 && dims[0] == 1) {
-    len = (scs_int)dims[1];
+static int cmp_row_hash(const void *a, const void *b) {
+  const ScsMexRowHash *x = (const ScsMexRowHash *)a;
+  const ScsMexRowHash *y = (const ScsMexRowHash *)b;
+  if (x->h != y->h) {
+    return x->h < y->h ? -1 : 1;
   }
-  return len;
+  return (x->i > y->i) - (x->i < y->i);
 }
 
-/* Parse data struct (A, P, b, c) into ScsData.
- * Caller must free d, d->A, d->P (if non-NULL) via free_mex(d, NULL, NULL). */
-static scs_int parse_data(const mxArray *data_mex, ScsData **d_out) {
-  ScsData *d;
-  ScsMatrix *A;
-  ScsMatrix *P = SCS_NULL;
-  const mxArray *A_mex, *P_mex, *b_mex, *c_mex;
+/* The presolve setting, off if not set. */
+static scs_int parse_presolve(const mxArray *settings_mex) {
+  mxArray *tmp = mxGetField(settings_mex, 0, "presolve");
+  return tmp != SCS_NULL && !mxIsEmpty(tmp) && mxGetScalar(tmp) != 0;
+}
 
-  d = (ScsData *)scs_calloc(1, sizeof(ScsData));
-  if (!d) {
-    return -1;
+static void presolve_free(ScsMexPresolve *pre) {
+  if (!pre) {
+    return;
   }
+  free_matrix_copy(pre->A);
+  free_matrix_copy(pre->P);
+  scs_free(pre->b);
+  scs_free(pre->c);
+  scs_free(pre->row_kind);
+  scs_free(pre->row_map);
+  scs_free(pre->col_kind);
+  scs_free(pre->col_map);
+  scs_free(pre->twin);
+  scs_free(pre->fix_row);
+  scs_free(pre->fix_coef);
+  scs_free(pre->v);
+  scs_free(pre->r);
+  scs_free(pre->q);
+  scs_free(pre);
+}
 
-  A_mex = (mxArray *)mxGetField(data_mex, 0, "A");
-  if (A_mex == SCS_NULL) {
-    scs_free(d);
-    scs_printf("ScsData struct must contain a `A` entry.\n");
-    return -1;
+/* v and r = b - A v for the right-hand side b. */
+static void presolve_residual(ScsMexPresolve *pre, const scs_float *b) {
+  const ScsMatrix *A = pre->A;
+  scs_int j, p;
+  memcpy(pre->r, b, pre->m * sizeof(scs_float));
+  for (j = 0; j < pre->n; j++) {
+    pre->v[j] = 0.0;
+    if (pre->col_kind[j] != PRESOLVE_FIXED) {
+      continue;
+    }
+    pre->v[j] = b[pre->fix_row[j]] / pre->fix_coef[j];
+    for (p = A->p[j]; p < A->p[j + 1]; p++) {
+      pre->r[A->i[p]] -= A->x[p] * pre->v[j];
+    }
   }
-  if (!mxIsSparse(A_mex)) {
-    scs_free(d);
-    scs_printf("Input matrix A must be in sparse format (pass in sparse(A))\n");
-    return -1;
+}
+
+/* Does row i, with no nonzeros left after fixing, hold? */
+static scs_int presolve_row_holds(const ScsMexPresolve *pre,
+                                  const scs_float *b, scs_int i) {
+  scs_float tol = PRESOLVE_TOL * (1.0 + ABS(b[i]));
+  return i < pre->z ? ABS(pre->r[i]) <= tol : pre->r[i] >= -tol;
+}
+
+/* q = P x with the full symmetric P from its upper triangle. */
+static void presolve_P_times(const ScsMexPresolve *pre, const scs_float *x,
+                             scs_float *q) {
+  const ScsMatrix *P = pre->P;
+  scs_int i, j, p;
+  memset(q, 0, pre->n * sizeof(scs_float));
+  if (!P) {
+    return;
   }
-  P_mex = (mxArray *)mxGetField(data_mex, 0, "P"); /* can be SCS_NULL */
-  if (P_mex && !mxIsSparse(P_mex)) {
-    scs_free(d);
-    scs_printf("Input matrix P must be in sparse format (pass in sparse(P))\n");
-    return -1;
+  for (j = 0; j < P->n; j++) {
+    for (p = P->p[j]; p < P->p[j + 1]; p++) {
+      i = P->i[p];
+      q[i] += P->x[p] * x[j];
+      if (i != j) {
+        q[j] += P->x[p] * x[i];
+      }
+    }
   }
-  b_mex = (mxArray *)mxGetField(data_mex, 0, "b");
-  if (b_mex == SCS_NULL) {
-    scs_free(d);
-    scs_printf("ScsData struct must contain a `b` entry.\n");
-    return -1;
+}
+
+/* Map b and c (NULL = unchanged) through the reductions into the b and c of
+ * the reduced problem dr, and keep them as the original b and c. Fails,
+ * leaving everything as it was, if they break a reduction. */
+static const char *presolve_map(ScsMexPresolve *pre, const scs_float *b,
+                                const scs_float *c, ScsData *dr) {
+  scs_int i, j;
+  b = b ? b : pre->b;
+  c = c ? c : pre->c;
+  presolve_residual(pre, b);
+  for (i = 0; i < pre->m; i++) {
+    if ((pre->row_kind[i] == PRESOLVE_EMPTY &&
+         !presolve_row_holds(pre, b, i)) ||
+        (pre->row_kind[i] == PRESOLVE_DUP && b[i] != b[pre->twin[i]])) {
+      presolve_residual(pre, pre->b);
+      return "b_new breaks a presolve reduction (a removed row no longer "
+             "holds); call scs_init again.";
+    }
   }
-  if (mxIsSparse(b_mex)) {
-    scs_free(d);
-    scs_printf("Input vector b must be in dense format (pass in full(b))\n");
-    return -1;
+  for (j = 0; j < pre->n; j++) {
+    if (pre->col_kind[j] == PRESOLVE_FREE && c[j] != 0) {
+      presolve_residual(pre, pre->b);
+      return "c_new breaks a presolve reduction (c is nonzero on a removed "
+             "empty column); call scs_init again.";
+    }
   }
-  c_mex = (mxArray *)mxGetField(data_mex, 0, "c");
-  if (c_mex == SCS_NULL) {
-    scs_free(d);
-    scs_printf("ScsData struct must contain a `c` entry.\n");
-    return -1;
+  if (b != pre->b) {
+    memcpy(pre->b, b, pre->m * sizeof(scs_float));
   }
-  if (mxIsSparse(c_mex)) {
-    scs_free(d);
-    scs_printf("Input vector c must be in dense format (pass in full(c))\n");
-    return -1;
+  if (c != pre->c) {
+    memcpy(pre->c, c, pre->n * sizeof(scs_float));
+  }
+  for (i = 0; i < pre->m; i++) {
+    if (pre->row_map[i] >= 0) {
+      dr->b[pre->row_map[i]] = pre->r[i];
+    }
+  }
+  /* the fixed part of x'Px / 2 adds P_{:,F} v to c */
+  presolve_P_times(pre, pre->v, pre->q);
+  for (j = 0; j < pre->n; j++) {
+    if (pre->col_map[j] >= 0) {
+      dr->c[pre->col_map[j]] = pre->c[j] + pre->q[j];
+    }
   }
+  return SCS_NULL;
+}
 
-  d->n = (scs_int) * (mxGetDimensions(c_mex));
-  d->m = (scs_int) * (mxGetDimensions(b_mex));
-#ifdef SFLOAT
-  d->b = cast_to_scs_float_arr(mxGetPr(b_mex), d->m);
-  d->c = cast_to_scs_float_arr(mxGetPr(c_mex), d->n);
-  if (!d->b || !d->c) {
-    free_mex(d, SCS_NULL, SCS_NULL);
-    scs_printf("Memory allocation failed for vectors b or c.\n");
-    return -1;
+/* Find the reductions of d, k and build the reduced problem in *d_out (free
+ * with free_data_copy) and *k_out (free_mex(NULL, k, NULL)). Returns
+ * SCS_NULL if out of memory. */
+static ScsMexPresolve *presolve_new(const ScsData *d, const ScsCone *k,
+                                    ScsData **d_out, ScsCone **k_out) {
+  const ScsMatrix *A = d->A, *P = d->P;
+  scs_int m = d->m, n = d->n, rows = k->z + k->l;
+  scs_int *rp = SCS_NULL, *rj = SCS_NULL;
+  scs_float *rx = SCS_NULL;
+  ScsMexRowHash *hs = SCS_NULL;
+  ScsMexPresolve *pre;
+  ScsData *dr = SCS_NULL;
+  ScsCone *kr = SCS_NULL;
+  scs_int i, j, p, t, u, len, nnz, n_hs = 0, ok;
+  SCS(timer) timer;
+
+  SCS(tic)(&timer);
+  *d_out = SCS_NULL;
+  *k_out = SCS_NULL;
+  pre = (ScsMexPresolve *)scs_calloc(1, sizeof(ScsMexPresolve));
+  if (!pre) {
+    return SCS_NULL;
   }
-#else
-  d->b = (scs_float *)mxGetPr(b_mex);
-  d->c = (scs_float *)mxGetPr(c_mex);
-#endif
+  pre->m = m;
+  pre->n = n;
+  pre->z = k->z;
+  pre->l = k->l;
+  pre->A = copy_matrix(A);
+  pre->P = copy_matrix(P);
+  pre->b = (scs_float *)scs_calloc(MAX(m, 1), sizeof(scs_float));
+  pre->c = (scs_float *)scs_calloc(MAX(n, 1), sizeof(scs_float));
+  pre->row_kind = (scs_int *)scs_calloc(MAX(m, 1), sizeof(scs_int));
+  pre->row_map = (scs_int *)scs_calloc(MAX(m, 1), sizeof(scs_int));
+  pre->twin = (scs_int *)scs_calloc(MAX(m, 1), sizeof(scs_int));
+  pre->r = (scs_float *)scs_calloc(MAX(m, 1), sizeof(scs_float));
+  pre->col_kind = (scs_int *)scs_calloc(MAX(n, 1), sizeof(scs_int));
+  pre->col_map = (scs_int *)scs_calloc(MAX(n, 1), sizeof(scs_int));
+  pre->fix_row = (scs_int *)scs_calloc(MAX(n, 1), sizeof(scs_int));
+  pre->fix_coef = (scs_float *)scs_calloc(MAX(n, 1), sizeof(scs_float));
+  pre->v = (scs_float *)scs_calloc(MAX(n, 1), sizeof(scs_float));
+  pre->q = (scs_float *)scs_calloc(MAX(n, 1), sizeof(scs_float));
+  rp = (scs_int *)scs_calloc(rows + 1, sizeof(scs_int));
+  hs = (ScsMexRowHash *)scs_calloc(MAX(k->z, 1), sizeof(ScsMexRowHash));
+  ok = pre->A && (!P || pre->P) && pre->b && pre->c && pre->row_kind &&
+       pre->row_map && pre->twin && pre->r && pre->col_kind &&
+       pre->col_map && pre->fix_row && pre->fix_coef && pre->v && pre->q &&
+       rp && hs;
+  if (!ok) {
+    goto fail;
+  }
+  memcpy(pre->b, d->b, m * sizeof(scs_float));
+  memcpy(pre->c, d->c, n * sizeof(scs_float));
 
-  A = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
-  if (!A) {
-    free_mex(d, SCS_NULL, SCS_NULL);
-    return -1;
+  /* Rows of the zero and linear cones by their nonzeros, columns sorted;
+   * col_map marks the columns with a nonzero in A or P for now */
+  for (j = 0; j < n; j++) {
+    for (p = A->p[j]; p < A->p[j + 1]; p++) {
+      if (A->x[p] == 0) {
+        continue;
+      }
+      pre->col_map[j] = 1;
+      if (A->i[p] < rows) {
+        rp[A->i[p] + 1]++;
+      }
+    }
+  }
+  for (i = 0; i < rows; i++) {
+    rp[i + 1] += rp[i];
+  }
+  nnz = rp[rows];
+  rj = (scs_int *)scs_calloc(MAX(nnz, 1), sizeof(scs_int));
+  rx = (scs_float *)scs_calloc(MAX(nnz, 1), sizeof(scs_float));
+  if (!rj || !rx) {
+    goto fail;
+  }
+  memcpy(pre->row_map, rp, rows * sizeof(scs_int)); /* fill cursors */
+  for (j = 0; j < n; j++) {
+    for (p = A->p[j]; p < A->p[j + 1]; p++) {
+      if (A->x[p] != 0 && A->i[p] < rows) {
+        t = pre->row_map[A->i[p]]++;
+        rj[t] = j;
+        rx[t] = A->x[p];
+      }
+    }
+  }
+  if (P) {
+    for (j = 0; j < n; j++) {
+      for (p = P->p[j]; p < P->p[j + 1]; p++) {
+        if (P->x[p] != 0) {
+          pre->col_map[j] = 1;
+          pre->col_map[P->i[p]] = 1;
+        }
+      }
+    }
   }
-  A->n = d->n;
-  A->m = d->m;
-  d->A = A;
 
-  if (P_mex) {
-    P = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
-    if (!P) {
-      free_mex(d, SCS_NULL, SCS_NULL);
-      return -1;
+  /* singleton zero cone rows fix their column, the first one wins */
+  for (i = 0; i < k->z; i++) {
+    if (rp[i + 1] - rp[i] == 1 &&
+        pre->col_kind[rj[rp[i]]] == PRESOLVE_KEEP) {
+      j = rj[rp[i]];
+      pre->col_kind[j] = PRESOLVE_FIXED;
+      pre->fix_row[j] = i;
+      pre->fix_coef[j] = rx[rp[i]];
+      pre->row_kind[i] = PRESOLVE_FIX;
+      pre->fixed_vars++;
     }
-    P->n = d->n;
-    P->m = d->n;
-    d->P = P;
   }
+  presolve_residual(pre, pre->b);
 
-#ifdef DLONG
-  A->p = (scs_int *)mxGetJc(A_mex);
-  A->i = (scs_int *)mxGetIr(A_mex);
-  if (P_mex) {
-    P->p = (scs_int *)mxGetJc(P_mex);
-    P->i = (scs_int *)mxGetIr(P_mex);
+  /* rows left without nonzeros */
+  for (i = 0; i < rows; i++) {
+    if (pre->row_kind[i] != PRESOLVE_KEEP) {
+      continue;
+    }
+    for (p = rp[i]; p < rp[i + 1]; p++) {
+      if (pre->col_kind[rj[p]] != PRESOLVE_FIXED) {
+        break;
+      }
+    }
+    if (p == rp[i + 1] && presolve_row_holds(pre, pre->b, i)) {
+      pre->row_kind[i] = PRESOLVE_EMPTY;
+      pre->empty_rows++;
+    }
   }
-#else
-  A->p = cast_to_scs_int_arr(mxGetJc(A_mex), A->n + 1);
-  if (!A->p) {
-    free_mex(d, SCS_NULL, SCS_NULL);
-    scs_printf("Memory allocation failed for A->p.\n");
-    return -1;
+
+  /* duplicate zero cone rows: equal hashes first, then a full compare
+   * against the rows kept so far in the run */
+  for (i = 0; i < k->z; i++) {
+    len = rp[i + 1] - rp[i];
+    if (pre->row_kind[i] == PRESOLVE_KEEP && len > 0) {
+      hs[n_hs].h = hash_bytes((uint64_T)len, &rj[rp[i]],
+                              len * sizeof(scs_int));
+      hs[n_hs].h = hash_bytes(hs[n_hs].h, &rx[rp[i]],
+                              len * sizeof(scs_float));
+      hs[n_hs].i = i;
+      n_hs++;
+    }
   }
-  A->i = cast_to_scs_int_arr(mxGetIr(A_mex), A->p[A->n]);
-  if (!A->i) {
-    free_mex(d, SCS_NULL, SCS_NULL);
-    scs_printf("Memory allocation failed for A->i.\n");
-    return -1;
+  qsort(hs, n_hs, sizeof(ScsMexRowHash), cmp_row_hash);
+  for (t = 0; t < n_hs; t++) {
+    i = hs[t].i;
+    len = rp[i + 1] - rp[i];
+    for (u = t - 1; u >= 0 && hs[u].h == hs[t].h; u--) {
+      j = hs[u].i;
+      if (pre->row_kind[j] == PRESOLVE_KEEP && rp[j + 1] - rp[j] == len &&
+          pre->b[j] == pre->b[i] &&
+          memcmp(&rj[rp[j]], &rj[rp[i]], len * sizeof(scs_int)) == 0 &&
+          memcmp(&rx[rp[j]], &rx[rp[i]], len * sizeof(scs_float)) == 0) {
+        pre->row_kind[i] = PRESOLVE_DUP;
+        pre->twin[i] = j;
+        pre->duplicate_rows++;
+        break;
+      }
+    }
   }
-  if (P_mex) {
-    P->p = cast_to_scs_int_arr(mxGetJc(P_mex), P->n + 1);
-    if (!P->p) {
-      free_mex(d, SCS_NULL, SCS_NULL);
-      scs_printf("Memory allocation failed for P->p.\n");
-      return -1;
+
+  /* empty columns */
+  for (j = 0; j < n; j++) {
+    if (pre->col_kind[j] == PRESOLVE_KEEP && !pre->col_map[j] &&
+        pre->c[j] == 0) {
+      pre->col_kind[j] = PRESOLVE_FREE;
+      pre->empty_cols++;
     }
-    P->i = cast_to_scs_int_arr(mxGetIr(P_mex), P->p[P->n]);
-    if (!P->i) {
-      free_mex(d, SCS_NULL, SCS_NULL);
-      scs_printf("Memory allocation failed for P->i.\n");
-      return -1;
+  }
+
+  /* reduced problem */
+  kr = copy_cone(k);
+  dr = (ScsData *)scs_calloc(1, sizeof(ScsData));
+  if (!kr || !dr) {
+    goto fail;
+  }
+  kr->z = 0;
+  kr->l = 0;
+  for (i = 0; i < m; i++) {
+    pre->row_map[i] = -1;
+    if (pre->row_kind[i] == PRESOLVE_KEEP) {
+      pre->row_map[i] = pre->m_red++;
+      kr->z += i < k->z;
+      kr->l += i >= k->z && i < rows;
     }
   }
-#endif
-#ifdef SFLOAT
-  A->x = cast_to_scs_float_arr(mxGetPr(A_mex), A->p[A->n]);
-  if (!A->x) {
-    free_mex(d, SCS_NULL, SCS_NULL);
-    scs_printf("Memory allocation failed for A->x.\n");
-    return -1;
+  for (j = 0; j < n; j++) {
+    pre->col_map[j] = pre->col_kind[j] == PRESOLVE_KEEP ? pre->n_red++ : -1;
   }
-  if (P_mex) {
-    P->x = cast_to_scs_float_arr(mxGetPr(P_mex), P->p[P->n]);
-    if (!P->x) {
-      free_mex(d, SCS_NULL, SCS_NULL);
-      scs_printf("Memory allocation failed for P->x.\n");
-      return -1;
+  dr->m = pre->m_red;
+  dr->n = pre->n_red;
+  dr->b = (scs_float *)scs_calloc(MAX(dr->m, 1), sizeof(scs_float));
+  dr->c = (scs_float *)scs_calloc(MAX(dr->n, 1), sizeof(scs_float));
+  nnz = 0;
+  for (j = 0; j < n; j++) {
+    for (p = A->p[j]; pre->col_map[j] >= 0 && p < A->p[j + 1]; p++) {
+      nnz += pre->row_map[A->i[p]] >= 0;
     }
   }
-#else
-  A->x = (scs_float *)mxGetPr(A_mex);
-  if (P_mex) {
-    P->x = (scs_float *)mxGetPr(P_mex);
+  dr->A = alloc_matrix(dr->m, dr->n, nnz);
+  if (P) {
+    nnz = 0;
+    for (j = 0; j < n; j++) {
+      for (p = P->p[j]; pre->col_map[j] >= 0 && p < P->p[j + 1]; p++) {
+        nnz += pre->col_map[P->i[p]] >= 0;
+      }
+    }
+    dr->P = alloc_matrix(dr->n, dr->n, nnz);
   }
-#endif
+  if (!dr->b || !dr->c || !dr->A || (P && !dr->P)) {
+    goto fail;
+  }
+  for (j = 0, t = 0; j < n; j++) {
+    if (pre->col_map[j] < 0) {
+      continue;
+    }
+    for (p = A->p[j]; p < A->p[j + 1]; p++) {
+      if (pre->row_map[A->i[p]] >= 0) {
+        dr->A->i[t] = pre->row_map[A->i[p]];
+        dr->A->x[t++] = A->x[p];
+      }
+    }
+    dr->A->p[pre->col_map[j] + 1] = t;
+  }
+  if (P) {
+    for (j = 0, t = 0; j < n; j++) {
+      if (pre->col_map[j] < 0) {
+        continue;
+      }
+      for (p = P->p[j]; p < P->p[j + 1]; p++) {
+        if (pre->col_map[P->i[p]] >= 0) {
+          dr->P->i[t] = pre->col_map[P->i[p]];
+          dr->P->x[t++] = P->x[p];
+        }
+      }
+      dr->P->p[pre->col_map[j] + 1] = t;
+    }
+  }
+  presolve_map(pre, SCS_NULL, SCS_NULL, dr);
 
-  *d_out = d;
-  return 0;
+  scs_free(rp);
+  scs_free(rj);
+  scs_free(rx);
+  scs_free(hs);
+  pre->time = SCS(tocq)(&timer);
+  *d_out = dr;
+  *k_out = kr;
+  return pre;
+
+fail:
+  scs_free(rp);
+  scs_free(rj);
+  scs_free(rx);
+  scs_free(hs);
+  free_data_copy(dr);
+  free_mex(SCS_NULL, kr, SCS_NULL);
+  presolve_free(pre);
+  return SCS_NULL;
 }
 
-/* Parse settings struct into ScsSettings.
- * Caller must free via free_mex(NULL, NULL, stgs). */
-static scs_int parse_settings(const mxArray *settings_mex,
-                              ScsSettings **stgs_out) {
-  ScsSettings *stgs;
-  mxArray *tmp;
+/* Solver-size solution buffers for a presolved solve; -1 if out of memory.
+ * Free with presolve_free_sol. */
+static scs_int presolve_alloc_sol(const ScsMexPresolve *pre,
+                                  ScsSolution *red) {
+  red->x = (scs_float *)scs_calloc(MAX(pre->n_red, 1), sizeof(scs_float));
+  red->y = (scs_float *)scs_calloc(MAX(pre->m_red, 1), sizeof(scs_float));
+  red->s = (scs_float *)scs_calloc(MAX(pre->m_red, 1), sizeof(scs_float));
+  return red->x && red->y && red->s ? 0 : -1;
+}
 
-  stgs = (ScsSettings *)scs_malloc(sizeof(ScsSettings));
-  if (!stgs) {
-    return -1;
-  }
-  scs_set_default_settings(stgs);
+static void presolve_free_sol(ScsSolution *red) {
+  scs_free(red->x);
+  scs_free(red->y);
+  scs_free(red->s);
+}
 
-#define GET_SETTING_FLOAT(field)                                               \
-  tmp = mxGetField(settings_mex, 0, #field);                                   \
-  if (tmp != SCS_NULL && !mxIsEmpty(tmp))                                      \
-  stgs->field = (scs_float)*mxGetPr(tmp)
+/* Warm start of the reduced problem from one of the original. */
+static void presolve_warm(const ScsMexPresolve *pre, const ScsSolution *sol,
+                          ScsSolution *red) {
+  scs_int i, j;
+  for (j = 0; j < pre->n; j++) {
+    if (pre->col_map[j] >= 0) {
+      red->x[pre->col_map[j]] = sol->x[j];
+    }
+  }
+  for (i = 0; i < pre->m; i++) {
+    if (pre->row_map[i] >= 0) {
+      red->y[pre->row_map[i]] = sol->y[i];
+      red->s[pre->row_map[i]] = sol->s[i];
+    }
+  }
+}
 
-#define GET_SETTING_INT(field)                                                 \
-  tmp = mxGetField(settings_mex, 0, #field);                                   \
-  if (tmp != SCS_NULL && !mxIsEmpty(tmp))                                      \
-  stgs->field = (scs_int)*mxGetPr(tmp)
+/* Solution sol of the original problem from red of the reduced one. The
+ * duals of the fixing rows come from the dual residual Px + A'y + c = 0 of
+ * their column. Infeasibility and unboundedness certificates are mapped
+ * without the b, c and P terms. pobj, dobj and gap are recomputed for the
+ * original problem; the residuals are those of the reduced one. */
+static void postsolve(ScsMexPresolve *pre, const ScsSolution *red,
+                      ScsSolution *sol, ScsInfo *info) {
+  const ScsMatrix *A = pre->A;
+  scs_int infeas = info->status_val == SCS_INFEASIBLE ||
+                   info->status_val == SCS_INFEASIBLE_INACCURATE;
+  scs_int unbdd = info->status_val == SCS_UNBOUNDED ||
+                  info->status_val == SCS_UNBOUNDED_INACCURATE;
+  scs_float g, xPx = 0.0, cx = 0.0, by = 0.0;
+  scs_float nan = (scs_float)mxGetNaN();
+  scs_int i, j, p;
 
-  GET_SETTING_FLOAT(alpha);
-  GET_SETTING_FLOAT(rho_x);
-  GET_SETTING_INT(max_iters);
-  GET_SETTING_FLOAT(scale);
-  GET_SETTING_FLOAT(eps_abs);
-  GET_SETTING_FLOAT(eps_rel);
-  GET_SETTING_FLOAT(eps_infeas);
-  GET_SETTING_INT(verbose);
-  GET_SETTING_INT(normalize);
-  GET_SETTING_INT(acceleration_lookback);
-  GET_SETTING_INT(acceleration_interval);
-  GET_SETTING_INT(adaptive_scale);
+  for (j = 0; j < pre->n; j++) {
+    if (pre->col_map[j] >= 0) {
+      sol->x[j] = red->x[pre->col_map[j]];
+    } else {
+      sol->x[j] = pre->col_kind[j] == PRESOLVE_FIXED && !infeas && !unbdd
+                      ? pre->v[j]
+                      : 0.0;
+    }
+  }
+  for (i = 0; i < pre->m; i++) {
+    if (pre->row_map[i] >= 0) {
+      sol->y[i] = red->y[pre->row_map[i]];
+      sol->s[i] = red->s[pre->row_map[i]];
+    } else {
+      sol->y[i] = 0.0;
+      sol->s[i] = pre->row_kind[i] == PRESOLVE_EMPTY && i >= pre->z &&
+                          !infeas && !unbdd
+                      ? MAX(pre->r[i], 0.0)
+                      : 0.0;
+    }
+  }
+  if (!infeas && !unbdd) {
+    presolve_P_times(pre, sol->x, pre->q);
+  }
+  for (j = 0; j < pre->n; j++) {
+    if (pre->col_kind[j] != PRESOLVE_FIXED) {
+      continue;
+    }
+    g = infeas || unbdd ? 0.0 : pre->c[j] + pre->q[j];
+    for (p = A->p[j]; p < A->p[j + 1]; p++) {
+      if (A->i[p] != pre->fix_row[j]) {
+        g += A->x[p] * sol->y[A->i[p]];
+      }
+    }
+    sol->y[pre->fix_row[j]] = -g / pre->fix_coef[j];
+  }
+  if (infeas) {
+    for (j = 0; j < pre->n; j++) {
+      sol->x[j] = nan;
+    }
+    for (i = 0; i < pre->m; i++) {
+      sol->s[i] = nan;
+    }
+  } else if (unbdd) {
+    for (i = 0; i < pre->m; i++) {
+      sol->y[i] = nan;
+    }
+  } else {
+    for (j = 0; j < pre->n; j++) {
+      xPx += sol->x[j] * pre->q[j];
+      cx += pre->c[j] * sol->x[j];
+    }
+    for (i = 0; i < pre->m; i++) {
+      by += pre->b[i] * sol->y[i];
+    }
+    info->pobj = cx + 0.5 * xPx;
+    info->dobj = -by - 0.5 * xPx;
+    info->gap = ABS(info->pobj - info->dobj);
+  }
+}
+
+/* info.presolve: the reductions and the sizes before and after. */
+static void presolve_add_info(mxArray *info_mex, const ScsMexPresolve *pre) {
+  const char *fields[] = {"m",          "n",          "m_reduced",
+                          "n_reduced",  "empty_rows", "duplicate_rows",
+                          "fixed_vars", "empty_cols", "time"};
+  mxArray *out = mxCreateStructMatrix(1, 1, 9, fields);
+
+  mxSetField(out, 0, "m", mxCreateDoubleScalar((double)pre->m));
+  mxSetField(out, 0, "n", mxCreateDoubleScalar((double)pre->n));
+  mxSetField(out, 0, "m_reduced", mxCreateDoubleScalar((double)pre->m_red));
+  mxSetField(out, 0, "n_reduced", mxCreateDoubleScalar((double)pre->n_red));
+  mxSetField(out, 0, "empty_rows",
+             mxCreateDoubleScalar((double)pre->empty_rows));
+  mxSetField(out, 0, "duplicate_rows",
+             mxCreateDoubleScalar((double)pre->duplicate_rows));
+  mxSetField(out, 0, "fixed_vars",
+             mxCreateDoubleScalar((double)pre->fixed_vars));
+  mxSetField(out, 0, "empty_cols",
+             mxCreateDoubleScalar((double)pre->empty_cols));
+  mxSetField(out, 0, "time", mxCreateDoubleScalar((double)pre->time));
+  mxAddField(info_mex, "presolve");
+  mxSetField(info_mex, 0, "presolve", out);
+}
+
+/* ======================== Workspace registry ======================== */
+/* Each 'init' registers its ScsWork under a fresh handle, so any number of
+ * factorized workspaces can stay resident at once. Handles are never reused
+ * within a MATLAB session, so a handle kept after 'finish' is rejected rather
+ * than silently resolving to some other workspace. */
+typedef struct {
+  uint64_T handle; /* 0 marks a free slot */
+  ScsWork *work;
+  scs_int n, m;
+  /* Problem as passed to 'init'; b and c follow 'update'. */
+  ScsData *d;
+  ScsCone *k;
+  ScsSettings *stgs;
+  scs_int trace_iters; /* iterations kept in info.trace, 0 = off */
+  scs_int single_out;  /* 'solve' returns single x, y, s (single b) */
+  /* With settings.presolve: d, k, n and m are the reduced problem */
+  ScsMexPresolve *pre;
+  /* Lazily created workspaces for the threads of 'solve_batch' beyond the
+   * first, which uses work. */
+  ScsWork **clones;
+  scs_int n_clones;
+#ifdef MATLAB_LDL
+  ScsMatlabLdlOpts ldl_opts;
+  /* Factorization from a workspace file ('load'), pointing into file_map */
+  ScsMatlabLdlFactor ldl_factor;
+  scs_int has_ldl_factor;
+#endif
+#ifdef UNIFIED_LINSYS
+  scs_int lin_sys; /* backend, SCS_LIN_SYS_* */
+#endif
+  /* Mapped workspace file, kept while the factor may borrow from it */
+  void *file_map;
+  size_t file_len;
+} ScsMexWorkspace;
+
+static void file_unmap(void *buf, size_t len);
+
+static ScsMexWorkspace *ws_table = SCS_NULL;
+static scs_int ws_table_len = 0;
+static uint64_T ws_next_handle = 1;
+
+static void ws_free_clones(ScsMexWorkspace *slot) {
+  scs_int i;
+  if (slot->clones) {
+    for (i = 0; i < slot->n_clones; i++) {
+      if (slot->clones[i]) {
+        scs_finish(slot->clones[i]);
+      }
+    }
+    scs_free(slot->clones);
+  }
+  slot->clones = SCS_NULL;
+  slot->n_clones = 0;
+}
+
+static void ws_release(ScsMexWorkspace *slot) {
+  ws_free_clones(slot);
+  if (slot->work) {
+    scs_finish(slot->work);
+  }
+  free_data_copy(slot->d);
+  free_mex(SCS_NULL, slot->k, slot->stgs);
+  presolve_free(slot->pre);
+  if (slot->file_map) {
+    file_unmap(slot->file_map, slot->file_len);
+  }
+  memset(slot, 0, sizeof(ScsMexWorkspace));
+}
+
+/* Make sure slot has at least n workspaces for the extra threads of
+ * batched solves. Each is an independent ScsWork (own iterates, AA state
+ * and linear system workspace, whose factor every scale update changes)
+ * built from the retained problem copy. Backends that call back into
+ * MATLAB run batches on one thread and never get here. */
+static scs_int ws_ensure_clones(ScsMexWorkspace *slot, scs_int n) {
+  ScsWork **clones;
+  ScsSettings *stgs;
+  scs_int i;
+  if (slot->n_clones >= n) {
+    return 0;
+  }
+  clones = (ScsWork **)scs_calloc(n, sizeof(ScsWork *));
+  if (!clones) {
+    return -1;
+  }
+  if (slot->clones) {
+    memcpy(clones, slot->clones, slot->n_clones * sizeof(ScsWork *));
+    scs_free(slot->clones);
+  }
+  slot->clones = clones;
+  stgs = copy_settings(slot->stgs);
+  if (!stgs) {
+    return -1;
+  }
+  stgs->verbose = 0; /* printing is not thread safe */
+  for (i = slot->n_clones; i < n; i++) {
+    slot->clones[i] = scs_init(slot->d, slot->k, stgs);
+    if (!slot->clones[i]) {
+      free_mex(SCS_NULL, SCS_NULL, stgs);
+      return -1;
+    }
+    slot->n_clones = i + 1;
+  }
+  free_mex(SCS_NULL, SCS_NULL, stgs);
+  return 0;
+}
+
+static void cache_clear(void);
+
+/* Also empties the one-shot cache, which shares the mexAtExit function */
+static void ws_cleanup(void) {
+  scs_int i;
+  cache_clear();
+  for (i = 0; i < ws_table_len; i++) {
+    if (ws_table[i].handle) {
+      ws_release(&ws_table[i]);
+    }
+  }
+  if (ws_table) {
+    scs_free(ws_table);
+    ws_table = SCS_NULL;
+  }
+  ws_table_len = 0;
+}
+
+/* Returns a free slot, growing the table if needed. NULL on failure. */
+static ScsMexWorkspace *ws_alloc_slot(void) {
+  scs_int i, new_len;
+  ScsMexWorkspace *new_table;
+  for (i = 0; i < ws_table_len; i++) {
+    if (!ws_table[i].handle) {
+      return &ws_table[i];
+    }
+  }
+  new_len = ws_table_len > 0 ? 2 * ws_table_len : 8;
+  new_table =
+      (ScsMexWorkspace *)scs_calloc(new_len, sizeof(ScsMexWorkspace));
+  if (!new_table) {
+    return SCS_NULL;
+  }
+  if (ws_table) {
+    memcpy(new_table, ws_table, ws_table_len * sizeof(ScsMexWorkspace));
+    scs_free(ws_table);
+  }
+  ws_table = new_table;
+  i = ws_table_len;
+  ws_table_len = new_len;
+  return &ws_table[i];
+}
+
+/* Resolve a MATLAB handle (uint64 or double scalar) to its slot.
+ * Returns NULL if the handle is malformed, finished or unknown. */
+static ScsMexWorkspace *ws_lookup(const mxArray *h_mex) {
+  uint64_T h;
+  scs_int i;
+  if (h_mex == SCS_NULL || mxIsSparse(h_mex) || mxIsComplex(h_mex) ||
+      mxGetNumberOfElements(h_mex) != 1) {
+    return SCS_NULL;
+  }
+  if (mxIsUint64(h_mex)) {
+    h = *(uint64_T *)mxGetData(h_mex);
+  } else if (mxIsDouble(h_mex)) {
+    h = (uint64_T)*mxGetPr(h_mex);
+  } else {
+    return SCS_NULL;
+  }
+  if (h == 0) {
+    return SCS_NULL;
+  }
+  for (i = 0; i < ws_table_len; i++) {
+    if (ws_table[i].handle == h) {
+#ifdef UNIFIED_LINSYS
+      scs_unified_select(ws_table[i].lin_sys);
+#endif
+      return &ws_table[i];
+    }
+  }
+  return SCS_NULL;
+}
+
+static mxArray *ws_create_handle(uint64_T h) {
+  mxArray *h_mex = mxCreateNumericMatrix(1, 1, mxUINT64_CLASS, mxREAL);
+  *(uint64_T *)mxGetData(h_mex) = h;
+  return h_mex;
+}
+
+/* ======================== Workspace files ======================== */
+/* 'save' writes the problem a workspace was created from (data, cones and
+ * settings as retained by the slot) and, for the MATLAB-LDL backend, its
+ * factorization to a binary file; 'load' maps the file and creates a
+ * workspace from it, re-running only the equilibration and KKT formation
+ * and using the stored ordering and factor instead of ldl(). The
+ * equilibrated data is not stored, and the other backends factorize again
+ * on load. The stored matrices are checked (csc_valid) before use.
+ *
+ * A file is tied to the build that wrote it: the header holds the format
+ * version, the linear system method and the sizes of scs_int, scs_float and
+ * of the settings and cone structs (which are stored as raw images with
+ * their pointers cleared), and 'load' rejects any mismatch. Every section
+ * starts on an SCS_FILE_ALIGN boundary so arrays can be used straight from
+ * the mapping. L is: its pages are shared by every workspace (and process)
+ * that loads the same file until a refactorization replaces it. Everything
+ * else is copied. */
+
+#define SCS_FILE_MAGIC "SCSMEXWS"
+#define SCS_FILE_VERSION (1)
+#define SCS_FILE_ALIGN (64)
+#define SCS_FILE_MAX_THREADS (4096) /* bound on a stored lin_sys_threads */
+
+typedef struct {
+  char magic[8];
+  uint32_T version;
+  uint32_T int_size, float_size, settings_size, cone_size;
+  uint32_T has_ldl_factor; /* ldl opts and factor sections follow */
+  char lin_sys_method[64];
+} ScsFileHeader;
+
+/* Array fields of ScsCone and their lengths, given ScsCone *k */
+#ifdef USE_SPECTRAL_CONES
+#define SPECTRAL_CONE_ARRAYS(X)                                                \
+  X(d, k->dsize, scs_int)                                                      \
+  X(nuc_m, k->nucsize, scs_int)                                                \
+  X(nuc_n, k->nucsize, scs_int)                                                \
+  X(ell1, k->ell1_size, scs_int)                                               \
+  X(sl_n, k->sl_size, scs_int)                                                 \
+  X(sl_k, k->sl_size, scs_int)
+#else
+#define SPECTRAL_CONE_ARRAYS(X)
+#endif
+#define CONE_ARRAYS(X)                                                         \
+  X(q, k->qsize, scs_int)                                                      \
+  X(s, k->ssize, scs_int)                                                      \
+  X(cs, k->cssize, scs_int)                                                    \
+  X(p, k->psize, scs_float)                                                    \
+  X(bl, k->bsize > 0 ? k->bsize - 1 : 0, scs_float)                            \
+  X(bu, k->bsize > 0 ? k->bsize - 1 : 0, scs_float)                            \
+  SPECTRAL_CONE_ARRAYS(X)
+
+/* Write len bytes and pad to the next SCS_FILE_ALIGN boundary. */
+static scs_int file_put(FILE *f, const void *buf, size_t len) {
+  static const char zeros[SCS_FILE_ALIGN] = {0};
+  size_t pad = (SCS_FILE_ALIGN - len % SCS_FILE_ALIGN) % SCS_FILE_ALIGN;
+  if (len > 0 && fwrite(buf, 1, len, f) != len) {
+    return -1;
+  }
+  if (pad > 0 && fwrite(zeros, 1, pad, f) != pad) {
+    return -1;
+  }
+  return 0;
+}
+
+static scs_int file_put_matrix(FILE *f, const ScsMatrix *M) {
+  scs_int nnz = M->p[M->n];
+  if (file_put(f, M->p, (M->n + 1) * sizeof(scs_int)) < 0 ||
+      file_put(f, M->i, nnz * sizeof(scs_int)) < 0 ||
+      file_put(f, M->x, nnz * sizeof(scs_float)) < 0) {
+    return -1;
+  }
+  return 0;
+}
+
+/* Write the workspace file for slot. Returns an error message or NULL.
+ * The file is written under a temporary name next to filename and then
+ * renamed over it: a workspace loaded from filename may still map it (its
+ * L is used in place), and the mapping has to keep the old contents. */
+static const char *ws_save(const ScsMexWorkspace *slot, const char *filename) {
+  ScsFileHeader hdr;
+  ScsSettings stgs;
+  ScsCone kimg;
+  const ScsCone *k = slot->k;
+  const ScsData *d = slot->d;
+  scs_int dims[4];
+  scs_int ok;
+  size_t tmp_len = strlen(filename) + 32;
+  char *tmpname;
+  FILE *f;
+#ifdef MATLAB_LDL
+  ScsMatlabLdlFactor fac;
+  scs_int fdims[4];
+#endif
+
+  memset(&hdr, 0, sizeof(hdr));
+  memcpy(hdr.magic, SCS_FILE_MAGIC, sizeof(hdr.magic));
+  hdr.version = SCS_FILE_VERSION;
+  hdr.int_size = sizeof(scs_int);
+  hdr.float_size = sizeof(scs_float);
+  hdr.settings_size = sizeof(ScsSettings);
+  hdr.cone_size = sizeof(ScsCone);
+  strncpy(hdr.lin_sys_method, scs_get_lin_sys_method(),
+          sizeof(hdr.lin_sys_method) - 1);
+#ifdef MATLAB_LDL
+  hdr.has_ldl_factor = USE_MATLAB_LDL;
+#endif
+
+  memcpy(&stgs, slot->stgs, sizeof(ScsSettings));
+  stgs.write_data_filename = SCS_NULL;
+  stgs.log_csv_filename = SCS_NULL;
+  memcpy(&kimg, k, sizeof(ScsCone));
+#define CLEAR_CONE_ARR(field, len, type) kimg.field = SCS_NULL;
+  CONE_ARRAYS(CLEAR_CONE_ARR)
+#undef CLEAR_CONE_ARR
+
+  dims[0] = d->m;
+  dims[1] = d->n;
+  dims[2] = d->A->p[d->A->n];
+  dims[3] = d->P ? d->P->p[d->P->n] : -1;
+
+  tmpname = (char *)scs_malloc(tmp_len);
+  if (!tmpname) {
+    return "Memory allocation failed for the workspace file name.";
+  }
+#ifndef _WIN32
+  snprintf(tmpname, tmp_len, "%s.%ld.tmp", filename, (long)getpid());
+#else
+  snprintf(tmpname, tmp_len, "%s.tmp", filename);
+#endif
+  f = fopen(tmpname, "wb");
+  if (!f) {
+    scs_free(tmpname);
+    return "Could not open the workspace file for writing.";
+  }
+  ok = file_put(f, &hdr, sizeof(hdr)) == 0 &&
+       file_put(f, &stgs, sizeof(ScsSettings)) == 0 &&
+       file_put(f, &kimg, sizeof(ScsCone)) == 0 &&
+       file_put(f, dims, sizeof(dims)) == 0 &&
+       file_put_matrix(f, d->A) == 0 &&
+       (!d->P || file_put_matrix(f, d->P) == 0) &&
+       file_put(f, d->b, d->m * sizeof(scs_float)) == 0 &&
+       file_put(f, d->c, d->n * sizeof(scs_float)) == 0;
+#define PUT_CONE_ARR(field, len, type)                                         \
+  ok = ok && file_put(f, k->field, (len) * sizeof(type)) == 0;
+  CONE_ARRAYS(PUT_CONE_ARR)
+#undef PUT_CONE_ARR
+
+#ifdef MATLAB_LDL
+  if (USE_MATLAB_LDL) {
+    scs_matlab_ldl_get_factor(LIN_SYS_WORK(slot->work->p), &fac);
+    fdims[0] = fac.n_plus_m;
+    fdims[1] = fac.kkt_nnz;
+    fdims[2] = fac.Lp ? fac.L_nnz : -1;
+    fdims[3] = fac.L_from_qdldl;
+    ok = ok && file_put(f, &slot->ldl_opts, sizeof(ScsMatlabLdlOpts)) == 0 &&
+         file_put(f, fdims, sizeof(fdims)) == 0 &&
+         file_put(f, fac.perm, fac.n_plus_m * sizeof(scs_int)) == 0 &&
+         file_put(f, fac.kkt_x, fac.kkt_nnz * sizeof(scs_float)) == 0;
+    if (fac.Lp) {
+      ok = ok &&
+           file_put(f, fac.Lp, (fac.n_plus_m + 1) * sizeof(scs_int)) == 0 &&
+           file_put(f, fac.Li, fac.L_nnz * sizeof(scs_int)) == 0 &&
+           file_put(f, fac.Lx, fac.L_nnz * sizeof(scs_float)) == 0 &&
+           file_put(f, fac.D_diag, fac.n_plus_m * sizeof(scs_float)) == 0 &&
+           file_put(f, fac.D_sub,
+                    MAX(fac.n_plus_m - 1, 0) * sizeof(scs_float)) == 0;
+    }
+  }
+#endif
+
+  if (fclose(f) != 0) {
+    ok = 0;
+  }
+#ifdef _WIN32
+  /* rename does not replace an existing file; loads read the file into
+   * memory here, so nothing maps it */
+  if (ok) {
+    remove(filename);
+  }
+#endif
+  if (ok && rename(tmpname, filename) != 0) {
+    ok = 0;
+  }
+  if (!ok) {
+    remove(tmpname);
+  }
+  scs_free(tmpname);
+  return ok ? SCS_NULL : "Error writing the workspace file.";
+}
+
+/* Map filename read-only; read into memory where mmap is not available. */
+static void *file_map(const char *filename, size_t *len) {
+#ifndef _WIN32
+  struct stat st;
+  void *buf;
+  int fd = open(filename, O_RDONLY);
+  if (fd < 0) {
+    return SCS_NULL;
+  }
+  if (fstat(fd, &st) < 0 || st.st_size <= 0) {
+    close(fd);
+    return SCS_NULL;
+  }
+  buf = mmap(SCS_NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+  close(fd);
+  if (buf == MAP_FAILED) {
+    return SCS_NULL;
+  }
+  *len = (size_t)st.st_size;
+  return buf;
+#else
+  FILE *f = fopen(filename, "rb");
+  long sz;
+  void *buf = SCS_NULL;
+  if (!f) {
+    return SCS_NULL;
+  }
+  if (fseek(f, 0, SEEK_END) == 0 && (sz = ftell(f)) > 0 &&
+      fseek(f, 0, SEEK_SET) == 0) {
+    buf = scs_malloc((size_t)sz);
+    if (buf && fread(buf, 1, (size_t)sz, f) != (size_t)sz) {
+      scs_free(buf);
+      buf = SCS_NULL;
+    }
+    *len = (size_t)sz;
+  }
+  fclose(f);
+  return buf;
+#endif
+}
+
+static void file_unmap(void *buf, size_t len) {
+#ifndef _WIN32
+  munmap(buf, len);
+#else
+  scs_free(buf);
+#endif
+}
+
+/* Sequential reader over a mapped workspace file */
+typedef struct {
+  const char *buf;
+  size_t len, pos;
+} ScsFileCursor;
+
+/* Next section of len bytes, or NULL if it runs past the end of the file */
+static const void *file_take(ScsFileCursor *c, size_t len) {
+  const void *ptr;
+  size_t padded;
+  if (len > c->len) {
+    return SCS_NULL;
+  }
+  padded = len + (SCS_FILE_ALIGN - len % SCS_FILE_ALIGN) % SCS_FILE_ALIGN;
+  if (c->pos > c->len || padded > c->len - c->pos) {
+    return SCS_NULL;
+  }
+  ptr = c->buf + c->pos;
+  c->pos += padded;
+  return ptr;
+}
+
+/* Are there count elements of size bytes left in the mapping? Checked
+ * before count * size is formed from values read from the file. */
+static scs_int file_fits(const ScsFileCursor *c, scs_int count, size_t size) {
+  return count >= 0 && c->pos <= c->len &&
+         (size_t)count <= (c->len - c->pos) / size;
+}
+
+/* Next section of count elements of size bytes, count read from the file:
+ * NULL if it is negative or they do not fit (see file_fits). */
+static const void *file_take_arr(ScsFileCursor *c, scs_int count,
+                                 size_t size) {
+  if (!file_fits(c, count, size)) {
+    return SCS_NULL;
+  }
+  return file_take(c, (size_t)count * size);
+}
+
+/* Is M a CSC matrix SCS can take: column pointers from 0 to nnz without
+ * decreasing, row indices in [0, m) and increasing within each column and,
+ * for upper, none below the diagonal? */
+static scs_int csc_valid(const ScsMatrix *M, scs_int nnz, scs_int upper) {
+  scs_int j, q;
+  if (M->p[0] != 0 || M->p[M->n] != nnz) {
+    return 0;
+  }
+  for (j = 0; j < M->n; j++) {
+    if (M->p[j + 1] < M->p[j]) {
+      return 0;
+    }
+    for (q = M->p[j]; q < M->p[j + 1]; q++) {
+      if (M->i[q] < 0 || M->i[q] >= M->m || (upper && M->i[q] > j) ||
+          (q > M->p[j] && M->i[q] <= M->i[q - 1])) {
+        return 0;
+      }
+    }
+  }
+  return 1;
+}
+
+/* View of a stored matrix inside the mapping (arrays are not copied),
+ * checked with csc_valid as the file may be truncated or corrupt. */
+static scs_int file_take_matrix(ScsFileCursor *c, ScsMatrix *M, scs_int m,
+                                scs_int n, scs_int nnz, scs_int upper) {
+  M->m = m;
+  M->n = n;
+  if (!file_fits(c, n, sizeof(scs_int))) {
+    return -1;
+  }
+  M->p = (scs_int *)file_take_arr(c, n + 1, sizeof(scs_int));
+  M->i = (scs_int *)file_take_arr(c, nnz, sizeof(scs_int));
+  M->x = (scs_float *)file_take_arr(c, nnz, sizeof(scs_float));
+  if (!M->p || !M->i || !M->x || !csc_valid(M, nnz, upper)) {
+    return -1;
+  }
+  return 0;
+}
+
+#ifdef MATLAB_LDL
+/* Read the ldl options and factorization sections into slot (see ws_save).
+ * The stored sizes and options are checked here, the factor itself by
+ * preset_fits when it is used. Returns an error message or NULL. */
+static const char *file_take_ldl_factor(ScsFileCursor *c,
+                                        ScsMexWorkspace *slot) {
+  const ScsMatlabLdlOpts *opts = (const ScsMatlabLdlOpts *)file_take(
+      c, sizeof(ScsMatlabLdlOpts));
+  const scs_int *fdims = (const scs_int *)file_take(c, 4 * sizeof(scs_int));
+  ScsMatlabLdlFactor *fac = &slot->ldl_factor;
+
+  if (!opts || !fdims || opts->threads < 0 ||
+      opts->threads > SCS_FILE_MAX_THREADS || !(opts->refactor_tol >= 0) ||
+      opts->refine_steps < 0 ||
+      (opts->factor_single != 0 && opts->factor_single != 1) ||
+      fdims[0] < 0 || fdims[1] < 0 || fdims[2] < -1 ||
+      (fdims[3] != 0 && fdims[3] != 1) ||
+      !file_fits(c, fdims[0], sizeof(scs_int))) {
+    return "Truncated or corrupt workspace file.";
+  }
+  slot->ldl_opts = *opts;
+  fac->n_plus_m = fdims[0];
+  fac->kkt_nnz = fdims[1];
+  fac->L_from_qdldl = fdims[3];
+  fac->perm = (const scs_int *)file_take_arr(c, fdims[0], sizeof(scs_int));
+  fac->kkt_x =
+      (const scs_float *)file_take_arr(c, fdims[1], sizeof(scs_float));
+  if (!fac->perm || !fac->kkt_x) {
+    return "Truncated or corrupt workspace file.";
+  }
+  if (fdims[2] >= 0) {
+    fac->L_nnz = fdims[2];
+    fac->Lp = (const scs_int *)file_take_arr(c, fdims[0] + 1, sizeof(scs_int));
+    fac->Li = (const scs_int *)file_take_arr(c, fdims[2], sizeof(scs_int));
+    fac->Lx = (const scs_float *)file_take_arr(c, fdims[2], sizeof(scs_float));
+    fac->D_diag =
+        (const scs_float *)file_take_arr(c, fdims[0], sizeof(scs_float));
+    fac->D_sub = (const scs_float *)file_take_arr(c, MAX(fdims[0] - 1, 0),
+                                                  sizeof(scs_float));
+    if (!fac->Lp || !fac->Li || !fac->Lx || !fac->D_diag || !fac->D_sub) {
+      return "Truncated or corrupt workspace file.";
+    }
+  }
+  slot->has_ldl_factor = 1;
+  return SCS_NULL;
+}
+#endif
+
+/* Fill slot (a free slot from ws_alloc_slot) from the workspace file and
+ * create its ScsWork. Returns an error message or NULL; on error the slot
+ * is left free. */
+static const char *ws_load(ScsMexWorkspace *slot, const char *filename) {
+  ScsFileCursor cur = {0};
+  const ScsFileHeader *hdr;
+  const ScsSettings *stgs;
+  const scs_int *dims;
+  ScsCone kview, *k = &kview;
+  ScsData dview;
+  ScsMatrix A, P;
+  const char *err = SCS_NULL;
+  size_t len = 0;
+  void *buf = file_map(filename, &len);
+
+  if (!buf) {
+    return "Could not open the workspace file.";
+  }
+  cur.buf = (const char *)buf;
+  cur.len = len;
+  memset(&dview, 0, sizeof(dview));
+
+  hdr = (const ScsFileHeader *)file_take(&cur, sizeof(ScsFileHeader));
+  if (!hdr || memcmp(hdr->magic, SCS_FILE_MAGIC, sizeof(hdr->magic))) {
+    err = "Not an SCS workspace file.";
+  } else if (hdr->version != SCS_FILE_VERSION) {
+    err = "Unsupported workspace file version.";
+  } else if (hdr->int_size != sizeof(scs_int) ||
+             hdr->float_size != sizeof(scs_float) ||
+             hdr->settings_size != sizeof(ScsSettings) ||
+             hdr->cone_size != sizeof(ScsCone)) {
+    err = "Workspace file was written by an incompatible SCS build.";
+  }
+
+  if (!err) {
+    stgs = (const ScsSettings *)file_take(&cur, sizeof(ScsSettings));
+    k = (ScsCone *)file_take(&cur, sizeof(ScsCone));
+    dims = (const scs_int *)file_take(&cur, 4 * sizeof(scs_int));
+    if (!stgs || !k || !dims || dims[0] < 0 || dims[1] < 0) {
+      err = "Truncated or corrupt workspace file.";
+    }
+  }
+  if (!err) {
+    kview = *k;
+    k = &kview;
+    dview.m = dims[0];
+    dview.n = dims[1];
+    dview.A = &A;
+    dview.P = dims[3] >= 0 ? &P : SCS_NULL;
+    if (file_take_matrix(&cur, &A, dims[0], dims[1], dims[2], 0) < 0 ||
+        (dview.P &&
+         file_take_matrix(&cur, &P, dims[1], dims[1], dims[3], 1) < 0)) {
+      err = "Truncated or corrupt workspace file.";
+    }
+  }
+  if (!err) {
+    dview.b = (scs_float *)file_take_arr(&cur, dims[0], sizeof(scs_float));
+    dview.c = (scs_float *)file_take_arr(&cur, dims[1], sizeof(scs_float));
+    if (!dview.b || !dview.c) {
+      err = "Truncated or corrupt workspace file.";
+    }
+  }
+  if (!err) {
+#define TAKE_CONE_ARR(field, len, type)                                        \
+  k->field = SCS_NULL;                                                         \
+  if ((len) < 0 || ((len) > 0 && !file_fits(&cur, (len), sizeof(type)))) {    \
+    err = "Truncated or corrupt workspace file.";                              \
+  } else if ((len) > 0) {                                                      \
+    k->field = (type *)file_take_arr(&cur, (len), sizeof(type));               \
+    if (!k->field) {                                                           \
+      err = "Truncated or corrupt workspace file.";                            \
+    }                                                                          \
+  }
+    CONE_ARRAYS(TAKE_CONE_ARR)
+#undef TAKE_CONE_ARR
+  }
+  if (err) {
+    file_unmap(buf, len);
+    return err;
+  }
+
+  slot->n = dview.n;
+  slot->m = dview.m;
+  slot->d = copy_data(&dview);
+  slot->k = copy_cone(k);
+  slot->stgs = copy_settings(stgs);
+  if (!slot->d || !slot->k || !slot->stgs) {
+    file_unmap(buf, len);
+    ws_release(slot);
+    return "Memory allocation failed for workspace data.";
+  }
+
+#ifdef UNIFIED_LINSYS
+  {
+    /* The backend that wrote the file, else the default one */
+    char method[sizeof(hdr->lin_sys_method) + 1];
+    scs_int id;
+    memcpy(method, hdr->lin_sys_method, sizeof(hdr->lin_sys_method));
+    method[sizeof(hdr->lin_sys_method)] = '\0';
+    id = scs_unified_find_method(method);
+    scs_unified_select(id >= 0 ? id : SCS_LIN_SYS_MATLAB_LDL);
+    slot->lin_sys = scs_unified_selected();
+  }
+#endif
+#ifdef MATLAB_LDL
+  scs_matlab_ldl_default_opts(&slot->ldl_opts);
+  if (hdr->has_ldl_factor &&
+      !strncmp(hdr->lin_sys_method, scs_get_lin_sys_method(),
+               sizeof(hdr->lin_sys_method))) {
+    err = file_take_ldl_factor(&cur, slot);
+    if (err) {
+      file_unmap(buf, len);
+      ws_release(slot);
+      return err;
+    }
+  }
+  scs_matlab_ldl_set_opts(&slot->ldl_opts);
+  if (slot->has_ldl_factor) {
+    scs_matlab_ldl_preset_factor(&slot->ldl_factor);
+    slot->file_map = buf;
+    slot->file_len = len;
+  }
+#endif
+  slot->work = scs_init(slot->d, slot->k, slot->stgs);
+#ifdef MATLAB_LDL
+  /* scs_init only takes the offer if it gets to the linear system; it must
+   * not outlive this slot, which ws_release clears on failure */
+  scs_matlab_ldl_preset_factor(SCS_NULL);
+#endif
+  if (!slot->file_map) {
+    file_unmap(buf, len);
+  }
+  if (!slot->work) {
+    ws_release(slot);
+    return "SCS init failed.";
+  }
+  return SCS_NULL;
+}
+
+/* ======================== Helper functions ======================== */
+
+/* The CSC index arrays of A and P are handed to SCS in place when scs_int
+ * and mwIndex have the same width (e.g. DLONG with 64-bit MATLAB) and are
+ * only converted when the widths differ. */
+#define COPY_MEX_INDICES (sizeof(scs_int) != sizeof(mwIndex))
+
+/* this memory must be freed */
+scs_int *cast_to_scs_int_arr(mwIndex *arr, scs_int len) {
+  scs_int i;
+  scs_int *arr_out =
+      (scs_int *)scs_malloc(sizeof(scs_int) * (len > 0 ? len : 1));
+  if (!arr_out) return SCS_NULL;
+  for (i = 0; i < len; i++) {
+    arr_out[i] = (scs_int)arr[i];
+  }
+  return arr_out;
+}
+
+static scs_int *mex_index_arr(mwIndex *arr, scs_int len) {
+  if (COPY_MEX_INDICES) {
+    return cast_to_scs_int_arr(arr, len);
+  }
+  return (scs_int *)arr;
+}
+
+/* Dense arrays of the MATLAB class of scs_float (single in SFLOAT builds,
+ * else double) are handed to SCS in place; the other class is converted. */
+#ifdef SFLOAT
+#define MEX_FLOAT_IS_SINGLE (1)
+#else
+#define MEX_FLOAT_IS_SINGLE (0)
+#endif
+
+/* Whether v_mex is a real dense double or single array */
+static scs_int is_float_arr(const mxArray *v_mex) {
+  return (mxIsDouble(v_mex) || mxIsSingle(v_mex)) && !mxIsSparse(v_mex) &&
+         !mxIsComplex(v_mex);
+}
+
+/* Convert the first len values of v_mex (see is_float_arr) into dst */
+static void copy_float_arr(scs_float *dst, const mxArray *v_mex,
+                           scs_int len) {
+  scs_int i;
+  if (mxIsSingle(v_mex)) {
+    const float *pr = (const float *)mxGetData(v_mex);
+    for (i = 0; i < len; i++) {
+      dst[i] = (scs_float)pr[i];
+    }
+  } else {
+    const double *pr = mxGetPr(v_mex);
+    for (i = 0; i < len; i++) {
+      dst[i] = (scs_float)pr[i];
+    }
+  }
+}
+
+/* The values of v_mex (see is_float_arr) as scs_float: its own buffer if
+ * its class is that of scs_float, else a converted copy, which the caller
+ * frees (*copied = 1). NULL if out of memory. */
+static scs_float *mex_float_arr(const mxArray *v_mex, scs_int len,
+                                scs_int *copied) {
+  scs_float *out;
+  if (mxIsSingle(v_mex) == MEX_FLOAT_IS_SINGLE) {
+    *copied = 0;
+    return (scs_float *)mxGetData(v_mex);
+  }
+  *copied = 1;
+  out = (scs_float *)scs_malloc(sizeof(scs_float) * (len > 0 ? len : 1));
+  if (out) {
+    copy_float_arr(out, v_mex, len);
+  }
+  return out;
+}
+
+#ifdef SFLOAT
+/* this memory must be freed */
+scs_float *cast_to_scs_float_arr(double *arr, scs_int len) {
+  scs_int i;
+  scs_float *arr_out = (scs_float *)scs_malloc(sizeof(scs_float) * len);
+  if (!arr_out) return SCS_NULL;
+  for (i = 0; i < len; i++) {
+    arr_out[i] = (scs_float)arr[i];
+  }
+  return arr_out;
+}
+#endif
+
+/* Create a len x 1 double (single if single is set) output and return the
+ * buffer SCS should write the solution vector into. If the output has the
+ * class of scs_float that is its own storage, so the solution lands in
+ * MATLAB memory with no extra copy; otherwise it is a scratch array that
+ * finish_output_field converts and frees. */
+static scs_float *create_output_field(mxArray **pout, scs_int len,
+                                      scs_int single) {
+  *pout = mxCreateNumericMatrix(len, 1,
+                                single ? mxSINGLE_CLASS : mxDOUBLE_CLASS,
+                                mxREAL);
+  if (single == MEX_FLOAT_IS_SINGLE) {
+    return (scs_float *)mxGetData(*pout);
+  }
+  return (scs_float *)scs_calloc(len > 0 ? len : 1, sizeof(scs_float));
+}
+
+static void finish_output_field(mxArray *out, scs_float *buf, scs_int len) {
+  scs_int i;
+  if (buf == (scs_float *)mxGetData(out)) {
+    return;
+  }
+  if (mxIsSingle(out)) {
+    float *pr = (float *)mxGetData(out);
+    for (i = 0; i < len; i++) {
+      pr[i] = (float)buf[i];
+    }
+  } else {
+    double *pr = mxGetPr(out);
+    for (i = 0; i < len; i++) {
+      pr[i] = (double)buf[i];
+    }
+  }
+  scs_free(buf);
+}
+
+/* Free an output buffer from create_output_field on an error path */
+static void free_output_field(mxArray *out, scs_float *buf) {
+  if (buf && (!out || buf != (scs_float *)mxGetData(out))) {
+    scs_free(buf);
+  }
+}
+
+/* Copy a warm-start vector into the solution buffer p (from
+ * create_output_field). It cannot alias p_mex, since SCS writes the
+ * solution over p. Returns 1 if p_mex was usable, else leaves p as is. */
+static scs_int parse_warm_start(const mxArray *p_mex, scs_float *p, scs_int l) {
+  if (p_mex == SCS_NULL) {
+    return 0;
+  } else if (!is_float_arr(p_mex) ||
+             (scs_int)mxGetNumberOfElements(p_mex) != l) {
+    scs_printf("Error parsing warm start input (make sure vectors are not "
+               "sparse and of correct size), running without full "
+               "warm-start\n");
+    return 0;
+  } else {
+    if (mxIsSingle(p_mex) == MEX_FLOAT_IS_SINGLE) {
+      memcpy(p, mxGetData(p_mex), l * sizeof(scs_float));
+    } else {
+      copy_float_arr(p, p_mex, l);
+    }
+    return 1;
+  }
+}
+
+/* Whether M_mex can give new values for M, whose pattern is fixed at
+ * 'init': either a sparse matrix with exactly that pattern or a dense
+ * (double or single) vector of nnz(M) values in column-major order. */
+static scs_int matrix_values_fit(const mxArray *M_mex, const ScsMatrix *M) {
+  scs_int j, k, nnz = M->p[M->n];
+  const mwIndex *jc, *ir;
+
+  if (mxIsComplex(M_mex) || !(mxIsDouble(M_mex) || mxIsSingle(M_mex))) {
+    return 0;
+  }
+  if (!mxIsSparse(M_mex)) {
+    return (scs_int)mxGetNumberOfElements(M_mex) == nnz;
+  }
+  if ((scs_int)mxGetM(M_mex) != M->m || (scs_int)mxGetN(M_mex) != M->n) {
+    return 0;
+  }
+  jc = mxGetJc(M_mex);
+  ir = mxGetIr(M_mex);
+  for (j = 0; j <= M->n; j++) {
+    if ((scs_int)jc[j] != M->p[j]) {
+      return 0;
+    }
+  }
+  for (k = 0; k < nnz; k++) {
+    if ((scs_int)ir[k] != M->i[k]) {
+      return 0;
+    }
+  }
+  return 1;
+}
+
+/* Get length of a MATLAB array (handles row and column vectors) */
+static scs_int get_mex_length(const mxArray *arr) {
+  scs_int ndim = (scs_int)mxGetNumberOfDimensions(arr);
+  const size_t *dims = mxGetDimensions(arr);
+  scs_int len = (scs_int)dims[0];
+  if (ndim > 1 && dims[0] == 1) {
+    len = (scs_int)dims[1];
+  }
+  return len;
+}
+
+/* Check a cone parameter update for 'update': a struct with any of the
+ * fields bl, bu (box cone bounds) and p (power cone exponents), each a
+ * double vector of the length given at 'init'. Returns an error message or
+ * NULL if the update can be applied with set_cone_params. */
+static const char *check_cone_params(const ScsCone *k,
+                                     const mxArray *cone_mex) {
+  const mxArray *bl_mex, *bu_mex, *p_mex;
+  const double *bl, *bu, *pr;
+  scs_int i, f, blen = k->bsize > 0 ? k->bsize - 1 : 0;
+
+  if (!mxIsStruct(cone_mex) || mxGetNumberOfElements(cone_mex) != 1) {
+    return "Cone update must be a struct.";
+  }
+  for (f = 0; f < mxGetNumberOfFields(cone_mex); f++) {
+    const char *name = mxGetFieldNameByNumber(cone_mex, f);
+    if (strcmp(name, "bl") && strcmp(name, "bu") && strcmp(name, "p")) {
+      return "Only the cone fields bl, bu and p can be updated.";
+    }
+  }
+  bl_mex = mxGetField(cone_mex, 0, "bl");
+  bu_mex = mxGetField(cone_mex, 0, "bu");
+  p_mex = mxGetField(cone_mex, 0, "p");
+  if ((bl_mex && (!mxIsDouble(bl_mex) || mxIsSparse(bl_mex) ||
+                  get_mex_length(bl_mex) != blen || blen == 0)) ||
+      (bu_mex && (!mxIsDouble(bu_mex) || mxIsSparse(bu_mex) ||
+                  get_mex_length(bu_mex) != blen || blen == 0))) {
+    return "bl and bu must be double vectors of the box cone size.";
+  }
+  bl = bl_mex ? mxGetPr(bl_mex) : SCS_NULL;
+  bu = bu_mex ? mxGetPr(bu_mex) : SCS_NULL;
+  for (i = 0; i < blen && (bl || bu); i++) {
+    if ((bl ? bl[i] : (double)k->bl[i]) > (bu ? bu[i] : (double)k->bu[i])) {
+      return "Box cone bounds must satisfy bl <= bu.";
+    }
+  }
+  if (p_mex) {
+    if (!mxIsDouble(p_mex) || mxIsSparse(p_mex) || k->psize == 0 ||
+        get_mex_length(p_mex) != k->psize) {
+      return "p must be a double vector with one entry per power cone.";
+    }
+    pr = mxGetPr(p_mex);
+    for (i = 0; i < k->psize; i++) {
+      if (!(pr[i] >= -1.0 && pr[i] <= 1.0)) {
+        return "Power cone exponents must lie in [-1, 1].";
+      }
+    }
+  }
+  return SCS_NULL;
+}
+
+/* Write a cone parameter update (see check_cone_params) into k. */
+static void set_cone_params(ScsCone *k, const mxArray *cone_mex) {
+  const mxArray *tmp;
+  const double *pr;
+  scs_int i;
+
+  if ((tmp = mxGetField(cone_mex, 0, "bl")) != SCS_NULL) {
+    pr = mxGetPr(tmp);
+    for (i = 0; i < k->bsize - 1; i++) {
+      k->bl[i] = (scs_float)pr[i];
+    }
+  }
+  if ((tmp = mxGetField(cone_mex, 0, "bu")) != SCS_NULL) {
+    pr = mxGetPr(tmp);
+    for (i = 0; i < k->bsize - 1; i++) {
+      k->bu[i] = (scs_float)pr[i];
+    }
+  }
+  if ((tmp = mxGetField(cone_mex, 0, "p")) != SCS_NULL) {
+    pr = mxGetPr(tmp);
+    for (i = 0; i < k->psize; i++) {
+      k->p[i] = (scs_float)pr[i];
+    }
+  }
+}
+
+#ifndef MAX_BOX_VAL
+#define MAX_BOX_VAL (1e15) /* as in SCS's cones.c */
+#endif
+
+/* Box bounds of k into the live cone of w. SCS equilibrates the box rows
+ * one by one and, once, scales the bounds of its cone copy in place to
+ * D[j + 1] / D[0] times the given ones, bounds beyond MAX_BOX_VAL becoming
+ * infinite (normalize_box_cone in SCS's cones.c). The new bounds are
+ * scaled the same way here, and the cone work is marked as scaled so SCS
+ * does not scale them again. */
+static void set_work_box(ScsWork *w, const ScsCone *k) {
+  const scs_float *D = w->scal ? &w->scal->D[k->z + k->l] : SCS_NULL;
+  scs_int j;
+
+  for (j = 0; j < k->bsize - 1; j++) {
+    if (k->bu[j] >= MAX_BOX_VAL) {
+      w->k->bu[j] = INFINITY;
+    } else {
+      w->k->bu[j] = D ? D[j + 1] * k->bu[j] / D[0] : k->bu[j];
+    }
+    if (k->bl[j] <= -MAX_BOX_VAL) {
+      w->k->bl[j] = -INFINITY;
+    } else {
+      w->k->bl[j] = D ? D[j + 1] * k->bl[j] / D[0] : k->bl[j];
+    }
+  }
+  w->cone_work->scaled_cones = 1;
+}
+
+/* ScsData as allocated by parse_data, with whether b and c are converted
+ * copies rather than MATLAB's own arrays. d comes first, so free_mex can
+ * take the ScsData and find the flags. */
+typedef struct {
+  ScsData d;
+  scs_int b_copied, c_copied;
+  scs_int A_built, P_built; /* built by parse_data, else borrowed */
+} ScsMexData;
+
+/* ---- A and P ----
+ * A and P may be sparse (double) or dense (double or single). Sparse A and
+ * sparse upper triangular P are handed to SCS in place, as far as the
+ * index and value types allow (COPY_MEX_INDICES, SFLOAT). Everything else
+ * is built straight into the ScsMatrix SCS reads, in one pass over the
+ * nonzeros after a counting pass: dense matrices keep their nonzeros, and
+ * a P that is not upper triangular becomes triu(P + P') / 2. This is what
+ * scs_prepare_data used to do in MATLAB, with its sparse(), istriu() and
+ * triu() copies of P. */
+
+/* Dense input, double or single */
+typedef struct {
+  const double *pr;
+  const float *ps;
+  size_t ld; /* rows */
+} ScsMexDense;
+
+static ScsMexDense dense_view(const mxArray *M_mex) {
+  ScsMexDense v;
+  v.pr = mxIsDouble(M_mex) ? mxGetPr(M_mex) : SCS_NULL;
+  v.ps = mxIsDouble(M_mex) ? SCS_NULL : (const float *)mxGetData(M_mex);
+  v.ld = mxGetM(M_mex);
+  return v;
+}
+
+static double dense_at(const ScsMexDense *v, scs_int i, scs_int j) {
+  size_t idx = (size_t)j * v->ld + (size_t)i;
+  return v->pr ? v->pr[idx] : (double)v->ps[idx];
+}
+
+/* Is the m x n matrix upper triangular? Only reads the row indices of a
+ * sparse matrix. */
+static scs_int mex_is_triu(const mxArray *M_mex, scs_int n) {
+  scs_int i, j;
+  if (mxIsSparse(M_mex)) {
+    const mwIndex *jc = mxGetJc(M_mex), *ir = mxGetIr(M_mex);
+    for (j = 0; j < n; j++) {
+      /* rows are sorted: only the last one of a column can be below */
+      if (jc[j + 1] > jc[j] && (scs_int)ir[jc[j + 1] - 1] > j) {
+        return 0;
+      }
+    }
+  } else {
+    ScsMexDense v = dense_view(M_mex);
+    for (j = 0; j < n; j++) {
+      for (i = j + 1; i < (scs_int)v.ld; i++) {
+        if (dense_at(&v, i, j) != 0) {
+          return 0;
+        }
+      }
+    }
+  }
+  return 1;
+}
+
+/* Entry (i, j) of a dense A (sym = 0) or of triu(P + P') / 2 (sym = 1) */
+static double dense_entry(const ScsMexDense *v, scs_int i, scs_int j,
+                          scs_int sym) {
+  if (!sym || i == j) {
+    return dense_at(v, i, j);
+  }
+  return (dense_at(v, i, j) + dense_at(v, j, i)) / 2;
+}
+
+/* CSC of the m x n dense M_mex, or of its upper triangle (upper = 1),
+ * symmetrized if sym. Exact zeros are dropped, as by sparse(). */
+static ScsMatrix *dense_to_csc(const mxArray *M_mex, scs_int m, scs_int n,
+                               scs_int upper, scs_int sym) {
+  ScsMexDense v = dense_view(M_mex);
+  ScsMatrix *M;
+  scs_int i, j, q = 0, nnz = 0;
+  double x;
+
+  for (j = 0; j < n; j++) {
+    for (i = 0; i < (upper ? j + 1 : m); i++) {
+      nnz += dense_entry(&v, i, j, sym) != 0;
+    }
+  }
+  M = alloc_matrix(m, n, nnz);
+  if (!M) {
+    return SCS_NULL;
+  }
+  for (j = 0; j < n; j++) {
+    M->p[j] = q;
+    for (i = 0; i < (upper ? j + 1 : m); i++) {
+      x = dense_entry(&v, i, j, sym);
+      if (x != 0) {
+        M->i[q] = i;
+        M->x[q++] = (scs_float)x;
+      }
+    }
+  }
+  M->p[n] = q;
+  return M;
+}
+
+/* triu(P + P') / 2 of the sparse n x n P_mex. The strictly lower entries
+ * are first transposed into T (its columns come out sorted), then column c
+ * of the result is the merge of the upper part of column c of P with
+ * column c of T. Entries that cancel are dropped, as by triu(). */
+static ScsMatrix *sparse_sym_upper(const mxArray *P_mex, scs_int n) {
+  const mwIndex *jc = mxGetJc(P_mex), *ir = mxGetIr(P_mex);
+  const double *pr = mxGetPr(P_mex);
+  scs_int *tp, *ti, *next;
+  scs_float *tx;
+  ScsMatrix *P = SCS_NULL;
+  scs_int i, j, k, t, q, ru, rt, nnz_low = 0;
+  double x;
+
+  tp = (scs_int *)scs_calloc(n + 1, sizeof(scs_int));
+  next = (scs_int *)scs_calloc(n + 1, sizeof(scs_int));
+  if (!tp || !next) {
+    scs_free(tp);
+    scs_free(next);
+    return SCS_NULL;
+  }
+  for (j = 0; j < n; j++) {
+    for (k = (scs_int)jc[j]; k < (scs_int)jc[j + 1]; k++) {
+      i = (scs_int)ir[k];
+      if (i > j) {
+        tp[i + 1]++;
+        nnz_low++;
+      }
+    }
+  }
+  for (j = 0; j < n; j++) {
+    tp[j + 1] += tp[j];
+    next[j] = tp[j];
+  }
+  ti = (scs_int *)scs_malloc(MAX(nnz_low, 1) * sizeof(scs_int));
+  tx = (scs_float *)scs_malloc(MAX(nnz_low, 1) * sizeof(scs_float));
+  if (ti && tx) {
+    P = alloc_matrix(n, n, (scs_int)jc[n]);
+  }
+  if (!P) {
+    scs_free(tp);
+    scs_free(next);
+    scs_free(ti);
+    scs_free(tx);
+    return SCS_NULL;
+  }
+  for (j = 0; j < n; j++) {
+    for (k = (scs_int)jc[j]; k < (scs_int)jc[j + 1]; k++) {
+      i = (scs_int)ir[k];
+      if (i > j) {
+        q = next[i]++;
+        ti[q] = j;
+        tx[q] = (scs_float)pr[k];
+      }
+    }
+  }
+
+  q = 0;
+  for (j = 0; j < n; j++) {
+    P->p[j] = q;
+    k = (scs_int)jc[j];
+    t = tp[j];
+    for (;;) {
+      ru = k < (scs_int)jc[j + 1] && (scs_int)ir[k] <= j ? (scs_int)ir[k] : n;
+      rt = t < tp[j + 1] ? ti[t] : n;
+      if (ru == n && rt == n) {
+        break;
+      }
+      if (ru == rt) {
+        i = ru;
+        x = (pr[k++] + tx[t++]) / 2;
+      } else if (ru < rt) {
+        i = ru;
+        x = ru == j ? pr[k] : pr[k] / 2;
+        k++;
+      } else {
+        i = rt;
+        x = tx[t++] / 2;
+      }
+      if (x != 0) {
+        P->i[q] = i;
+        P->x[q++] = (scs_float)x;
+      }
+    }
+  }
+  P->p[n] = q;
+  scs_free(tp);
+  scs_free(next);
+  scs_free(ti);
+  scs_free(tx);
+  return P;
+}
+
+/* Sparse M_mex as an m x n ScsMatrix using MATLAB's arrays where the types
+ * match. Free with free_mex. */
+static ScsMatrix *borrow_sparse(const mxArray *M_mex, scs_int m, scs_int n) {
+  ScsMatrix *M = (ScsMatrix *)scs_calloc(1, sizeof(ScsMatrix));
+  if (!M) {
+    return SCS_NULL;
+  }
+  M->m = m;
+  M->n = n;
+  M->p = mex_index_arr(mxGetJc(M_mex), n + 1);
+  M->i = M->p ? mex_index_arr(mxGetIr(M_mex), M->p[n]) : SCS_NULL;
+#ifdef SFLOAT
+  M->x = M->i ? cast_to_scs_float_arr(mxGetPr(M_mex), M->p[n]) : SCS_NULL;
+#else
+  M->x = (scs_float *)mxGetPr(M_mex);
+#endif
+  if (!M->p || !M->i || !M->x) {
+    if (COPY_MEX_INDICES) {
+      scs_free(M->p);
+      scs_free(M->i);
+    }
+#ifdef SFLOAT
+    scs_free(M->x);
+#endif
+    scs_free(M);
+    return SCS_NULL;
+  }
+  return M;
+}
+
+/* Free a matrix from borrow_sparse, or from alloc_matrix if built */
+static void free_mex_matrix(ScsMatrix *M, scs_int built) {
+  if (!M) {
+    return;
+  }
+  if (built) {
+    free_matrix_copy(M);
+    return;
+  }
+  if (COPY_MEX_INDICES) { /* only free if copies */
+    scs_free(M->p);
+    scs_free(M->i);
+  }
+#ifdef SFLOAT /* only free if copies, which is only when flags set */
+  scs_free(M->x);
+#endif
+  scs_free(M);
+}
+
+/* Real double matrix, or dense single */
+static scs_int is_matrix_arr(const mxArray *M_mex) {
+  return mxGetNumberOfDimensions(M_mex) == 2 && !mxIsComplex(M_mex) &&
+         (mxIsDouble(M_mex) || (!mxIsSparse(M_mex) && mxIsSingle(M_mex)));
+}
+
+static scs_int is_vector_arr(const mxArray *v_mex) {
+  return mxGetNumberOfDimensions(v_mex) == 2 &&
+         (mxGetM(v_mex) <= 1 || mxGetN(v_mex) <= 1);
+}
+
+/* Parse data struct (A, P, b, c) into ScsData, doing the normalization
+ * and checks of scs_prepare_data (see above). b and c are vectors (row or
+ * column) of double or single (see mex_float_arr). P may be absent or [].
+ * Caller must free d, d->A, d->P (if non-NULL) via free_mex(d, NULL, NULL). */
+static scs_int parse_data(const mxArray *data_mex, ScsData **d_out) {
+  ScsMexData *md;
+  ScsData *d;
+  const mxArray *A_mex, *P_mex, *b_mex, *c_mex;
+
+  md = (ScsMexData *)scs_calloc(1, sizeof(ScsMexData));
+  if (!md) {
+    return -1;
+  }
+  d = &md->d;
+
+  A_mex = (mxArray *)mxGetField(data_mex, 0, "A");
+  if (A_mex == SCS_NULL) {
+    scs_free(d);
+    scs_printf("ScsData struct must contain a `A` entry.\n");
+    return -1;
+  }
+  if (!is_matrix_arr(A_mex)) {
+    scs_free(d);
+    scs_printf("Input matrix A must be a real double (or dense single) "
+               "matrix.\n");
+    return -1;
+  }
+  P_mex = (mxArray *)mxGetField(data_mex, 0, "P"); /* can be SCS_NULL */
+  if (P_mex && mxIsEmpty(P_mex)) {
+    P_mex = SCS_NULL;
+  }
+  if (P_mex && !is_matrix_arr(P_mex)) {
+    scs_free(d);
+    scs_printf("Input matrix P must be a real double (or dense single) "
+               "matrix.\n");
+    return -1;
+  }
+  b_mex = (mxArray *)mxGetField(data_mex, 0, "b");
+  if (b_mex == SCS_NULL) {
+    scs_free(d);
+    scs_printf("ScsData struct must contain a `b` entry.\n");
+    return -1;
+  }
+  if (mxIsSparse(b_mex)) {
+    scs_free(d);
+    scs_printf("Input vector b must be in dense format (pass in full(b))\n");
+    return -1;
+  }
+  if (!is_float_arr(b_mex) || !is_vector_arr(b_mex)) {
+    scs_free(d);
+    scs_printf("Input vector b must be a real double or single vector.\n");
+    return -1;
+  }
+  c_mex = (mxArray *)mxGetField(data_mex, 0, "c");
+  if (c_mex == SCS_NULL) {
+    scs_free(d);
+    scs_printf("ScsData struct must contain a `c` entry.\n");
+    return -1;
+  }
+  if (mxIsSparse(c_mex)) {
+    scs_free(d);
+    scs_printf("Input vector c must be in dense format (pass in full(c))\n");
+    return -1;
+  }
+  if (!is_float_arr(c_mex) || !is_vector_arr(c_mex)) {
+    scs_free(d);
+    scs_printf("Input vector c must be a real double or single vector.\n");
+    return -1;
+  }
+
+  d->n = (scs_int)mxGetNumberOfElements(c_mex);
+  d->m = (scs_int)mxGetNumberOfElements(b_mex);
+  if ((scs_int)mxGetM(A_mex) != d->m) {
+    scs_free(d);
+    scs_printf("A and b shape mismatch.\n");
+    return -1;
+  }
+  if ((scs_int)mxGetN(A_mex) != d->n) {
+    scs_free(d);
+    scs_printf("A and c shape mismatch.\n");
+    return -1;
+  }
+  if (P_mex && mxGetM(P_mex) != mxGetN(P_mex)) {
+    scs_free(d);
+    scs_printf("P is not square.\n");
+    return -1;
+  }
+  if (P_mex && (scs_int)mxGetN(P_mex) != d->n) {
+    scs_free(d);
+    scs_printf("P and c shape mismatch.\n");
+    return -1;
+  }
+
+  d->b = mex_float_arr(b_mex, d->m, &md->b_copied);
+  d->c = mex_float_arr(c_mex, d->n, &md->c_copied);
+  if (!d->b || !d->c) {
+    free_mex(d, SCS_NULL, SCS_NULL);
+    scs_printf("Memory allocation failed for vectors b or c.\n");
+    return -1;
+  }
+
+  md->A_built = !mxIsSparse(A_mex);
+  d->A = md->A_built ? dense_to_csc(A_mex, d->m, d->n, 0, 0)
+                     : borrow_sparse(A_mex, d->m, d->n);
+  if (!d->A) {
+    free_mex(d, SCS_NULL, SCS_NULL);
+    scs_printf("Memory allocation failed for A.\n");
+    return -1;
+  }
+  if (P_mex) {
+    scs_int sym = !mex_is_triu(P_mex, d->n);
+    md->P_built = sym || !mxIsSparse(P_mex);
+    if (!mxIsSparse(P_mex)) {
+      d->P = dense_to_csc(P_mex, d->n, d->n, 1, sym);
+    } else if (sym) {
+      d->P = sparse_sym_upper(P_mex, d->n);
+    } else {
+      d->P = borrow_sparse(P_mex, d->n, d->n);
+    }
+    if (!d->P) {
+      free_mex(d, SCS_NULL, SCS_NULL);
+      scs_printf("Memory allocation failed for P.\n");
+      return -1;
+    }
+  }
+
+  *d_out = d;
+  return 0;
+}
+
+/* Overwrite the fields of stgs that are set in the settings struct. The
+ * file name strings are allocated and must be freed by free_mex. */
+static void set_settings(const mxArray *settings_mex, ScsSettings *stgs) {
+  mxArray *tmp;
+
+#define GET_SETTING_FLOAT(field)                                               \
+  tmp = mxGetField(settings_mex, 0, #field);                                   \
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp))                                      \
+  stgs->field = (scs_float)*mxGetPr(tmp)
+
+#define GET_SETTING_INT(field)                                                 \
+  tmp = mxGetField(settings_mex, 0, #field);                                   \
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp))                                      \
+  stgs->field = (scs_int)*mxGetPr(tmp)
+
+  GET_SETTING_FLOAT(alpha);
+  GET_SETTING_FLOAT(rho_x);
+  GET_SETTING_INT(max_iters);
+  GET_SETTING_FLOAT(scale);
+  GET_SETTING_FLOAT(eps_abs);
+  GET_SETTING_FLOAT(eps_rel);
+  GET_SETTING_FLOAT(eps_infeas);
+  GET_SETTING_INT(verbose);
+  GET_SETTING_INT(normalize);
+  GET_SETTING_INT(acceleration_lookback);
+  GET_SETTING_INT(acceleration_interval);
+  GET_SETTING_INT(adaptive_scale);
   GET_SETTING_FLOAT(time_limit_secs);
 
 #undef GET_SETTING_FLOAT
@@ -312,11 +2208,95 @@ static scs_int parse_settings(const mxArray *settings_mex,
     /* need to free this later */
     stgs->log_csv_filename = mxArrayToString(tmp);
   }
+}
+
+/* Parse settings struct into ScsSettings.
+ * Caller must free via free_mex(NULL, NULL, stgs). */
+static scs_int parse_settings(const mxArray *settings_mex,
+                              ScsSettings **stgs_out) {
+  ScsSettings *stgs;
+
+  stgs = (ScsSettings *)scs_malloc(sizeof(ScsSettings));
+  if (!stgs) {
+    return -1;
+  }
+  scs_set_default_settings(stgs);
+  set_settings(settings_mex, stgs);
 
   *stgs_out = stgs;
   return 0;
 }
 
+#ifdef MATLAB_LDL
+/* Options of the MATLAB-LDL backend that are not SCS settings. They are
+ * handed to the backend through scs_matlab_ldl_set_opts before scs_init.
+ * Out-of-range values are brought to the equivalent in-range ones, which
+ * is what a workspace file may hold. */
+static void parse_ldl_opts(const mxArray *settings_mex,
+                           ScsMatlabLdlOpts *opts) {
+  mxArray *tmp;
+
+  scs_matlab_ldl_default_opts(opts);
+  tmp = mxGetField(settings_mex, 0, "lin_sys_threads");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    opts->threads = MAX((scs_int)*mxGetPr(tmp), 0);
+  }
+  tmp = mxGetField(settings_mex, 0, "refactor_tol");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    opts->refactor_tol = MAX((scs_float)*mxGetPr(tmp), 0.0);
+  }
+  tmp = mxGetField(settings_mex, 0, "refine_steps");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    opts->refine_steps = MAX((scs_int)*mxGetPr(tmp), 0);
+  }
+  tmp = mxGetField(settings_mex, 0, "factor_single");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    opts->factor_single = *mxGetPr(tmp) != 0;
+  }
+}
+#endif
+
+#ifdef SUPERNODAL_LDL
+/* Options of the supernodal backend, handed to it through
+ * scs_supernodal_set_opts before scs_init. */
+static void set_supernodal_opts(const mxArray *settings_mex) {
+  ScsSupernodalOpts opts;
+  mxArray *tmp;
+
+  scs_supernodal_default_opts(&opts);
+  tmp = mxGetField(settings_mex, 0, "lin_sys_threads");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    opts.threads = (scs_int)*mxGetPr(tmp);
+  }
+  scs_supernodal_set_opts(&opts);
+}
+#endif
+
+#ifdef UNIFIED_LINSYS
+/* Select the backend named by the lin_sys_backend setting for the next
+ * scs_init, the MATLAB-LDL backend if it is not set. Returns an error
+ * message or SCS_NULL. */
+static const char *select_lin_sys(const mxArray *settings_mex) {
+  mxArray *tmp = mxGetField(settings_mex, 0, "lin_sys_backend");
+  scs_int id = SCS_LIN_SYS_MATLAB_LDL;
+  char *name;
+
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    name = mxIsChar(tmp) ? mxArrayToString(tmp) : SCS_NULL;
+    id = name ? scs_unified_find(name) : -1;
+    if (name) {
+      scs_free(name);
+    }
+    if (id < 0) {
+      return "Unknown lin_sys_backend. Use 'matlab_direct', 'direct', "
+             "'indirect', 'dense' or 'supernodal'.";
+    }
+  }
+  scs_unified_select(id);
+  return SCS_NULL;
+}
+#endif
+
 /* Parse cone struct into ScsCone.
  * Caller must free via free_mex(NULL, k, NULL). */
 static scs_int parse_cones(const mxArray *cone_mex, ScsCone **k_out) {
@@ -476,36 +2456,225 @@ static scs_int parse_cones(const mxArray *cone_mex, ScsCone **k_out) {
       }
     }
   }
-#endif
+#endif
+
+#undef GET_CONE_ARR
+
+  *k_out = k;
+  return 0;
+}
+
+/* ======================== Iteration trace ======================== */
+
+/* Opt-in record of the last iterations of a solve, returned as info.trace
+ * with one row per iteration and the columns
+ *   iter, res_pri, res_dual, gap, scale, accel_accepted, accel_rejected,
+ *   lin_sys_time, other_time
+ * (times in ms; the accel columns count AA steps taken in that iteration).
+ * Rows are written into a preallocated ring buffer from the linear system
+ * solve hook, which runs once per iteration, so tracing costs no I/O and
+ * no allocation in the loop. Needs the MATLAB-LDL backend; the residuals
+ * are read from the live ScsWork. */
+#define TRACE_COLS (9)
+
+typedef struct {
+  const ScsWork *w;
+  double *rows;        /* cap rows of TRACE_COLS, row n_rows % cap is next */
+  scs_int cap, n_rows; /* n_rows also counts overwritten rows */
+  scs_int last_iter;   /* iteration of the last row */
+  scs_int accepted, rejected; /* AA step counts at the last row */
+  scs_float lin_sys_time, other_time; /* of the iteration in progress */
+  SCS(timer) timer;    /* since the last solve */
+} ScsMexTrace;
+
+/* Iterations to trace from the trace_iters setting, 0 if not set. */
+static scs_int parse_trace_iters(const mxArray *settings_mex) {
+  mxArray *tmp = mxGetField(settings_mex, 0, "trace_iters");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp) && *mxGetPr(tmp) > 0) {
+    return (scs_int)*mxGetPr(tmp);
+  }
+  return 0;
+}
+
+#ifdef MATLAB_LDL
+static void trace_row(ScsMexTrace *tr) {
+  const ScsWork *w = tr->w;
+  double *row = &tr->rows[(tr->n_rows % tr->cap) * TRACE_COLS];
+
+  /* SCS resets the AA counters at the start of each solve */
+  if (w->accepted_accel_steps < tr->accepted ||
+      w->rejected_accel_steps < tr->rejected) {
+    tr->accepted = 0;
+    tr->rejected = 0;
+  }
+  row[0] = (double)w->r_orig->last_iter;
+  row[1] = (double)w->r_orig->res_pri;
+  row[2] = (double)w->r_orig->res_dual;
+  row[3] = (double)w->r_orig->gap;
+  row[4] = (double)w->scale;
+  row[5] = (double)(w->accepted_accel_steps - tr->accepted);
+  row[6] = (double)(w->rejected_accel_steps - tr->rejected);
+  row[7] = (double)tr->lin_sys_time;
+  row[8] = (double)tr->other_time;
+  tr->n_rows++;
+  tr->last_iter = w->r_orig->last_iter;
+  tr->accepted = w->accepted_accel_steps;
+  tr->rejected = w->rejected_accel_steps;
+}
+
+/* Solve hook. The KKT solve opens each iteration, so new residuals at this
+ * point close the previous iteration: the time since the last solve, minus
+ * this one, went to its cone projection, acceleration and residuals. */
+static void trace_hook(void *ctx, scs_float solve_time) {
+  ScsMexTrace *tr = (ScsMexTrace *)ctx;
+
+  tr->other_time += SCS(tocq)(&tr->timer) - solve_time;
+  if (tr->w->r_orig->last_iter != tr->last_iter) {
+    trace_row(tr);
+    tr->lin_sys_time = 0.0;
+    tr->other_time = 0.0;
+  }
+  tr->lin_sys_time += solve_time;
+  SCS(tic)(&tr->timer);
+}
+#endif
+
+/* Start tracing the next solve of w if iters > 0. Returns 0 (tr unused) if
+ * tracing is off, not supported by the backend or out of memory. */
+static scs_int trace_start(ScsMexTrace *tr, ScsWork *w, scs_int iters) {
+  memset(tr, 0, sizeof(ScsMexTrace));
+#ifdef MATLAB_LDL
+  if (iters <= 0 || !USE_MATLAB_LDL) {
+    return 0;
+  }
+  tr->rows = (double *)scs_calloc(iters * TRACE_COLS, sizeof(double));
+  if (!tr->rows) {
+    return 0;
+  }
+  tr->w = w;
+  tr->cap = iters;
+  tr->last_iter = w->r_orig->last_iter;
+  tr->accepted = w->accepted_accel_steps;
+  tr->rejected = w->rejected_accel_steps;
+  scs_matlab_ldl_set_solve_hook(LIN_SYS_WORK(w->p), trace_hook, tr);
+  SCS(tic)(&tr->timer);
+  return 1;
+#else
+  (void)w;
+  (void)iters;
+  return 0;
+#endif
+}
+
+/* Stop tracing after the solve and record its last iteration. */
+static void trace_stop(ScsMexTrace *tr) {
+#ifdef MATLAB_LDL
+  if (!tr->rows) {
+    return;
+  }
+  scs_matlab_ldl_set_solve_hook(LIN_SYS_WORK(tr->w->p), SCS_NULL,
+                                SCS_NULL);
+  tr->other_time += SCS(tocq)(&tr->timer);
+  if (tr->w->r_orig->last_iter != tr->last_iter) {
+    trace_row(tr);
+  }
+#else
+  (void)tr;
+#endif
+}
+
+/* The kept rows, oldest first, as a MATLAB matrix; frees the buffer. */
+static mxArray *trace_matrix(ScsMexTrace *tr) {
+  scs_int n = tr->n_rows < tr->cap ? tr->n_rows : tr->cap;
+  scs_int first = tr->n_rows - n, i, j;
+  mxArray *out = mxCreateDoubleMatrix(n, TRACE_COLS, mxREAL);
+  double *pr = mxGetPr(out);
+
+  for (i = 0; i < n; i++) {
+    const double *row = &tr->rows[((first + i) % tr->cap) * TRACE_COLS];
+    for (j = 0; j < TRACE_COLS; j++) {
+      pr[i + j * n] = row[j];
+    }
+  }
+  scs_free(tr->rows);
+  tr->rows = SCS_NULL;
+  return out;
+}
 
-#undef GET_CONE_ARR
+/* Work done so far by the linear system backend of a workspace */
+typedef struct {
+  double factorizations; /* numeric factorizations of the KKT system */
+  double factor_time;    /* ms spent in them */
+  double solves;         /* solves with the KKT system */
+} ScsMexLinSysCounts;
 
-  *k_out = k;
-  return 0;
+/* Counts of w's backend, NaN if w is NULL or the backend does not expose
+ * them. */
+static void lin_sys_counts(const ScsWork *w, ScsMexLinSysCounts *c) {
+#ifdef MATLAB_LDL
+  if (w && USE_MATLAB_LDL) {
+    ScsMatlabLdlStats st;
+    scs_matlab_ldl_get_stats(LIN_SYS_WORK(w->p), &st);
+    c->factorizations = (double)st.factorizations;
+    c->factor_time = (double)st.factor_time;
+    c->solves = (double)st.solves;
+    return;
+  }
+#endif
+#ifdef SUPERNODAL_LDL
+  if (w && USE_SUPERNODAL) {
+    ScsSupernodalStats st;
+    scs_supernodal_get_stats(LIN_SYS_WORK(w->p), &st);
+    c->factorizations = (double)st.factorizations;
+    c->factor_time = (double)st.factor_time;
+    c->solves = (double)st.solves;
+    return;
+  }
+#endif
+  (void)w;
+  c->factorizations = mxGetNaN();
+  c->factor_time = mxGetNaN();
+  c->solves = mxGetNaN();
 }
 
-/* Write ScsInfo to a MATLAB struct and assign to plhs[3] */
-static void write_info(mxArray **plhs3, const ScsInfo *info) {
-  const mwSize one[1] = {1};
-  const int num_info_fields = 22;
+/* Replace the counts c taken earlier with the work done since then. */
+static void lin_sys_counts_since(const ScsWork *w, ScsMexLinSysCounts *c) {
+  ScsMexLinSysCounts now;
+  lin_sys_counts(w, &now);
+  c->factorizations = now.factorizations - c->factorizations;
+  c->factor_time = now.factor_time - c->factor_time;
+  c->solves = now.solves - c->solves;
+}
+
+/* Create a 1 x len struct array with the info field names. */
+static mxArray *create_info_struct(mwSize len) {
+  const mwSize dims[2] = {1, len};
+  const int num_info_fields = 25;
   const char *info_fields[] = {
       "iter",       "status",         "pobj",          "dobj",
       "res_pri",    "res_dual",       "res_infeas",    "res_unbdd_a",
       "scale",      "status_val",     "res_unbdd_p",   "gap",
       "setup_time", "solve_time",     "scale_updates", "comp_slack",
       "lin_sys_solver", "rejected_accel_steps", "accepted_accel_steps",
-      "lin_sys_time",   "cone_time",            "accel_time"};
-  mxArray *tmp;
+      "lin_sys_time",   "cone_time",            "accel_time",
+      "factorizations", "factor_time",          "lin_sys_solves"};
+
+  return mxCreateStructArray(2, dims, num_info_fields, info_fields);
+}
 
-  *plhs3 = mxCreateStructArray(1, one, num_info_fields, info_fields);
+/* Write ScsInfo into element idx of a struct from create_info_struct.
+ * counts is the linear system work behind this solve. */
+static void set_info(mxArray *out, mwIndex idx, const ScsInfo *info,
+                     const ScsMexLinSysCounts *counts) {
+  mxArray *tmp;
 
-  mxSetField(*plhs3, 0, "status", mxCreateString(info->status));
-  mxSetField(*plhs3, 0, "lin_sys_solver", mxCreateString(info->lin_sys_solver));
+  mxSetField(out, idx, "status", mxCreateString(info->status));
+  mxSetField(out, idx, "lin_sys_solver", mxCreateString(info->lin_sys_solver));
 
 #define SET_INFO_FIELD(field)                                                  \
   tmp = mxCreateDoubleMatrix(1, 1, mxREAL);                                    \
   *mxGetPr(tmp) = (double)info->field;                                         \
-  mxSetField(*plhs3, 0, #field, tmp)
+  mxSetField(out, idx, #field, tmp)
 
   SET_INFO_FIELD(iter);
   SET_INFO_FIELD(scale_updates);
@@ -529,6 +2698,811 @@ static void write_info(mxArray **plhs3, const ScsInfo *info) {
   SET_INFO_FIELD(accel_time);
 
 #undef SET_INFO_FIELD
+
+  mxSetField(out, idx, "factorizations",
+             mxCreateDoubleScalar(counts->factorizations));
+  mxSetField(out, idx, "factor_time",
+             mxCreateDoubleScalar(counts->factor_time));
+  mxSetField(out, idx, "lin_sys_solves", mxCreateDoubleScalar(counts->solves));
+}
+
+/* Write ScsInfo to a MATLAB struct and assign to plhs[3]. With a trace
+ * (trace_start returned 1), its rows are added as info.trace. */
+static void write_info(mxArray **plhs3, const ScsInfo *info,
+                       const ScsMexLinSysCounts *counts,
+                       ScsMexTrace *trace) {
+  *plhs3 = create_info_struct(1);
+  set_info(*plhs3, 0, info, counts);
+  if (trace && trace->rows) {
+    mxAddField(*plhs3, "trace");
+    mxSetField(*plhs3, 0, "trace", trace_matrix(trace));
+  }
+}
+
+/* Fill sol (n, m) and info as scs() does when scs_init fails, so that a
+ * failed init is reported without initializing a second time. */
+static void init_failure(ScsSolution *sol, ScsInfo *info, scs_int n,
+                         scs_int m) {
+  scs_float nan = (scs_float)mxGetNaN();
+  scs_int i;
+  memset(info, 0, sizeof(ScsInfo));
+  info->iter = -1;
+  info->status_val = SCS_FAILED;
+  strcpy(info->status, "failure");
+  info->pobj = nan;
+  info->dobj = nan;
+  info->res_pri = nan;
+  info->res_dual = nan;
+  info->gap = nan;
+  for (i = 0; i < n; i++) {
+    sol->x[i] = nan;
+  }
+  for (i = 0; i < m; i++) {
+    sol->y[i] = nan;
+    sol->s[i] = nan;
+  }
+}
+
+/* [x,y,s,info] for one solve of d, k, stgs from scratch. Warm-start
+ * vectors x, y, s are taken from data_mex if given, and x, y, s are single
+ * if its b is; settings_mex holds the backend and presolve options. Returns
+ * an error message, or SCS_NULL on success. The caller keeps ownership of
+ * d, k and stgs. */
+static const char *solve_one_shot(mxArray *plhs[], const ScsData *d,
+                                  const ScsCone *k, ScsSettings *stgs,
+                                  const mxArray *data_mex,
+                                  const mxArray *settings_mex) {
+  ScsSolution sol = {0}, red = {0};
+  ScsSolution *solver_sol = &sol;
+  ScsInfo info;
+  ScsMexTrace trace = {0};
+  ScsMexLinSysCounts counts;
+  ScsMexPresolve *pre = SCS_NULL;
+  ScsData *dr = SCS_NULL;
+  ScsCone *kr = SCS_NULL;
+  scs_int n = d->n, m = d->m;
+  scs_int single = data_mex && mxIsSingle(mxGetField(data_mex, 0, "b"));
+#ifdef MATLAB_LDL
+  ScsMatlabLdlOpts ldl_opts;
+#endif
+#if defined(MATLAB_LDL) || defined(SUPERNODAL_LDL)
+  ScsWork *w;
+#endif
+#ifdef UNIFIED_LINSYS
+  const char *err = select_lin_sys(settings_mex);
+
+  if (err) {
+    return err;
+  }
+#endif
+
+  /* SCS writes the solution straight into the outputs */
+  sol.x = create_output_field(&plhs[0], n, single);
+  sol.y = create_output_field(&plhs[1], m, single);
+  sol.s = create_output_field(&plhs[2], m, single);
+  if (!sol.x || !sol.y || !sol.s) {
+    free_output_field(plhs[0], sol.x);
+    free_output_field(plhs[1], sol.y);
+    free_output_field(plhs[2], sol.s);
+    return "Memory allocation failed for solution vectors.";
+  }
+
+  /* warm-start */
+  if (data_mex) {
+    stgs->warm_start =
+        parse_warm_start(mxGetField(data_mex, 0, "x"), sol.x, n);
+    stgs->warm_start |=
+        parse_warm_start(mxGetField(data_mex, 0, "y"), sol.y, m);
+    stgs->warm_start |=
+        parse_warm_start(mxGetField(data_mex, 0, "s"), sol.s, m);
+  }
+
+  /* with presolve SCS solves the reduced problem into its own buffers */
+  if (parse_presolve(settings_mex)) {
+    pre = presolve_new(d, k, &dr, &kr);
+    if (!pre || presolve_alloc_sol(pre, &red) < 0) {
+      presolve_free_sol(&red);
+      presolve_free(pre);
+      free_data_copy(dr);
+      free_mex(SCS_NULL, kr, SCS_NULL);
+      free_output_field(plhs[0], sol.x);
+      free_output_field(plhs[1], sol.y);
+      free_output_field(plhs[2], sol.s);
+      return "Memory allocation failed for presolve.";
+    }
+    if (stgs->warm_start) {
+      presolve_warm(pre, &sol, &red);
+    }
+    d = dr;
+    k = kr;
+    solver_sol = &red;
+  }
+
+#if defined(MATLAB_LDL) || defined(SUPERNODAL_LDL)
+#ifdef MATLAB_LDL
+  if (USE_MATLAB_LDL) {
+    parse_ldl_opts(settings_mex, &ldl_opts);
+    scs_matlab_ldl_set_opts(&ldl_opts);
+  }
+#endif
+#ifdef SUPERNODAL_LDL
+  if (USE_SUPERNODAL) {
+    set_supernodal_opts(settings_mex);
+  }
+#endif
+  /* scs() without discarding the workspace, to read its factorization
+   * count */
+  w = scs_init(d, k, stgs);
+  if (w) {
+    trace_start(&trace, w, parse_trace_iters(settings_mex));
+    scs_solve(w, solver_sol, &info, stgs->warm_start);
+    trace_stop(&trace);
+    lin_sys_counts(w, &counts);
+    scs_finish(w);
+  } else {
+    lin_sys_counts(SCS_NULL, &counts);
+    init_failure(solver_sol, &info, d->n, d->m);
+  }
+#else
+  lin_sys_counts(SCS_NULL, &counts);
+  scs(d, k, stgs, solver_sol, &info);
+#endif
+  if (pre) {
+    postsolve(pre, &red, &sol, &info);
+  }
+
+  finish_output_field(plhs[0], sol.x, n);
+  finish_output_field(plhs[1], sol.y, m);
+  finish_output_field(plhs[2], sol.s, m);
+  write_info(&plhs[3], &info, &counts, &trace);
+  if (pre) {
+    presolve_add_info(plhs[3], pre);
+    presolve_free_sol(&red);
+    presolve_free(pre);
+    free_data_copy(dr);
+    free_mex(SCS_NULL, kr, SCS_NULL);
+  }
+  return SCS_NULL;
+}
+
+/* Initialize a new workspace slot for d, k, stgs, which are copied; the
+ * caller keeps ownership. settings_mex holds the backend and presolve
+ * options; with presolve the slot keeps the reduced problem. Returns an
+ * error message, or SCS_NULL on success. */
+static const char *ws_init(ScsMexWorkspace **slot_out, const ScsData *d,
+                           const ScsCone *k, const ScsSettings *stgs,
+                           const mxArray *settings_mex) {
+  ScsMexWorkspace *slot;
+  ScsWork *work;
+  ScsMexPresolve *pre = SCS_NULL;
+  ScsData *dr = SCS_NULL;
+  ScsCone *kr = SCS_NULL;
+#ifdef MATLAB_LDL
+  ScsMatlabLdlOpts ldl_opts;
+#endif
+#ifdef UNIFIED_LINSYS
+  const char *err = select_lin_sys(settings_mex);
+
+  if (err) {
+    return err;
+  }
+#endif
+#ifdef MATLAB_LDL
+  parse_ldl_opts(settings_mex, &ldl_opts);
+  if (USE_MATLAB_LDL) {
+    scs_matlab_ldl_set_opts(&ldl_opts);
+  }
+#endif
+#ifdef SUPERNODAL_LDL
+  if (USE_SUPERNODAL) {
+    set_supernodal_opts(settings_mex);
+  }
+#endif
+  if (parse_presolve(settings_mex)) {
+    pre = presolve_new(d, k, &dr, &kr);
+    if (!pre) {
+      return "Memory allocation failed for presolve.";
+    }
+    d = dr;
+    k = kr;
+  }
+  work = scs_init(d, k, stgs);
+  if (!work) {
+    presolve_free(pre);
+    free_data_copy(dr);
+    free_mex(SCS_NULL, kr, SCS_NULL);
+    return "SCS init failed.";
+  }
+  slot = ws_alloc_slot();
+  if (!slot) {
+    scs_finish(work);
+    presolve_free(pre);
+    free_data_copy(dr);
+    free_mex(SCS_NULL, kr, SCS_NULL);
+    return "Memory allocation failed for workspace table.";
+  }
+  slot->work = work;
+  slot->pre = pre;
+  slot->n = d->n;
+  slot->m = d->m;
+  slot->trace_iters = parse_trace_iters(settings_mex);
+#ifdef MATLAB_LDL
+  slot->ldl_opts = ldl_opts;
+#endif
+#ifdef UNIFIED_LINSYS
+  slot->lin_sys = scs_unified_selected();
+#endif
+  slot->d = pre ? dr : copy_data(d);
+  slot->k = pre ? kr : copy_cone(k);
+  slot->stgs = copy_settings(stgs);
+  if (!slot->d || !slot->k || !slot->stgs) {
+    ws_release(slot);
+    return "Memory allocation failed for workspace data.";
+  }
+  slot->handle = ws_next_handle++;
+  mexAtExit(ws_cleanup);
+  *slot_out = slot;
+  return SCS_NULL;
+}
+
+/* Bytes of a CSC matrix, 0 for NULL. */
+static double matrix_bytes(const ScsMatrix *M) {
+  if (!M) {
+    return 0.0;
+  }
+  return (double)(M->n + 1) * sizeof(scs_int) +
+         (double)M->p[M->n] * (sizeof(scs_int) + sizeof(scs_float));
+}
+
+/* Rough bytes SCS itself holds in a workspace for d besides the linear
+ * system: its scaled copy of the data, about 14 iterate-sized vectors and
+ * the Anderson acceleration memory. */
+static double solver_bytes(const ScsData *d, const ScsSettings *stgs) {
+  double len = (double)(d->n + d->m + 1);
+  double lb = (double)ABS(stgs->acceleration_lookback);
+  return matrix_bytes(d->A) + matrix_bytes(d->P) +
+         (double)(d->n + d->m) * sizeof(scs_float) +
+         (14.0 * len + 3.0 * lb * len + 2.0 * lb * lb) * sizeof(scs_float);
+}
+
+/* Bytes of w's linear system workspace by component (see
+ * ScsMatlabLdlStats), NaN if the backend does not expose them. */
+static void lin_sys_bytes(const ScsWork *w, double bytes[4]) {
+#ifdef MATLAB_LDL
+  if (USE_MATLAB_LDL) {
+    ScsMatlabLdlStats st;
+    scs_matlab_ldl_get_stats(LIN_SYS_WORK(w->p), &st);
+    bytes[0] = (double)st.kkt_bytes;
+    bytes[1] = (double)st.factor_bytes;
+    bytes[2] = (double)st.symbolic_bytes;
+    bytes[3] = (double)st.solve_bytes;
+    return;
+  }
+#endif
+#ifdef SUPERNODAL_LDL
+  if (USE_SUPERNODAL) {
+    ScsSupernodalStats st;
+    scs_supernodal_get_stats(LIN_SYS_WORK(w->p), &st);
+    bytes[0] = (double)st.kkt_bytes;
+    bytes[1] = (double)st.factor_bytes;
+    bytes[2] = (double)st.symbolic_bytes;
+    bytes[3] = (double)st.solve_bytes;
+    return;
+  }
+#endif
+  (void)w;
+  bytes[0] = bytes[1] = bytes[2] = bytes[3] = mxGetNaN();
+}
+
+/* 'stats' struct of a workspace: size of the KKT system and its factor, the
+ * factorization and solve work done so far and the bytes held. Backend
+ * figures are NaN for backends other than MATLAB-LDL. */
+static mxArray *ws_stats(const ScsMexWorkspace *slot) {
+  const char *fields[] = {"m",            "n",
+                          "lin_sys_solver", "kkt_nnz",
+                          "L_nnz",        "fill_ratio",
+                          "factorizations", "ldl_calls",
+                          "factor_time",  "solves",
+                          "solve_time",   "refine_steps",
+                          "batch_workspaces", "bytes"};
+  const char *byte_fields[] = {"data",  "kkt",    "factor", "symbolic",
+                               "solve", "solver", "batch",  "file",
+                               "total"};
+  double nan = mxGetNaN();
+  double kkt_nnz = nan, L_nnz = nan, factorizations = nan, ldl_calls = nan;
+  double factor_time = nan, solves = nan, solve_time = nan, refine = nan;
+  double ls[4], data, solver, batch = 0.0;
+  mxArray *out = mxCreateStructMatrix(1, 1, 14, fields);
+  mxArray *bytes = mxCreateStructMatrix(1, 1, 9, byte_fields);
+  scs_int i;
+
+#ifdef MATLAB_LDL
+  if (USE_MATLAB_LDL) {
+    ScsMatlabLdlStats st;
+
+    scs_matlab_ldl_get_stats(LIN_SYS_WORK(slot->work->p), &st);
+    kkt_nnz = (double)st.kkt_nnz;
+    L_nnz = (double)st.L_nnz;
+    factorizations = (double)st.factorizations;
+    ldl_calls = (double)st.ldl_calls;
+    factor_time = (double)st.factor_time;
+    solves = (double)st.solves;
+    solve_time = (double)st.solve_time;
+    refine = (double)st.refine_steps;
+  }
+#endif
+#ifdef SUPERNODAL_LDL
+  if (USE_SUPERNODAL) {
+    ScsSupernodalStats st;
+
+    scs_supernodal_get_stats(LIN_SYS_WORK(slot->work->p), &st);
+    kkt_nnz = (double)st.kkt_nnz;
+    L_nnz = (double)st.L_nnz;
+    factorizations = (double)st.factorizations;
+    factor_time = (double)st.factor_time;
+    solves = (double)st.solves;
+    solve_time = (double)st.solve_time;
+  }
+#endif
+
+  mxSetField(out, 0, "m", mxCreateDoubleScalar((double)slot->m));
+  mxSetField(out, 0, "n", mxCreateDoubleScalar((double)slot->n));
+  mxSetField(out, 0, "lin_sys_solver",
+             mxCreateString(scs_get_lin_sys_method()));
+  mxSetField(out, 0, "kkt_nnz", mxCreateDoubleScalar(kkt_nnz));
+  mxSetField(out, 0, "L_nnz", mxCreateDoubleScalar(L_nnz));
+  /* nnz of L with its unit diagonal over nnz of the KKT upper triangle */
+  mxSetField(out, 0, "fill_ratio",
+             mxCreateDoubleScalar((L_nnz + slot->n + slot->m) / kkt_nnz));
+  mxSetField(out, 0, "factorizations", mxCreateDoubleScalar(factorizations));
+  mxSetField(out, 0, "ldl_calls", mxCreateDoubleScalar(ldl_calls));
+  mxSetField(out, 0, "factor_time", mxCreateDoubleScalar(factor_time));
+  mxSetField(out, 0, "solves", mxCreateDoubleScalar(solves));
+  mxSetField(out, 0, "solve_time", mxCreateDoubleScalar(solve_time));
+  mxSetField(out, 0, "refine_steps", mxCreateDoubleScalar(refine));
+  mxSetField(out, 0, "batch_workspaces",
+             mxCreateDoubleScalar((double)slot->n_clones));
+
+  data = matrix_bytes(slot->d->A) + matrix_bytes(slot->d->P) +
+         (double)(slot->n + slot->m) * sizeof(scs_float);
+  solver = solver_bytes(slot->d, slot->stgs);
+  for (i = 0; i < slot->n_clones; i++) {
+    double cl[4];
+    lin_sys_bytes(slot->clones[i], cl);
+    batch += cl[0] + cl[1] + cl[2] + cl[3] + solver;
+  }
+  lin_sys_bytes(slot->work, ls);
+  mxSetField(bytes, 0, "data", mxCreateDoubleScalar(data));
+  mxSetField(bytes, 0, "kkt", mxCreateDoubleScalar(ls[0]));
+  mxSetField(bytes, 0, "factor", mxCreateDoubleScalar(ls[1]));
+  mxSetField(bytes, 0, "symbolic", mxCreateDoubleScalar(ls[2]));
+  mxSetField(bytes, 0, "solve", mxCreateDoubleScalar(ls[3]));
+  mxSetField(bytes, 0, "solver", mxCreateDoubleScalar(solver));
+  mxSetField(bytes, 0, "batch", mxCreateDoubleScalar(batch));
+  /* mapped from a workspace file, shared between processes */
+  mxSetField(bytes, 0, "file", mxCreateDoubleScalar((double)slot->file_len));
+  mxSetField(bytes, 0, "total",
+             mxCreateDoubleScalar(data + ls[0] + ls[1] + ls[2] + ls[3] +
+                                  solver + batch));
+  mxSetField(out, 0, "bytes", bytes);
+  return out;
+}
+
+/* ======================== One-shot setup cache ======================== */
+/* With settings.cache_bytes > 0 a one-shot solve keeps its workspace in a
+ * cache, and a later call with the same A, P, cones and setup settings
+ * (ScsMexCacheOpts) reuses it. Only b and c are passed through scs_update,
+ * so there is no new equilibration, KKT formation or factorization. A hash
+ * of the key picks the candidate entry and the key is then compared in
+ * full, so a collision costs a miss, never a wrong answer. When an entry is
+ * added, the least recently used ones are evicted until the estimated
+ * bytes of all entries (cache_entry_bytes) fit in cache_bytes. */
+
+/* Settings and backend options that enter the setup; the other settings
+ * only steer the iterations and are taken from each call. Zeroed before it
+ * is filled, as it is hashed and compared as raw bytes. */
+typedef struct {
+  scs_int m, n;
+  scs_int normalize, acceleration_lookback;
+  scs_float scale, rho_x;
+  scs_int lin_sys;         /* SCS_LIN_SYS_* in the unified build, else 0 */
+  scs_int lin_sys_threads; /* supernodal backend */
+#ifdef MATLAB_LDL
+  ScsMatlabLdlOpts ldl_opts;
+#endif
+} ScsMexCacheOpts;
+
+typedef struct {
+  uint64_T last_used; /* LRU clock, 0 marks a free entry */
+  uint64_T key;       /* cache_hash of the fields below */
+  ScsWork *work;
+  ScsData *d; /* A and P as at setup */
+  ScsCone *k;
+  ScsCone kimg; /* k with its array pointers cleared */
+  ScsMexCacheOpts opts;
+  double bytes;
+} ScsMexCacheEntry;
+
+static ScsMexCacheEntry *cache_table = SCS_NULL;
+static scs_int cache_len = 0;
+static uint64_T cache_clock = 0;
+static double cache_used = 0.0; /* bytes of all entries */
+static double cache_hits = 0.0, cache_misses = 0.0;
+
+/* Settings that switch the cache on or that it cannot honour. cache_bytes
+ * is the bound, 0 if the cache is not used. */
+static double parse_cache_bytes(const mxArray *settings_mex,
+                                const ScsSettings *stgs) {
+  mxArray *tmp = mxGetField(settings_mex, 0, "cache_bytes");
+  if (tmp == SCS_NULL || mxIsEmpty(tmp) || !mxIsNumeric(tmp) ||
+      *mxGetPr(tmp) <= 0) {
+    return 0.0;
+  }
+  /* file outputs are written by scs_init and would be skipped on a hit;
+   * presolved problems go through solve_one_shot */
+  if (stgs->write_data_filename || stgs->log_csv_filename ||
+      parse_presolve(settings_mex)) {
+    return 0.0;
+  }
+  return *mxGetPr(tmp);
+}
+
+static void cache_opts(const ScsData *d, const ScsSettings *stgs,
+                       const mxArray *settings_mex, ScsMexCacheOpts *o) {
+  mxArray *tmp;
+
+  memset(o, 0, sizeof(ScsMexCacheOpts));
+  o->m = d->m;
+  o->n = d->n;
+  o->normalize = stgs->normalize;
+  o->acceleration_lookback = stgs->acceleration_lookback;
+  o->scale = stgs->scale;
+  o->rho_x = stgs->rho_x;
+#ifdef UNIFIED_LINSYS
+  o->lin_sys = scs_unified_selected();
+#endif
+  tmp = mxGetField(settings_mex, 0, "lin_sys_threads");
+  if (tmp != SCS_NULL && !mxIsEmpty(tmp)) {
+    o->lin_sys_threads = (scs_int)*mxGetPr(tmp);
+  }
+#ifdef MATLAB_LDL
+  parse_ldl_opts(settings_mex, &o->ldl_opts);
+#endif
+}
+
+static void cone_image(const ScsCone *k, ScsCone *kimg) {
+  memcpy(kimg, k, sizeof(ScsCone));
+#define CLEAR_CONE_ARR(field, len, type) kimg->field = SCS_NULL;
+  CONE_ARRAYS(CLEAR_CONE_ARR)
+#undef CLEAR_CONE_ARR
+}
+
+static uint64_T hash_matrix(uint64_T h, const ScsMatrix *M) {
+  if (!M) {
+    return hash_bytes(h, "-", 1);
+  }
+  h = hash_bytes(h, M->p, (M->n + 1) * sizeof(scs_int));
+  h = hash_bytes(h, M->i, M->p[M->n] * sizeof(scs_int));
+  return hash_bytes(h, M->x, M->p[M->n] * sizeof(scs_float));
+}
+
+static uint64_T cache_hash(const ScsData *d, const ScsCone *k,
+                           const ScsCone *kimg, const ScsMexCacheOpts *o) {
+  uint64_T h = 0xcbf29ce484222325ULL;
+  h = hash_bytes(h, o, sizeof(ScsMexCacheOpts));
+  h = hash_matrix(h, d->A);
+  h = hash_matrix(h, d->P);
+  h = hash_bytes(h, kimg, sizeof(ScsCone));
+#define HASH_CONE_ARR(field, len, type)                                        \
+  if (k->field) {                                                              \
+    h = hash_bytes(h, k->field, (len) * sizeof(type));                         \
+  }
+  CONE_ARRAYS(HASH_CONE_ARR)
+#undef HASH_CONE_ARR
+  return h;
+}
+
+static scs_int matrix_equal(const ScsMatrix *X, const ScsMatrix *Y) {
+  if (!X || !Y) {
+    return X == Y;
+  }
+  return X->m == Y->m && X->n == Y->n &&
+         memcmp(X->p, Y->p, (X->n + 1) * sizeof(scs_int)) == 0 &&
+         memcmp(X->i, Y->i, X->p[X->n] * sizeof(scs_int)) == 0 &&
+         memcmp(X->x, Y->x, X->p[X->n] * sizeof(scs_float)) == 0;
+}
+
+/* Entry for exactly this problem, or NULL */
+static ScsMexCacheEntry *cache_find(uint64_T key, const ScsData *d,
+                                    const ScsCone *k, const ScsCone *kimg,
+                                    const ScsMexCacheOpts *o) {
+  scs_int i, same;
+  for (i = 0; i < cache_len; i++) {
+    ScsMexCacheEntry *e = &cache_table[i];
+    if (!e->last_used || e->key != key ||
+        memcmp(&e->opts, o, sizeof(ScsMexCacheOpts)) != 0 ||
+        memcmp(&e->kimg, kimg, sizeof(ScsCone)) != 0 ||
+        !matrix_equal(e->d->A, d->A) || !matrix_equal(e->d->P, d->P)) {
+      continue;
+    }
+    same = 1;
+#define SAME_CONE_ARR(field, len, type)                                        \
+  if ((len) > 0) {                                                             \
+    same = same && memcmp(e->k->field, k->field, (len) * sizeof(type)) == 0;   \
+  }
+    CONE_ARRAYS(SAME_CONE_ARR)
+#undef SAME_CONE_ARR
+    if (same) {
+      return e;
+    }
+  }
+  return SCS_NULL;
+}
+
+/* Estimated bytes of an entry: its problem copy, the SCS workspace and the
+ * linear system. Backends without memory figures are counted as a KKT
+ * matrix and a factor of the same size. */
+static double cache_entry_bytes(const ScsMexCacheEntry *e) {
+  double ls[4];
+  double data = matrix_bytes(e->d->A) + matrix_bytes(e->d->P) +
+                (double)(e->d->n + e->d->m) * sizeof(scs_float);
+  lin_sys_bytes(e->work, ls);
+  if (ls[0] != ls[0]) { /* NaN */
+    ls[0] = ls[1] = data;
+    ls[2] = ls[3] = 0.0;
+  }
+  return data + solver_bytes(e->d, e->work->stgs) + ls[0] + ls[1] + ls[2] +
+         ls[3];
+}
+
+static void cache_evict(ScsMexCacheEntry *e) {
+  scs_finish(e->work);
+  free_data_copy(e->d);
+  free_mex(SCS_NULL, e->k, SCS_NULL);
+  cache_used -= e->bytes;
+  memset(e, 0, sizeof(ScsMexCacheEntry));
+}
+
+static void cache_clear(void) {
+  scs_int i;
+  for (i = 0; i < cache_len; i++) {
+    if (cache_table[i].last_used) {
+      cache_evict(&cache_table[i]);
+    }
+  }
+  if (cache_table) {
+    scs_free(cache_table);
+    cache_table = SCS_NULL;
+  }
+  cache_len = 0;
+  cache_used = 0.0;
+}
+
+/* Evict least recently used entries until at most limit bytes are held. */
+static void cache_trim(double limit) {
+  scs_int i;
+  ScsMexCacheEntry *lru;
+  while (cache_used > limit) {
+    lru = SCS_NULL;
+    for (i = 0; i < cache_len; i++) {
+      if (cache_table[i].last_used &&
+          (!lru || cache_table[i].last_used < lru->last_used)) {
+        lru = &cache_table[i];
+      }
+    }
+    if (!lru) {
+      break;
+    }
+    cache_evict(lru);
+  }
+}
+
+/* Hand w, set up from d, k and o, to the cache, which copies d and k. w
+ * is finished instead if it does not fit in limit bytes or memory runs
+ * out. */
+static void cache_insert(ScsWork *w, uint64_T key, const ScsData *d,
+                         const ScsCone *k, const ScsCone *kimg,
+                         const ScsMexCacheOpts *o, double limit) {
+  ScsMexCacheEntry e, *slot = SCS_NULL, *new_table;
+  scs_int i, new_len;
+
+  memset(&e, 0, sizeof(ScsMexCacheEntry));
+  e.key = key;
+  e.work = w;
+  e.kimg = *kimg;
+  e.opts = *o;
+  e.d = copy_data(d);
+  e.k = copy_cone(k);
+  if (!e.d || !e.k) {
+    free_data_copy(e.d);
+    free_mex(SCS_NULL, e.k, SCS_NULL);
+    scs_finish(w);
+    return;
+  }
+  e.bytes = cache_entry_bytes(&e);
+  if (e.bytes > limit) {
+    free_data_copy(e.d);
+    free_mex(SCS_NULL, e.k, SCS_NULL);
+    scs_finish(w);
+    return;
+  }
+  cache_trim(limit - e.bytes);
+
+  for (i = 0; i < cache_len && !slot; i++) {
+    if (!cache_table[i].last_used) {
+      slot = &cache_table[i];
+    }
+  }
+  if (!slot) {
+    new_len = cache_len > 0 ? 2 * cache_len : 8;
+    new_table =
+        (ScsMexCacheEntry *)scs_calloc(new_len, sizeof(ScsMexCacheEntry));
+    if (!new_table) {
+      free_data_copy(e.d);
+      free_mex(SCS_NULL, e.k, SCS_NULL);
+      scs_finish(w);
+      return;
+    }
+    if (cache_table) {
+      memcpy(new_table, cache_table, cache_len * sizeof(ScsMexCacheEntry));
+      scs_free(cache_table);
+    }
+    cache_table = new_table;
+    slot = &cache_table[cache_len];
+    cache_len = new_len;
+  }
+  e.last_used = ++cache_clock;
+  *slot = e;
+  cache_used += e.bytes;
+  mexAtExit(ws_cleanup);
+}
+
+/* 'cache' struct: entries held, their estimated bytes and the hits and
+ * misses of cached one-shot solves since the last 'cache_clear'. */
+static mxArray *cache_stats(void) {
+  const char *fields[] = {"entries", "bytes", "hits", "misses"};
+  mxArray *out = mxCreateStructMatrix(1, 1, 4, fields);
+  scs_int i, entries = 0;
+  for (i = 0; i < cache_len; i++) {
+    entries += cache_table[i].last_used != 0;
+  }
+  mxSetField(out, 0, "entries", mxCreateDoubleScalar((double)entries));
+  mxSetField(out, 0, "bytes", mxCreateDoubleScalar(cache_used));
+  mxSetField(out, 0, "hits", mxCreateDoubleScalar(cache_hits));
+  mxSetField(out, 0, "misses", mxCreateDoubleScalar(cache_misses));
+  return out;
+}
+
+/* As solve_one_shot, through the cache bounded by limit bytes. info also
+ * gets cache_hit (this call) and the running cache_hits and
+ * cache_misses. */
+static const char *solve_cached(mxArray *plhs[], const ScsData *d,
+                                const ScsCone *k, ScsSettings *stgs,
+                                const mxArray *data_mex,
+                                const mxArray *settings_mex, double limit) {
+  ScsSolution sol = {0};
+  ScsInfo info;
+  ScsMexTrace trace = {0};
+  ScsMexLinSysCounts counts;
+  ScsMexCacheOpts opts;
+  ScsMexCacheEntry *e;
+  ScsCone kimg;
+  ScsWork *w;
+  uint64_T key;
+  scs_int single = mxIsSingle(mxGetField(data_mex, 0, "b"));
+#ifdef UNIFIED_LINSYS
+  const char *err = select_lin_sys(settings_mex);
+
+  if (err) {
+    return err;
+  }
+#endif
+
+  cache_opts(d, stgs, settings_mex, &opts);
+  cone_image(k, &kimg);
+  key = cache_hash(d, k, &kimg, &opts);
+  e = cache_find(key, d, k, &kimg, &opts);
+
+  sol.x = create_output_field(&plhs[0], d->n, single);
+  sol.y = create_output_field(&plhs[1], d->m, single);
+  sol.s = create_output_field(&plhs[2], d->m, single);
+  if (!sol.x || !sol.y || !sol.s) {
+    free_output_field(plhs[0], sol.x);
+    free_output_field(plhs[1], sol.y);
+    free_output_field(plhs[2], sol.s);
+    return "Memory allocation failed for solution vectors.";
+  }
+  stgs->warm_start =
+      parse_warm_start(mxGetField(data_mex, 0, "x"), sol.x, d->n);
+  stgs->warm_start |=
+      parse_warm_start(mxGetField(data_mex, 0, "y"), sol.y, d->m);
+  stgs->warm_start |=
+      parse_warm_start(mxGetField(data_mex, 0, "s"), sol.s, d->m);
+
+  if (e) {
+    cache_hits++;
+    e->last_used = ++cache_clock;
+    w = e->work;
+    /* the setup settings match, the rest are this call's */
+    *w->stgs = *stgs;
+    lin_sys_counts(w, &counts);
+    scs_update(w, d->b, d->c);
+    trace_start(&trace, w, parse_trace_iters(settings_mex));
+    scs_solve(w, &sol, &info, stgs->warm_start);
+    trace_stop(&trace);
+    lin_sys_counts_since(w, &counts);
+  } else {
+    cache_misses++;
+#ifdef MATLAB_LDL
+    if (USE_MATLAB_LDL) {
+      scs_matlab_ldl_set_opts(&opts.ldl_opts);
+    }
+#endif
+#ifdef SUPERNODAL_LDL
+    if (USE_SUPERNODAL) {
+      set_supernodal_opts(settings_mex);
+    }
+#endif
+    w = scs_init(d, k, stgs);
+    if (w) {
+      trace_start(&trace, w, parse_trace_iters(settings_mex));
+      scs_solve(w, &sol, &info, stgs->warm_start);
+      trace_stop(&trace);
+      lin_sys_counts(w, &counts);
+      cache_insert(w, key, d, k, &kimg, &opts, limit);
+    } else {
+      lin_sys_counts(SCS_NULL, &counts);
+      init_failure(&sol, &info, d->n, d->m);
+    }
+  }
+
+  finish_output_field(plhs[0], sol.x, d->n);
+  finish_output_field(plhs[1], sol.y, d->m);
+  finish_output_field(plhs[2], sol.s, d->m);
+  write_info(&plhs[3], &info, &counts, &trace);
+  mxAddField(plhs[3], "cache_hit");
+  mxSetField(plhs[3], 0, "cache_hit", mxCreateDoubleScalar(e ? 1.0 : 0.0));
+  mxAddField(plhs[3], "cache_hits");
+  mxSetField(plhs[3], 0, "cache_hits", mxCreateDoubleScalar(cache_hits));
+  mxAddField(plhs[3], "cache_misses");
+  mxSetField(plhs[3], 0, "cache_misses", mxCreateDoubleScalar(cache_misses));
+  return SCS_NULL;
+}
+
+#undef CONE_ARRAYS
+#undef SPECTRAL_CONE_ARRAYS
+
+/* Read a problem written by SCS through write_data_filename. The file is
+ * streamed by SCS's own reader straight into d, k and stgs, with no MATLAB
+ * arrays in between. Settings in settings_mex override the stored ones.
+ * Free with free_file_problem. Returns an error message or SCS_NULL. */
+static const char *read_file_problem(const char *filename,
+                                     const mxArray *settings_mex,
+                                     ScsData **d, ScsCone **k,
+                                     ScsSettings **stgs) {
+  *d = SCS_NULL;
+  *k = SCS_NULL;
+  *stgs = SCS_NULL;
+  if (SCS(read_data)(filename, d, k, stgs) != 0) {
+    return "Error reading SCS data file (missing file, or written by an SCS "
+           "build with a different version, int or float size).";
+  }
+  /* the stored file names are not wanted here, and free_mex frees only
+   * strings set from settings_mex */
+  (*stgs)->write_data_filename = SCS_NULL;
+  (*stgs)->log_csv_filename = SCS_NULL;
+  set_settings(settings_mex, *stgs);
+  return SCS_NULL;
+}
+
+static void free_file_problem(ScsData *d, ScsCone *k, ScsSettings *stgs) {
+  if (d) {
+    SCS(free_data)(d);
+  }
+  if (k) {
+    SCS(free_cone)(k);
+  }
+  free_mex(SCS_NULL, SCS_NULL, stgs);
 }
 
 /* ======================== MEX entry point ======================== */
@@ -543,154 +3517,899 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
   if (nrhs >= 1 && mxIsChar(prhs[0])) {
     char *cmd = mxArrayToString(prhs[0]);
 
-    if (strcmp(cmd, "init") == 0) {
-      /* scs_xxx('init', data, cone, settings) */
-      ScsData *d;
-      ScsCone *k;
-      ScsSettings *stgs;
-      if (nrhs != 4) {
+    if (strcmp(cmd, "init") == 0) {
+      /* handle = scs_xxx('init', data, cone, settings) */
+      ScsData *d;
+      ScsCone *k;
+      ScsSettings *stgs;
+      ScsMexWorkspace *slot;
+      const char *err;
+      if (nrhs != 4) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: handle = scs_xxx('init', data, cone, settings)");
+      }
+      if (!mxIsStruct(prhs[1]) || !mxIsStruct(prhs[2])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Input arguments 2 and 3 must be structs.");
+      }
+      if (!mxIsEmpty(prhs[3]) && !mxIsStruct(prhs[3])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Input argument 4 (settings) must be a struct.");
+      }
+      if (parse_data(prhs[1], &d) < 0) {
+        scs_free(cmd);
+        mexErrMsgTxt("Error parsing data.");
+      }
+      if (parse_cones(prhs[2], &k) < 0) {
+        free_mex(d, SCS_NULL, SCS_NULL);
+        scs_free(cmd);
+        mexErrMsgTxt("Error parsing cones.");
+      }
+      if (parse_settings(prhs[3], &stgs) < 0) {
+        free_mex(d, k, SCS_NULL);
+        scs_free(cmd);
+        mexErrMsgTxt("Error parsing settings.");
+      }
+
+      err = ws_init(&slot, d, k, stgs, prhs[3]);
+      free_mex(d, k, stgs);
+      scs_free(cmd);
+      if (err) {
+        mexErrMsgTxt(err);
+      }
+      slot->single_out = mxIsSingle(mxGetField(prhs[1], 0, "b"));
+      plhs[0] = ws_create_handle(slot->handle);
+      return;
+    }
+
+    if (strcmp(cmd, "update") == 0) {
+      /* scs_xxx('update', handle, b_new, c_new)
+       * scs_xxx('update', handle, b_new, c_new, cone_update)
+       * Either vector can be [] to leave unchanged. cone_update holds new
+       * box bounds bl/bu and/or power cone exponents p (check_cone_params).
+       * These do not enter the KKT matrix, so they are written straight
+       * into the live cone of every ScsWork of the handle. Equilibration
+       * scales each power cone block uniformly and the cone is invariant
+       * under that, so p is used as given; the box rows are scaled one by
+       * one and the bounds go through set_work_box. */
+      scs_float *b_new = SCS_NULL;
+      scs_float *c_new = SCS_NULL;
+      scs_int b_copied = 0, c_copied = 0;
+      scs_int ws_n, ws_m;
+      const mxArray *cone_mex = SCS_NULL;
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      /* b and c as given to 'init', before any presolve */
+      ws_n = slot->pre ? slot->pre->n : slot->n;
+      ws_m = slot->pre ? slot->pre->m : slot->m;
+      if (nrhs >= 5 && !mxIsEmpty(prhs[4])) {
+        const char *msg = check_cone_params(slot->k, prhs[4]);
+        if (msg) {
+          scs_free(cmd);
+          mexErrMsgTxt(msg);
+        }
+        cone_mex = prhs[4];
+      }
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        if (!is_float_arr(prhs[2]) ||
+            (scs_int)mxGetNumberOfElements(prhs[2]) != ws_m) {
+          scs_free(cmd);
+          mexErrMsgTxt("b_new must be a double or single vector of length "
+                       "m.");
+        }
+        b_new = mex_float_arr(prhs[2], ws_m, &b_copied);
+        if (!b_new) {
+          scs_free(cmd);
+          mexErrMsgTxt("Memory allocation failed for b_new.");
+        }
+      }
+      if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        if (!is_float_arr(prhs[3]) ||
+            (scs_int)mxGetNumberOfElements(prhs[3]) != ws_n) {
+          if (b_copied) scs_free(b_new);
+          scs_free(cmd);
+          mexErrMsgTxt("c_new must be a double or single vector of length "
+                       "n.");
+        }
+        c_new = mex_float_arr(prhs[3], ws_n, &c_copied);
+        if (!c_new) {
+          if (b_copied) scs_free(b_new);
+          scs_free(cmd);
+          mexErrMsgTxt("Memory allocation failed for c_new.");
+        }
+      }
+      if (slot->pre && (b_new || c_new)) {
+        /* b moves the fixed variables, so both reduced vectors change */
+        const char *msg = presolve_map(slot->pre, b_new, c_new, slot->d);
+        if (b_copied) scs_free(b_new);
+        if (c_copied) scs_free(c_new);
+        if (msg) {
+          scs_free(cmd);
+          mexErrMsgTxt(msg);
+        }
+        b_new = c_new = SCS_NULL;
+        b_copied = c_copied = 0;
+        scs_update(slot->work, slot->d->b, slot->d->c);
+      } else if (b_new || c_new) {
+        scs_update(slot->work, b_new, c_new);
+      }
+      if (cone_mex) {
+        scs_int i;
+        set_cone_params(slot->k, cone_mex);
+        set_cone_params(slot->work->k, cone_mex);
+        for (i = 0; i < slot->n_clones; i++) {
+          set_cone_params(slot->clones[i]->k, cone_mex);
+        }
+        if (slot->k->bsize > 1) {
+          set_work_box(slot->work, slot->k);
+          for (i = 0; i < slot->n_clones; i++) {
+            set_work_box(slot->clones[i], slot->k);
+          }
+        }
+      }
+      if (b_new) {
+        memcpy(slot->d->b, b_new, slot->m * sizeof(scs_float));
+      }
+      if (c_new) {
+        memcpy(slot->d->c, c_new, slot->n * sizeof(scs_float));
+      }
+      if (b_copied) scs_free(b_new);
+      if (c_copied) scs_free(c_new);
+      scs_free(cmd);
+      return;
+    }
+
+    if (strcmp(cmd, "update_matrix") == 0) {
+      /* scs_xxx('update_matrix', handle, A_new, P_new)
+       * New values for A and/or P with the pattern given at 'init', as a
+       * sparse matrix with that pattern or a vector of its nonzeros (see
+       * matrix_values_fit); either can be [] to leave unchanged. The
+       * workspace is rebuilt from the updated problem (equilibration and
+       * KKT matrix); the MATLAB-LDL backend keeps its ordering and symbolic
+       * analysis and only refactorizes numerically. */
+      const mxArray *A_mex = SCS_NULL, *P_mex = SCS_NULL;
+      ScsMatrix *A, *P;
+      scs_float *A_old = SCS_NULL, *P_old = SCS_NULL;
+      scs_int nnz_A, nnz_P = 0;
+      ScsWork *work;
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
         scs_free(cmd);
-        mexErrMsgTxt("Usage: scs_xxx('init', data, cone, settings)");
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
       }
-      if (!mxIsStruct(prhs[1]) || !mxIsStruct(prhs[2])) {
+      if (slot->pre) {
         scs_free(cmd);
-        mexErrMsgTxt("Input arguments 2 and 3 must be structs.");
+        mexErrMsgTxt("'update_matrix' is not supported for a workspace "
+                     "initialized with presolve.");
       }
-      if (!mxIsEmpty(prhs[3]) && !mxIsStruct(prhs[3])) {
+      A = slot->d->A;
+      P = slot->d->P;
+      nnz_A = A->p[A->n];
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        A_mex = prhs[2];
+        if (!matrix_values_fit(A_mex, A)) {
+          scs_free(cmd);
+          mexErrMsgTxt("A_new must have the sparsity pattern of A at init "
+                       "(or be a vector of its nnz values).");
+        }
+      }
+      if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        P_mex = prhs[3];
+        if (!P) {
+          scs_free(cmd);
+          mexErrMsgTxt("Workspace was initialized without P.");
+        }
+        nnz_P = P->p[P->n];
+        if (!matrix_values_fit(P_mex, P)) {
+          scs_free(cmd);
+          mexErrMsgTxt("P_new must have the sparsity pattern of triu(P) at "
+                       "init (or be a vector of its nnz values).");
+        }
+      }
+      if (!A_mex && !P_mex) {
         scs_free(cmd);
-        mexErrMsgTxt("Input argument 4 (settings) must be a struct.");
+        return;
       }
-      ws_cleanup(); /* free any existing workspace */
-      if (parse_data(prhs[1], &d) < 0) {
+
+      /* Keep the old values to restore if the new workspace fails */
+      if (A_mex) {
+        A_old = (scs_float *)scs_malloc(MAX(nnz_A, 1) * sizeof(scs_float));
+      }
+      if (P_mex) {
+        P_old = (scs_float *)scs_malloc(MAX(nnz_P, 1) * sizeof(scs_float));
+      }
+      if ((A_mex && !A_old) || (P_mex && !P_old)) {
+        scs_free(A_old);
+        scs_free(P_old);
         scs_free(cmd);
-        mexErrMsgTxt("Error parsing data.");
+        mexErrMsgTxt("Memory allocation failed for matrix update.");
       }
-      if (parse_cones(prhs[2], &k) < 0) {
-        free_mex(d, SCS_NULL, SCS_NULL);
+      if (A_mex) {
+        memcpy(A_old, A->x, nnz_A * sizeof(scs_float));
+        copy_float_arr(A->x, A_mex, nnz_A);
+      }
+      if (P_mex) {
+        memcpy(P_old, P->x, nnz_P * sizeof(scs_float));
+        copy_float_arr(P->x, P_mex, nnz_P);
+      }
+
+      /* Batch workspaces are rebuilt from the new data when next needed */
+      ws_free_clones(slot);
+#ifdef MATLAB_LDL
+      if (USE_MATLAB_LDL) {
+        scs_matlab_ldl_set_opts(&slot->ldl_opts);
+#ifdef UNIFIED_LINSYS
+        scs_matlab_ldl_reuse_symbolic(
+            (ScsLinSysWork **)scs_unified_work_ref(slot->work->p));
+#else
+        scs_matlab_ldl_reuse_symbolic(&slot->work->p);
+#endif
+      }
+#endif
+      work = scs_init(slot->d, slot->k, slot->stgs);
+#ifdef MATLAB_LDL
+      /* left armed if scs_init failed before the linear system */
+      scs_matlab_ldl_reuse_symbolic(SCS_NULL);
+#endif
+      if (!work) {
+        if (A_mex) {
+          memcpy(A->x, A_old, nnz_A * sizeof(scs_float));
+        }
+        if (P_mex) {
+          memcpy(P->x, P_old, nnz_P * sizeof(scs_float));
+        }
+        scs_free(A_old);
+        scs_free(P_old);
         scs_free(cmd);
-        mexErrMsgTxt("Error parsing cones.");
+        if (!LIN_SYS_WORK(slot->work->p)) {
+          /* its linear system workspace was taken over and is gone */
+          ws_release(slot);
+          mexErrMsgTxt("SCS init failed; the workspace has been freed.");
+        }
+        mexErrMsgTxt("SCS init failed; the workspace is unchanged.");
       }
-      if (parse_settings(prhs[3], &stgs) < 0) {
-        free_mex(d, k, SCS_NULL);
+      scs_finish(slot->work);
+      slot->work = work;
+      scs_free(A_old);
+      scs_free(P_old);
+      scs_free(cmd);
+      return;
+    }
+
+    if (strcmp(cmd, "solve") == 0) {
+      /* [x,y,s,info] = scs_xxx('solve', handle)
+       * [x,y,s,info] = scs_xxx('solve', handle, warm_start_struct) */
+      ScsSolution sol = {0}, red = {0};
+      ScsInfo info;
+      ScsMexTrace trace;
+      ScsMexLinSysCounts counts;
+      scs_int warm_start = 0;
+      scs_int ws_n, ws_m;
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
         scs_free(cmd);
-        mexErrMsgTxt("Error parsing settings.");
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      ws_n = slot->pre ? slot->pre->n : slot->n;
+      ws_m = slot->pre ? slot->pre->m : slot->m;
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2]) && !mxIsStruct(prhs[2])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Warm start argument must be a struct.");
+      }
+
+      /* SCS writes the solution straight into the outputs */
+      sol.x = create_output_field(&plhs[0], ws_n, slot->single_out);
+      sol.y = create_output_field(&plhs[1], ws_m, slot->single_out);
+      sol.s = create_output_field(&plhs[2], ws_m, slot->single_out);
+      if (!sol.x || !sol.y || !sol.s) {
+        free_output_field(plhs[0], sol.x);
+        free_output_field(plhs[1], sol.y);
+        free_output_field(plhs[2], sol.s);
+        scs_free(cmd);
+        mexErrMsgTxt("Memory allocation failed for solution vectors.");
       }
 
-      ws_n = d->n;
-      ws_m = d->m;
-      ws_work = scs_init(d, k, stgs);
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        const mxArray *ws_data = prhs[2];
+        warm_start =
+            parse_warm_start(mxGetField(ws_data, 0, "x"), sol.x, ws_n);
+        warm_start |=
+            parse_warm_start(mxGetField(ws_data, 0, "y"), sol.y, ws_m);
+        warm_start |=
+            parse_warm_start(mxGetField(ws_data, 0, "s"), sol.s, ws_m);
+      }
+      if (slot->pre) {
+        if (presolve_alloc_sol(slot->pre, &red) < 0) {
+          presolve_free_sol(&red);
+          free_output_field(plhs[0], sol.x);
+          free_output_field(plhs[1], sol.y);
+          free_output_field(plhs[2], sol.s);
+          scs_free(cmd);
+          mexErrMsgTxt("Memory allocation failed for solution vectors.");
+        }
+        if (warm_start) {
+          presolve_warm(slot->pre, &sol, &red);
+        }
+      }
 
-      free_mex(d, k, stgs);
+      lin_sys_counts(slot->work, &counts);
+      trace_start(&trace, slot->work, slot->trace_iters);
+      scs_solve(slot->work, slot->pre ? &red : &sol, &info, warm_start);
+      trace_stop(&trace);
+      lin_sys_counts_since(slot->work, &counts);
+      if (slot->pre) {
+        postsolve(slot->pre, &red, &sol, &info);
+        presolve_free_sol(&red);
+      }
 
-      if (!ws_work) {
-        ws_n = 0;
-        ws_m = 0;
-        mexErrMsgTxt("SCS init failed.");
+      finish_output_field(plhs[0], sol.x, ws_n);
+      finish_output_field(plhs[1], sol.y, ws_m);
+      finish_output_field(plhs[2], sol.s, ws_m);
+      write_info(&plhs[3], &info, &counts, &trace);
+      if (slot->pre) {
+        presolve_add_info(plhs[3], slot->pre);
       }
-      mexAtExit(ws_cleanup);
+
       scs_free(cmd);
       return;
     }
 
-    if (strcmp(cmd, "update") == 0) {
-      /* scs_xxx('update', b_new, c_new)
-       * Either argument can be [] to leave unchanged. */
-      scs_float *b_new = SCS_NULL;
-      scs_float *c_new = SCS_NULL;
-      if (!ws_work) {
+    if (strcmp(cmd, "solve_batch") == 0) {
+      /* [X,Y,S,info] = scs_xxx('solve_batch', handle, B, C)
+       * Solves one problem per column of B (m x k) and C (n x k); either
+       * can be [] to use the workspace's current b or c. Columns run in
+       * parallel, the first thread on the handle's own workspace (whose b
+       * and c are put back afterwards) and the others on clones of it. */
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      const mxArray *B_mex = SCS_NULL, *C_mex = SCS_NULL;
+      scs_float *B = SCS_NULL, *C = SCS_NULL;
+      scs_float *X, *Y, *S;
+      ScsInfo *infos;
+      ScsMexLinSysCounts *counts;
+      scs_int n, m, n_batch = -1, n_threads = 1, failed = 0;
+      scs_int j, verbose;
+      if (!slot) {
         scs_free(cmd);
-        mexErrMsgTxt("No workspace. Call scs_init first.");
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
       }
-      if (nrhs >= 2 && !mxIsEmpty(prhs[1])) {
-#ifdef SFLOAT
-        b_new = cast_to_scs_float_arr(mxGetPr(prhs[1]), ws_m);
-        if (!b_new) {
+      if (slot->pre) {
+        scs_free(cmd);
+        mexErrMsgTxt("'solve_batch' is not supported for a workspace "
+                     "initialized with presolve.");
+      }
+      n = slot->n;
+      m = slot->m;
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        B_mex = prhs[2];
+        if (mxIsSparse(B_mex) || !mxIsDouble(B_mex) ||
+            (scs_int)mxGetM(B_mex) != m) {
           scs_free(cmd);
-          mexErrMsgTxt("Memory allocation failed for b_new.");
+          mexErrMsgTxt("B must be a dense double matrix with m rows.");
         }
-#else
-        b_new = (scs_float *)mxGetPr(prhs[1]);
-#endif
+        n_batch = (scs_int)mxGetN(B_mex);
       }
-      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
-#ifdef SFLOAT
-        c_new = cast_to_scs_float_arr(mxGetPr(prhs[2]), ws_n);
-        if (!c_new) {
-          if (b_new) scs_free(b_new);
+      if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        C_mex = prhs[3];
+        if (mxIsSparse(C_mex) || !mxIsDouble(C_mex) ||
+            (scs_int)mxGetM(C_mex) != n) {
           scs_free(cmd);
-          mexErrMsgTxt("Memory allocation failed for c_new.");
+          mexErrMsgTxt("C must be a dense double matrix with n rows.");
+        }
+        if (n_batch >= 0 && (scs_int)mxGetN(C_mex) != n_batch) {
+          scs_free(cmd);
+          mexErrMsgTxt("B and C must have the same number of columns.");
         }
+        n_batch = (scs_int)mxGetN(C_mex);
+      }
+      if (n_batch < 0) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: scs_xxx('solve_batch', handle, B, C) with at "
+                     "least one of B, C non-empty.");
+      }
+
+#ifdef _OPENMP
+      n_threads = (scs_int)omp_get_max_threads();
+#endif
+#ifdef MATLAB_LDL
+      /* Refactorizations call back into MATLAB, which is only allowed from
+       * the main thread. */
+      if (USE_MATLAB_LDL) {
+        n_threads = 1;
+      }
+#endif
+      n_threads = MAX(1, MIN(n_threads, n_batch));
+      if (n_threads > 1 && ws_ensure_clones(slot, n_threads - 1) < 0) {
+        ws_free_clones(slot);
+        scs_free(cmd);
+        mexErrMsgTxt("SCS init failed for batch workspaces.");
+      }
+
+      plhs[0] = mxCreateDoubleMatrix(n, n_batch, mxREAL);
+      plhs[1] = mxCreateDoubleMatrix(m, n_batch, mxREAL);
+      plhs[2] = mxCreateDoubleMatrix(m, n_batch, mxREAL);
+      infos = (ScsInfo *)scs_calloc(n_batch > 0 ? n_batch : 1,
+                                    sizeof(ScsInfo));
+      counts = (ScsMexLinSysCounts *)scs_calloc(n_batch > 0 ? n_batch : 1,
+                                                sizeof(ScsMexLinSysCounts));
+#ifdef SFLOAT
+      if (B_mex) B = cast_to_scs_float_arr(mxGetPr(B_mex), m * n_batch);
+      if (C_mex) C = cast_to_scs_float_arr(mxGetPr(C_mex), n * n_batch);
+      X = (scs_float *)scs_calloc(n * n_batch + 1, sizeof(scs_float));
+      Y = (scs_float *)scs_calloc(m * n_batch + 1, sizeof(scs_float));
+      S = (scs_float *)scs_calloc(m * n_batch + 1, sizeof(scs_float));
 #else
-        c_new = (scs_float *)mxGetPr(prhs[2]);
+      if (B_mex) B = (scs_float *)mxGetPr(B_mex);
+      if (C_mex) C = (scs_float *)mxGetPr(C_mex);
+      X = (scs_float *)mxGetPr(plhs[0]);
+      Y = (scs_float *)mxGetPr(plhs[1]);
+      S = (scs_float *)mxGetPr(plhs[2]);
+#endif
+      if (!infos || !counts || (B_mex && !B) || (C_mex && !C) || !X || !Y ||
+          !S) {
+#ifdef SFLOAT
+        if (B) scs_free(B);
+        if (C) scs_free(C);
+        if (X) scs_free(X);
+        if (Y) scs_free(Y);
+        if (S) scs_free(S);
+#endif
+        if (infos) scs_free(infos);
+        if (counts) scs_free(counts);
+        scs_free(cmd);
+        mexErrMsgTxt("Memory allocation failed for batch solve.");
+      }
+
+      /* SCS only polls MATLAB for Ctrl-C on this thread; a listener around
+       * the loop lets the other threads stop on it as well (see
+       * scs_ctrlc_mex.c) */
+      verbose = slot->work->stgs->verbose;
+      slot->work->stgs->verbose = 0;
+      scs_start_interrupt_listener();
+#ifdef _OPENMP
+#pragma omp parallel for num_threads(n_threads) schedule(dynamic, 1)          \
+    reduction(+ : failed)
+#endif
+      for (j = 0; j < n_batch; j++) {
+        ScsWork *w = slot->work;
+        ScsSolution sol;
+#ifdef _OPENMP
+        if (omp_get_thread_num() > 0) {
+          w = slot->clones[omp_get_thread_num() - 1];
+        }
 #endif
+        /* every column resets both vectors, the clone may hold another
+         * column's b or c from its previous solve */
+        if (scs_update(w, B ? &B[j * m] : slot->d->b,
+                       C ? &C[j * n] : slot->d->c) < 0) {
+          failed++;
+          continue;
+        }
+        sol.x = &X[j * n];
+        sol.y = &Y[j * m];
+        sol.s = &S[j * m];
+        lin_sys_counts(w, &counts[j]);
+        scs_solve(w, &sol, &infos[j], 0);
+        lin_sys_counts_since(w, &counts[j]);
       }
-      scs_update(ws_work, b_new, c_new);
+      scs_end_interrupt_listener();
+      slot->work->stgs->verbose = verbose;
+      if (scs_update(slot->work, slot->d->b, slot->d->c) < 0) {
+        failed++;
+      }
+
 #ifdef SFLOAT
-      if (b_new) scs_free(b_new);
-      if (c_new) scs_free(c_new);
+      {
+        double *pr;
+        scs_int i;
+        pr = mxGetPr(plhs[0]);
+        for (i = 0; i < n * n_batch; i++) pr[i] = (double)X[i];
+        pr = mxGetPr(plhs[1]);
+        for (i = 0; i < m * n_batch; i++) pr[i] = (double)Y[i];
+        pr = mxGetPr(plhs[2]);
+        for (i = 0; i < m * n_batch; i++) pr[i] = (double)S[i];
+        if (B) scs_free(B);
+        if (C) scs_free(C);
+        scs_free(X);
+        scs_free(Y);
+        scs_free(S);
+      }
 #endif
+      plhs[3] = create_info_struct(n_batch);
+      for (j = 0; j < n_batch; j++) {
+        set_info(plhs[3], j, &infos[j], &counts[j]);
+      }
+      scs_free(infos);
+      scs_free(counts);
       scs_free(cmd);
+      if (failed) {
+        mexErrMsgTxt("SCS update failed for batch column.");
+      }
       return;
     }
 
-    if (strcmp(cmd, "solve") == 0) {
-      /* [x,y,s,info] = scs_xxx('solve')
-       * [x,y,s,info] = scs_xxx('solve', warm_start_struct) */
+    if (strcmp(cmd, "solve_path") == 0) {
+      /* [X,Y,S,info] = scs_xxx('solve_path', handle, B, C)
+       * [X,Y,S,info] = scs_xxx('solve_path', handle, B, C, warm_start_struct)
+       * Solves the path points (B(:,j), C(:,j)) in order on the handle's
+       * workspace, each one warm-started from the previous solution and,
+       * with adaptive_scale, from the previous final scale. Either B or C
+       * can be [] to keep the current b or c fixed along the path. */
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      const mxArray *B_mex = SCS_NULL, *C_mex = SCS_NULL;
+      scs_float *B = SCS_NULL, *C = SCS_NULL;
+      scs_float *X, *Y, *S;
+      scs_float scale_init;
       ScsSolution sol = {0};
       ScsInfo info;
-      scs_int warm_start = 0;
-      if (!ws_work) {
+      ScsMexLinSysCounts counts;
+      scs_int n, m, n_path = -1, warm_start = 0;
+      scs_int j;
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      if (slot->pre) {
         scs_free(cmd);
-        mexErrMsgTxt("No workspace. Call scs_init first.");
+        mexErrMsgTxt("'solve_path' is not supported for a workspace "
+                     "initialized with presolve.");
       }
-      if (nrhs >= 2 && !mxIsEmpty(prhs[1])) {
-        const mxArray *ws_data = prhs[1];
-        if (!mxIsStruct(ws_data)) {
+      n = slot->n;
+      m = slot->m;
+      if (nrhs >= 3 && !mxIsEmpty(prhs[2])) {
+        B_mex = prhs[2];
+        if (mxIsSparse(B_mex) || !mxIsDouble(B_mex) ||
+            (scs_int)mxGetM(B_mex) != m) {
           scs_free(cmd);
-          mexErrMsgTxt("Warm start argument must be a struct.");
+          mexErrMsgTxt("B must be a dense double matrix with m rows.");
         }
-        warm_start =
-            parse_warm_start(mxGetField(ws_data, 0, "x"), &(sol.x), ws_n);
-        warm_start |=
-            parse_warm_start(mxGetField(ws_data, 0, "y"), &(sol.y), ws_m);
-        warm_start |=
-            parse_warm_start(mxGetField(ws_data, 0, "s"), &(sol.s), ws_m);
+        n_path = (scs_int)mxGetN(B_mex);
+      }
+      if (nrhs >= 4 && !mxIsEmpty(prhs[3])) {
+        C_mex = prhs[3];
+        if (mxIsSparse(C_mex) || !mxIsDouble(C_mex) ||
+            (scs_int)mxGetM(C_mex) != n) {
+          scs_free(cmd);
+          mexErrMsgTxt("C must be a dense double matrix with n rows.");
+        }
+        if (n_path >= 0 && (scs_int)mxGetN(C_mex) != n_path) {
+          scs_free(cmd);
+          mexErrMsgTxt("B and C must have the same number of columns.");
+        }
+        n_path = (scs_int)mxGetN(C_mex);
+      }
+      if (n_path < 0) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: scs_xxx('solve_path', handle, B, C) with at "
+                     "least one of B, C non-empty.");
+      }
+      if (nrhs >= 5 && !mxIsEmpty(prhs[4]) && !mxIsStruct(prhs[4])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Warm start argument must be a struct.");
       }
-      if (!sol.x)
-        sol.x = (scs_float *)scs_calloc(ws_n, sizeof(scs_float));
-      if (!sol.y)
-        sol.y = (scs_float *)scs_calloc(ws_m, sizeof(scs_float));
-      if (!sol.s)
-        sol.s = (scs_float *)scs_calloc(ws_m, sizeof(scs_float));
 
-      if (!sol.x || !sol.y || !sol.s) {
-        if (sol.x) scs_free(sol.x);
-        if (sol.y) scs_free(sol.y);
-        if (sol.s) scs_free(sol.s);
+      plhs[0] = mxCreateDoubleMatrix(n, n_path, mxREAL);
+      plhs[1] = mxCreateDoubleMatrix(m, n_path, mxREAL);
+      plhs[2] = mxCreateDoubleMatrix(m, n_path, mxREAL);
+      plhs[3] = create_info_struct(n_path);
+      if (n_path == 0) {
         scs_free(cmd);
-        mexErrMsgTxt("Memory allocation failed for solution vectors.");
+        return;
+      }
+#ifdef SFLOAT
+      if (B_mex) B = cast_to_scs_float_arr(mxGetPr(B_mex), m * n_path);
+      if (C_mex) C = cast_to_scs_float_arr(mxGetPr(C_mex), n * n_path);
+      X = (scs_float *)scs_calloc(n * n_path, sizeof(scs_float));
+      Y = (scs_float *)scs_calloc(m * n_path, sizeof(scs_float));
+      S = (scs_float *)scs_calloc(m * n_path, sizeof(scs_float));
+#else
+      if (B_mex) B = (scs_float *)mxGetPr(B_mex);
+      if (C_mex) C = (scs_float *)mxGetPr(C_mex);
+      X = (scs_float *)mxGetPr(plhs[0]);
+      Y = (scs_float *)mxGetPr(plhs[1]);
+      S = (scs_float *)mxGetPr(plhs[2]);
+#endif
+      if ((B_mex && !B) || (C_mex && !C) || !X || !Y || !S) {
+#ifdef SFLOAT
+        if (B) scs_free(B);
+        if (C) scs_free(C);
+        if (X) scs_free(X);
+        if (Y) scs_free(Y);
+        if (S) scs_free(S);
+#endif
+        scs_free(cmd);
+        mexErrMsgTxt("Memory allocation failed for path solve.");
+      }
+
+      /* Optional warm start for the first point */
+      if (nrhs >= 5 && !mxIsEmpty(prhs[4])) {
+        warm_start = parse_warm_start(mxGetField(prhs[4], 0, "x"), X, n);
+        warm_start |= parse_warm_start(mxGetField(prhs[4], 0, "y"), Y, m);
+        warm_start |= parse_warm_start(mxGetField(prhs[4], 0, "s"), S, m);
+      }
+
+      scale_init = slot->work->stgs->scale;
+      for (j = 0; j < n_path; j++) {
+        sol.x = &X[j * n];
+        sol.y = &Y[j * m];
+        sol.s = &S[j * m];
+        if (j > 0) {
+          /* chain: previous solution is this point's warm start */
+          memcpy(sol.x, &X[(j - 1) * n], n * sizeof(scs_float));
+          memcpy(sol.y, &Y[(j - 1) * m], m * sizeof(scs_float));
+          memcpy(sol.s, &S[(j - 1) * m], m * sizeof(scs_float));
+          warm_start = 1;
+          if (slot->work->stgs->adaptive_scale) {
+            slot->work->stgs->scale = info.scale;
+          }
+        }
+        scs_update(slot->work, B ? &B[j * m] : SCS_NULL,
+                   C ? &C[j * n] : SCS_NULL);
+        lin_sys_counts(slot->work, &counts);
+        scs_solve(slot->work, &sol, &info, warm_start);
+        lin_sys_counts_since(slot->work, &counts);
+        set_info(plhs[3], j, &info, &counts);
+      }
+      slot->work->stgs->scale = scale_init;
+      if (B) {
+        memcpy(slot->d->b, &B[(n_path - 1) * m], m * sizeof(scs_float));
+      }
+      if (C) {
+        memcpy(slot->d->c, &C[(n_path - 1) * n], n * sizeof(scs_float));
+      }
+
+#ifdef SFLOAT
+      {
+        double *pr;
+        scs_int i;
+        pr = mxGetPr(plhs[0]);
+        for (i = 0; i < n * n_path; i++) pr[i] = (double)X[i];
+        pr = mxGetPr(plhs[1]);
+        for (i = 0; i < m * n_path; i++) pr[i] = (double)Y[i];
+        pr = mxGetPr(plhs[2]);
+        for (i = 0; i < m * n_path; i++) pr[i] = (double)S[i];
+        if (B) scs_free(B);
+        if (C) scs_free(C);
+        scs_free(X);
+        scs_free(Y);
+        scs_free(S);
+      }
+#endif
+      scs_free(cmd);
+      return;
+    }
+
+    if (strcmp(cmd, "stats") == 0) {
+      /* stats = scs_xxx('stats', handle) */
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
       }
+      plhs[0] = ws_stats(slot);
+      scs_free(cmd);
+      return;
+    }
+
+    if (strcmp(cmd, "cache") == 0) {
+      /* stats = scs_xxx('cache') */
+      plhs[0] = cache_stats();
+      scs_free(cmd);
+      return;
+    }
+
+    if (strcmp(cmd, "cache_clear") == 0) {
+      /* scs_xxx('cache_clear') */
+      cache_clear();
+      cache_hits = 0.0;
+      cache_misses = 0.0;
+      scs_free(cmd);
+      return;
+    }
 
-      scs_solve(ws_work, &sol, &info, warm_start);
+    if (strcmp(cmd, "save") == 0) {
+      /* scs_xxx('save', handle, filename) */
+      const char *err;
+      char *filename;
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      if (slot->pre) {
+        scs_free(cmd);
+        mexErrMsgTxt("'save' is not supported for a workspace initialized "
+                     "with presolve.");
+      }
+      if (nrhs < 3 || !mxIsChar(prhs[2])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: scs_xxx('save', handle, filename)");
+      }
+      filename = mxArrayToString(prhs[2]);
+      err = ws_save(slot, filename);
+      scs_free(filename);
+      scs_free(cmd);
+      if (err) {
+        mexErrMsgTxt(err);
+      }
+      return;
+    }
 
-      set_output_field(&plhs[0], sol.x, ws_n);
-      set_output_field(&plhs[1], sol.y, ws_m);
-      set_output_field(&plhs[2], sol.s, ws_m);
-      write_info(&plhs[3], &info);
+    if (strcmp(cmd, "load") == 0) {
+      /* [handle, dims] = scs_xxx('load', filename), dims = [m, n] */
+      const char *err;
+      char *filename;
+      ScsMexWorkspace *slot;
+      if (nrhs < 2 || !mxIsChar(prhs[1])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: handle = scs_xxx('load', filename)");
+      }
+      slot = ws_alloc_slot();
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Memory allocation failed for workspace table.");
+      }
+      filename = mxArrayToString(prhs[1]);
+      err = ws_load(slot, filename);
+      scs_free(filename);
+      scs_free(cmd);
+      if (err) {
+        mexErrMsgTxt(err);
+      }
+      slot->handle = ws_next_handle++;
+      mexAtExit(ws_cleanup);
+      plhs[0] = ws_create_handle(slot->handle);
+      if (nlhs > 1) {
+        plhs[1] = mxCreateDoubleMatrix(1, 2, mxREAL);
+        mxGetPr(plhs[1])[0] = (double)slot->m;
+        mxGetPr(plhs[1])[1] = (double)slot->n;
+      }
+      return;
+    }
 
+    if (strcmp(cmd, "read") == 0 || strcmp(cmd, "read_init") == 0) {
+      /* [x,y,s,info] = scs_xxx('read', filename, settings)
+       * [handle, dims] = scs_xxx('read_init', filename, settings)
+       * Solve, or create a workspace for, a problem file written through
+       * write_data_filename; dims = [m, n]. */
+      const char *err;
+      char *filename;
+      ScsData *d;
+      ScsCone *k;
+      ScsSettings *stgs;
+      ScsMexWorkspace *slot;
+      const mxArray *settings_mex;
+      scs_int init = strcmp(cmd, "read_init") == 0;
+      if (nrhs < 2 || !mxIsChar(prhs[1])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: scs_xxx('read', filename, settings)");
+      }
+      /* no settings behaves like [], which has no fields */
+      settings_mex =
+          nrhs >= 3 ? prhs[2] : mxCreateDoubleMatrix(0, 0, mxREAL);
+      if (!mxIsEmpty(settings_mex) && !mxIsStruct(settings_mex)) {
+        scs_free(cmd);
+        mexErrMsgTxt("Input argument 3 (settings) must be a struct.");
+      }
+      if (!init && nlhs > 4) {
+        scs_free(cmd);
+        mexErrMsgTxt("scs returns up to 4 output arguments only.");
+      }
       scs_free(cmd);
+      filename = mxArrayToString(prhs[1]);
+      err = read_file_problem(filename, settings_mex, &d, &k, &stgs);
+      scs_free(filename);
+      if (err) {
+        mexErrMsgTxt(err);
+      }
+      if (init) {
+        err = ws_init(&slot, d, k, stgs, settings_mex);
+      } else {
+        err = solve_one_shot(plhs, d, k, stgs, SCS_NULL, settings_mex);
+      }
+      free_file_problem(d, k, stgs);
+      if (err) {
+        mexErrMsgTxt(err);
+      }
+      if (init) {
+        plhs[0] = ws_create_handle(slot->handle);
+        if (nlhs > 1) {
+          plhs[1] = mxCreateDoubleMatrix(1, 2, mxREAL);
+          mxGetPr(plhs[1])[0] = (double)(slot->pre ? slot->pre->m : slot->m);
+          mxGetPr(plhs[1])[1] = (double)(slot->pre ? slot->pre->n : slot->n);
+        }
+      }
       return;
     }
 
     if (strcmp(cmd, "finish") == 0) {
-      ws_cleanup();
+      /* scs_xxx('finish', handle) */
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      ws_release(slot);
+      scs_free(cmd);
+      return;
+    }
+
+#ifdef UNIFIED_LINSYS
+    if (strcmp(cmd, "lin_sys") == 0) {
+      /* name = scs_unified('lin_sys', handle)
+       * scs_unified('lin_sys', handle, settings)
+       * The backend of a workspace, or move the workspace to the backend
+       * named by settings.lin_sys_backend, with the backend options in
+       * settings. The new linear system workspace is set up from the
+       * problem the slot retains (with the 'update's applied), without
+       * parsing anything again; SCS's iterates start afresh. */
+      ScsMatlabLdlOpts ldl_opts;
+      ScsWork *work;
+      const char *err;
+      ScsMexWorkspace *slot = ws_lookup(nrhs >= 2 ? prhs[1] : SCS_NULL);
+      if (!slot) {
+        scs_free(cmd);
+        mexErrMsgTxt("Invalid workspace handle. Call scs_init first.");
+      }
+      if (nrhs < 3) {
+        plhs[0] = mxCreateString(scs_unified_name(slot->lin_sys));
+        scs_free(cmd);
+        return;
+      }
+      if (!mxIsStruct(prhs[2])) {
+        scs_free(cmd);
+        mexErrMsgTxt("Usage: scs_unified('lin_sys', handle, settings)");
+      }
+      err = select_lin_sys(prhs[2]);
+      if (err) {
+        scs_unified_select(slot->lin_sys);
+        scs_free(cmd);
+        mexErrMsgTxt(err);
+      }
+      parse_ldl_opts(prhs[2], &ldl_opts);
+      if (USE_MATLAB_LDL) {
+        scs_matlab_ldl_set_opts(&ldl_opts);
+      }
+      if (USE_SUPERNODAL) {
+        set_supernodal_opts(prhs[2]);
+      }
+      work = scs_init(slot->d, slot->k, slot->stgs);
+      if (!work) {
+        scs_unified_select(slot->lin_sys);
+        scs_free(cmd);
+        mexErrMsgTxt("SCS init failed; the workspace is unchanged.");
+      }
+      ws_free_clones(slot);
+      scs_finish(slot->work);
+      slot->work = work;
+      slot->lin_sys = scs_unified_selected();
+      slot->ldl_opts = ldl_opts;
+      /* a factor from a workspace file is for the old workspace only */
+      slot->has_ldl_factor = 0;
+      if (slot->file_map) {
+        file_unmap(slot->file_map, slot->file_len);
+        slot->file_map = SCS_NULL;
+        slot->file_len = 0;
+      }
       scs_free(cmd);
       return;
     }
+#endif
 
     scs_free(cmd);
-    mexErrMsgTxt("Unknown command. Use 'init', 'solve', 'update', or "
+#ifdef UNIFIED_LINSYS
+    mexErrMsgTxt("Unknown command. Use 'init', 'solve', 'solve_batch', "
+                 "'solve_path', 'update', 'update_matrix', 'stats', 'cache', "
+                 "'cache_clear', 'save', 'load', 'read', 'read_init', "
+                 "'lin_sys', or 'finish'.");
+#else
+    mexErrMsgTxt("Unknown command. Use 'init', 'solve', 'solve_batch', "
+                 "'solve_path', 'update', 'update_matrix', 'stats', 'cache', "
+                 "'cache_clear', 'save', 'load', 'read', 'read_init', or "
                  "'finish'.");
+#endif
     return;
   }
 
@@ -699,8 +4418,8 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
     ScsData *d;
     ScsCone *k;
     ScsSettings *stgs;
-    ScsSolution sol = {0};
-    ScsInfo info;
+    const char *err;
+    double cache_limit;
 
     if (nrhs != 3) {
       mexErrMsgTxt("Three arguments are required in this order: data struct, "
@@ -728,30 +4447,16 @@ void mexFunction(int nlhs, mxArray *plhs[], int nrhs, const mxArray *prhs[]) {
       mexErrMsgTxt("Error parsing settings.");
     }
 
-    /* warm-start */
-    stgs->warm_start =
-        parse_warm_start(mxGetField(prhs[0], 0, "x"), &(sol.x), d->n);
-    stgs->warm_start |=
-        parse_warm_start(mxGetField(prhs[0], 0, "y"), &(sol.y), d->m);
-    stgs->warm_start |=
-        parse_warm_start(mxGetField(prhs[0], 0, "s"), &(sol.s), d->m);
-
-    if (!sol.x || !sol.y || !sol.s) {
-      if (sol.x) scs_free(sol.x);
-      if (sol.y) scs_free(sol.y);
-      if (sol.s) scs_free(sol.s);
-      free_mex(d, k, stgs);
-      mexErrMsgTxt("Memory allocation failed for solution vectors.");
+    cache_limit = parse_cache_bytes(prhs[2], stgs);
+    if (cache_limit > 0) {
+      err = solve_cached(plhs, d, k, stgs, prhs[0], prhs[2], cache_limit);
+    } else {
+      err = solve_one_shot(plhs, d, k, stgs, prhs[0], prhs[2]);
     }
-
-    scs(d, k, stgs, &sol, &info);
-
-    set_output_field(&plhs[0], sol.x, d->n);
-    set_output_field(&plhs[1], sol.y, d->m);
-    set_output_field(&plhs[2], sol.s, d->m);
-    write_info(&plhs[3], &info);
-
     free_mex(d, k, stgs);
+    if (err) {
+      mexErrMsgTxt(err);
+    }
   }
 }
 
@@ -807,46 +4512,15 @@ void free_mex(ScsData *d, ScsCone *k, ScsSettings *stgs) {
     scs_free(stgs);
   }
   if (d) {
-#ifdef SFLOAT /* only free if copies, which is only when flags set */
-    if (d->b) {
+    const ScsMexData *md = (const ScsMexData *)d; /* from parse_data */
+    if (md->b_copied && d->b) { /* only free if copies */
       scs_free(d->b);
     }
-    if (d->c) {
+    if (md->c_copied && d->c) {
       scs_free(d->c);
     }
-#endif
-    if (d->A) {
-#ifndef DLONG /* only free if copies, which is only when flags set */
-      if (d->A->p) {
-        scs_free(d->A->p);
-      }
-      if (d->A->i) {
-        scs_free(d->A->i);
-      }
-#endif
-#ifdef SFLOAT /* only free if copies, which is only when flags set */
-      if (d->A->x) {
-        scs_free(d->A->x);
-      }
-#endif
-      scs_free(d->A);
-    }
-    if (d->P) {
-#ifndef DLONG /* only free if copies, which is only when flags set */
-      if (d->P->p) {
-        scs_free(d->P->p);
-      }
-      if (d->P->i) {
-        scs_free(d->P->i);
-      }
-#endif
-#ifdef SFLOAT /* only free if copies, which is only when flags set */
-      if (d->P->x) {
-        scs_free(d->P->x);
-      }
-#endif
-      scs_free(d->P);
-    }
+    free_mex_matrix(d->A, md->A_built);
+    free_mex_matrix(d->P, md->P_built);
     scs_free(d);
   }
 }
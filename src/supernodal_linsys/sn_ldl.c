@@ -0,0 +1,989 @@
+#include "sn_ldl.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+#ifdef USE_LAPACK
+#include "scs_blas.h"
+
+void BLAS(gemm)(const char *transa, const char *transb, blas_int *m,
+                blas_int *n, blas_int *k, const scs_float *alpha,
+                const scs_float *a, blas_int *lda, const scs_float *b,
+                blas_int *ldb, const scs_float *beta, scs_float *c,
+                blas_int *ldc);
+void BLAS(gemv)(const char *trans, const blas_int *m, const blas_int *n,
+                const scs_float *alpha, const scs_float *a,
+                const blas_int *lda, const scs_float *x,
+                const blas_int *incx, const scs_float *beta, scs_float *y,
+                const blas_int *incy);
+void BLAS(trsv)(const char *uplo, const char *trans, const char *diag,
+                const blas_int *n, const scs_float *a, const blas_int *lda,
+                scs_float *x, const blas_int *incx);
+#endif
+
+/* Width of the panels the pivot block of a front is factorized in */
+#define SN_PANEL (64)
+/* Dense kernels below these sizes (multiply-adds) are plain loops; the BLAS
+ * call overhead dominates on the many tiny supernodes */
+#define SN_BLAS3_MIN (4096)
+#define SN_BLAS2_MIN (1024)
+/* A subtree is factorized by one thread once its work is below the total
+ * over this many times the thread count */
+#define SN_SUBTREES_PER_THREAD (4)
+
+struct SnLdl {
+  scs_int n, nnz;
+  scs_int *perm, *pinv;  /* new -> old and old -> new, postordered */
+
+  scs_int n_super;
+  scs_int *sn_start;     /* columns sn_start[s] .. sn_start[s + 1] - 1 */
+  scs_int *sn_parent;    /* -1 for roots; sn_parent[s] > s (postorder) */
+  scs_int *child_ptr, *child; /* children of s in child[child_ptr[s]..] */
+  scs_int *row_ptr;      /* rows below supernode s (sorted) are */
+  scs_int *rows;         /* rows[row_ptr[s] .. row_ptr[s + 1] - 1] ... */
+  scs_int *rel;          /* ... at these positions of the parent front */
+  size_t *L_ptr;         /* block of s is L[L_ptr[s]], height x ncols */
+  scs_int *asm_ptr;      /* input entries of supernode s: */
+  scs_int *asm_src;      /* Ax[asm_src[k]] adds to the block of s */
+  size_t *asm_dst;       /* at offset asm_dst[k], k in asm_ptr[s].. */
+  size_t work_len;       /* scratch per front (largest over supernodes) */
+  scs_int max_below;     /* most rows below a supernode */
+
+  /* Schedule: subtrees (root sub_root[t], supernodes sub_first[t] ..
+   * sub_root[t]) run in parallel, then the top supernodes in order */
+  scs_int threads, n_subtrees, n_top;
+  scs_int *sub_root, *sub_first, *top;
+
+  scs_float *L;          /* dense supernode blocks */
+  scs_float *d;          /* D, in the permuted order */
+  scs_float **U;         /* update matrices waiting for their parent */
+  scs_float *x, *tmp;    /* solve workspaces */
+  scs_float L_nnz, flops;
+};
+
+void sn_ldl_default_opts(SnLdlOpts *opts) {
+  opts->threads = 0;
+}
+
+/* ======================== Symbolic phase ======================== */
+
+/* Upper triangle pattern (Cp, Ci) of A(perm, perm) from either triangle
+ * of A; every column is counted in cnt (length n). */
+static void permuted_upper(scs_int n, const scs_int *Ap, const scs_int *Ai,
+                           const scs_int *pinv, scs_int *Cp, scs_int *Ci,
+                           scs_int *cnt) {
+  scs_int i, j, k, a, b;
+
+  memset(cnt, 0, n * sizeof(scs_int));
+  for (j = 0; j < n; j++) {
+    for (k = Ap[j]; k < Ap[j + 1]; k++) {
+      a = pinv[Ai[k]];
+      b = pinv[j];
+      cnt[MAX(a, b)]++;
+    }
+  }
+  Cp[0] = 0;
+  for (j = 0; j < n; j++) {
+    Cp[j + 1] = Cp[j] + cnt[j];
+    cnt[j] = Cp[j];
+  }
+  for (j = 0; j < n; j++) {
+    for (k = Ap[j]; k < Ap[j + 1]; k++) {
+      a = pinv[Ai[k]];
+      b = pinv[j];
+      i = MAX(a, b);
+      Ci[cnt[i]++] = MIN(a, b);
+    }
+  }
+}
+
+/* Elimination tree of the upper triangle pattern Cp, Ci (Liu's algorithm
+ * with path compression). */
+static void etree(scs_int n, const scs_int *Cp, const scs_int *Ci,
+                  scs_int *parent, scs_int *ancestor) {
+  scs_int i, k, p, inext;
+
+  for (k = 0; k < n; k++) {
+    parent[k] = -1;
+    ancestor[k] = -1;
+    for (p = Cp[k]; p < Cp[k + 1]; p++) {
+      for (i = Ci[p]; i != -1 && i < k; i = inext) {
+        inext = ancestor[i];
+        ancestor[i] = k;
+        if (inext == -1) {
+          parent[i] = k;
+        }
+      }
+    }
+  }
+}
+
+/* Postorder of the forest parent; head, next and stack have length n. */
+static void postorder(scs_int n, const scs_int *parent, scs_int *post,
+                      scs_int *head, scs_int *next, scs_int *stack) {
+  scs_int j, k = 0, top, i, c;
+
+  for (j = 0; j < n; j++) {
+    head[j] = -1;
+  }
+  for (j = n - 1; j >= 0; j--) {
+    if (parent[j] != -1) {
+      next[j] = head[parent[j]];
+      head[parent[j]] = j;
+    }
+  }
+  for (j = 0; j < n; j++) {
+    if (parent[j] != -1) {
+      continue;
+    }
+    top = 0;
+    stack[0] = j;
+    while (top >= 0) {
+      i = stack[top];
+      c = head[i];
+      if (c == -1) {
+        top--;
+        post[k++] = i;
+      } else {
+        head[i] = next[c];
+        stack[++top] = c;
+      }
+    }
+  }
+}
+
+/* Entries of the lower trapezoid of a supernode with nc columns and nb rows
+ * below them, diagonal included */
+static scs_float block_entries(scs_float nc, scs_float nb) {
+  return nc * (nc + 1) / 2 + nc * nb;
+}
+
+/* Relaxed amalgamation thresholds (as CHOLMOD's defaults): merging is
+ * always allowed up to 4 columns, and up to 16 and 48 columns, or without
+ * a limit, while at most 80%, 10% and 5% of the merged entries are
+ * explicit zeros. */
+static scs_int relax_ok(scs_int ncols, scs_float zeros, scs_float total) {
+  scs_float frac = zeros / total;
+  return ncols <= 4 || (ncols <= 16 && frac < 0.8) ||
+         (ncols <= 48 && frac < 0.1) || frac < 0.05;
+}
+
+static int cmp_int(const void *a, const void *b) {
+  scs_int x = *(const scs_int *)a, y = *(const scs_int *)b;
+  return (x > y) - (x < y);
+}
+
+typedef struct {
+  scs_float work;
+  scs_int root;
+} SnSubtree;
+
+static int cmp_subtree(const void *a, const void *b) {
+  scs_float x = ((const SnSubtree *)a)->work;
+  scs_float y = ((const SnSubtree *)b)->work;
+  return (x < y) - (x > y); /* largest first */
+}
+
+/* Supernodes, row structures, scatter maps and schedule for the postordered
+ * pattern Cp, Ci with elimination tree parent. Returns -1 if out of
+ * memory. */
+static scs_int supernodes(SnLdl *f, const scs_int *Cp, const scs_int *Ci,
+                          const scs_int *parent, scs_int *iw) {
+  scs_int n = f->n;
+  scs_int i, j, k, p, s, c, t, first, last, nc, nb;
+  scs_int *colcount = iw, *mark = iw + n, *nchild = iw + 2 * n;
+  scs_int *snode = iw + 3 * n, *pos = iw + 4 * n;
+  scs_int *fs_start = SCS_NULL, *fs_nb = SCS_NULL;
+  scs_float *fs_zeros = SCS_NULL, *sub_work = SCS_NULL;
+  scs_int *fd = SCS_NULL;
+  SnSubtree *subs = SCS_NULL;
+  scs_int n_fund, n_super = 0;
+  scs_float total = 0.0, target;
+  scs_int status = -1;
+
+  /* column counts of L (below the diagonal) from the row subtrees */
+  for (j = 0; j < n; j++) {
+    colcount[j] = 0;
+    mark[j] = -1;
+    nchild[j] = 0;
+  }
+  for (k = 0; k < n; k++) {
+    mark[k] = k;
+    for (p = Cp[k]; p < Cp[k + 1]; p++) {
+      for (j = Ci[p]; mark[j] != k; j = parent[j]) {
+        colcount[j]++;
+        mark[j] = k;
+      }
+    }
+    if (parent[k] != -1) {
+      nchild[parent[k]]++;
+    }
+  }
+
+  /* fundamental supernodes */
+  fs_start = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  fs_nb = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  fs_zeros = (scs_float *)malloc((n + 1) * sizeof(scs_float));
+  if (!fs_start || !fs_nb || !fs_zeros) {
+    goto out;
+  }
+  n_fund = 0;
+  for (j = 0; j < n; j++) {
+    if (j == 0 || parent[j - 1] != j || colcount[j - 1] != colcount[j] + 1 ||
+        nchild[j] != 1) {
+      fs_start[n_fund++] = j;
+    }
+  }
+  fs_start[n_fund] = n;
+
+  /* relaxed amalgamation: merge the previous (merged) supernode into the
+   * current one while it is a child of it and few zeros are added */
+  for (s = 0; s < n_fund; s++) {
+    first = fs_start[s];
+    last = fs_start[s + 1] - 1;
+    nb = colcount[last];
+    fs_start[n_super] = first;
+    fs_nb[n_super] = nb;
+    fs_zeros[n_super] = 0.0;
+    while (n_super > 0) {
+      scs_int pf = fs_start[n_super - 1], pl = first - 1;
+      scs_int pnc = pl - pf + 1, cnc = last - first + 1;
+      scs_float merged, zeros;
+      if (parent[pl] < first || parent[pl] > last) {
+        break;
+      }
+      merged = block_entries(pnc + cnc, nb);
+      zeros = fs_zeros[n_super - 1] + fs_zeros[n_super] + merged -
+              block_entries(pnc, fs_nb[n_super - 1]) -
+              block_entries(cnc, nb);
+      if (!relax_ok(pnc + cnc, zeros, merged)) {
+        break;
+      }
+      n_super--;
+      first = pf;
+      fs_start[n_super] = first;
+      fs_nb[n_super] = nb;
+      fs_zeros[n_super] = zeros;
+    }
+    n_super++;
+  }
+  fs_start[n_super] = n;
+
+  f->n_super = n_super;
+  f->sn_start = (scs_int *)malloc((n_super + 1) * sizeof(scs_int));
+  f->sn_parent = (scs_int *)malloc(n_super * sizeof(scs_int));
+  f->child_ptr = (scs_int *)calloc(n_super + 1, sizeof(scs_int));
+  f->child = (scs_int *)malloc(n_super * sizeof(scs_int));
+  f->row_ptr = (scs_int *)malloc((n_super + 1) * sizeof(scs_int));
+  f->L_ptr = (size_t *)malloc((n_super + 1) * sizeof(size_t));
+  f->asm_ptr = (scs_int *)calloc(n_super + 1, sizeof(scs_int));
+  f->asm_src = (scs_int *)malloc((f->nnz + 1) * sizeof(scs_int));
+  f->asm_dst = (size_t *)malloc((f->nnz + 1) * sizeof(size_t));
+  f->U = (scs_float **)calloc(n_super, sizeof(scs_float *));
+  sub_work = (scs_float *)calloc(n_super, sizeof(scs_float));
+  fd = (scs_int *)malloc(n_super * sizeof(scs_int));
+  subs = (SnSubtree *)malloc(n_super * sizeof(SnSubtree));
+  if (!f->sn_start || !f->sn_parent || !f->child_ptr || !f->child ||
+      !f->row_ptr || !f->L_ptr || !f->asm_ptr || !f->asm_src ||
+      !f->asm_dst || !f->U || !sub_work || !fd || !subs) {
+    goto out;
+  }
+
+  /* supernodal tree and block layout */
+  f->row_ptr[0] = 0;
+  f->L_ptr[0] = 0;
+  f->work_len = 1;
+  f->max_below = 0;
+  f->L_nnz = 0.0;
+  f->flops = 0.0;
+  for (s = 0; s < n_super; s++) {
+    first = fs_start[s];
+    last = fs_start[s + 1] - 1;
+    nc = last - first + 1;
+    nb = fs_nb[s];
+    f->sn_start[s] = first;
+    for (j = first; j <= last; j++) {
+      snode[j] = s;
+    }
+    f->row_ptr[s + 1] = f->row_ptr[s] + nb;
+    f->L_ptr[s + 1] = f->L_ptr[s] + (size_t)(nc + nb) * nc;
+    f->work_len = MAX(f->work_len, (size_t)nc * MIN(nc, SN_PANEL));
+    f->work_len = MAX(f->work_len, (size_t)nb * nc);
+    f->max_below = MAX(f->max_below, nb);
+    f->L_nnz += block_entries(nc, nb) - nc;
+    for (k = 0; k < nc; k++) {
+      scs_float below = (scs_float)(nc + nb - k - 1);
+      f->flops += below * (below + 3) / 2;
+    }
+  }
+  f->sn_start[n_super] = n;
+  for (s = 0; s < n_super; s++) {
+    last = f->sn_start[s + 1] - 1;
+    f->sn_parent[s] = parent[last] == -1 ? -1 : snode[parent[last]];
+    if (f->sn_parent[s] != -1) {
+      f->child_ptr[f->sn_parent[s] + 1]++;
+    }
+  }
+  for (s = 0; s < n_super; s++) {
+    f->child_ptr[s + 1] += f->child_ptr[s];
+    pos[s] = f->child_ptr[s];
+  }
+  for (s = 0; s < n_super; s++) {
+    if (f->sn_parent[s] != -1) {
+      f->child[pos[f->sn_parent[s]]++] = s;
+    }
+  }
+
+  f->rows = (scs_int *)malloc((f->row_ptr[n_super] + 1) * sizeof(scs_int));
+  f->rel = (scs_int *)malloc((f->row_ptr[n_super] + 1) * sizeof(scs_int));
+  if (!f->rows || !f->rel) {
+    goto out;
+  }
+
+  /* Row structure of s: rows below s of its entries and of its children's
+   * structures. Entry (i, j), i < j, of the upper pattern is (j, i) of the
+   * lower triangle, in supernode snode[i]; bucket them by supernode. */
+  for (j = 0; j < n; j++) {
+    mark[j] = -1;
+  }
+  for (k = 0; k < n; k++) {
+    for (p = Cp[k]; p < Cp[k + 1]; p++) {
+      f->asm_ptr[snode[Ci[p]] + 1]++;
+    }
+  }
+  for (s = 0; s < n_super; s++) {
+    f->asm_ptr[s + 1] += f->asm_ptr[s];
+    pos[s] = f->asm_ptr[s];
+  }
+  for (k = 0; k < n; k++) {
+    for (p = Cp[k]; p < Cp[k + 1]; p++) {
+      f->asm_src[pos[snode[Ci[p]]]++] = p; /* position in Ci for now */
+    }
+  }
+  for (s = 0; s < n_super; s++) {
+    scs_int cnt = 0, cap = f->row_ptr[s + 1] - f->row_ptr[s];
+    scs_int *r = f->rows + f->row_ptr[s];
+    last = f->sn_start[s + 1] - 1;
+    for (t = f->asm_ptr[s]; t < f->asm_ptr[s + 1]; t++) {
+      /* the row of entry p is the column it sits in, found by bisection */
+      scs_int lo = 0, hi = n - 1, q = f->asm_src[t];
+      while (lo < hi) {
+        scs_int mid = (lo + hi + 1) / 2;
+        if (Cp[mid] <= q) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      i = lo;
+      if (i > last && mark[i] != s) {
+        if (cnt == cap) {
+          goto out; /* cannot happen for a consistent analysis */
+        }
+        mark[i] = s;
+        r[cnt++] = i;
+      }
+    }
+    for (t = f->child_ptr[s]; t < f->child_ptr[s + 1]; t++) {
+      c = f->child[t];
+      for (p = f->row_ptr[c]; p < f->row_ptr[c + 1]; p++) {
+        i = f->rows[p];
+        if (i > last && mark[i] != s) {
+          if (cnt == cap) {
+            goto out;
+          }
+          mark[i] = s;
+          r[cnt++] = i;
+        }
+      }
+    }
+    if (cnt != cap) {
+      goto out;
+    }
+    qsort(r, cnt, sizeof(scs_int), cmp_int);
+  }
+
+  /* positions in the fronts: of the children's rows in their parent and of
+   * the input entries in their supernode block */
+  for (s = 0; s < n_super; s++) {
+    first = f->sn_start[s];
+    last = f->sn_start[s + 1] - 1;
+    nc = last - first + 1;
+    for (j = first; j <= last; j++) {
+      pos[j] = j - first;
+    }
+    for (p = f->row_ptr[s]; p < f->row_ptr[s + 1]; p++) {
+      pos[f->rows[p]] = nc + p - f->row_ptr[s];
+    }
+    for (t = f->child_ptr[s]; t < f->child_ptr[s + 1]; t++) {
+      c = f->child[t];
+      for (p = f->row_ptr[c]; p < f->row_ptr[c + 1]; p++) {
+        f->rel[p] = pos[f->rows[p]];
+      }
+    }
+  }
+  for (s = 0; s < n_super; s++) {
+    scs_int h;
+    first = f->sn_start[s];
+    last = f->sn_start[s + 1] - 1;
+    nc = last - first + 1;
+    h = nc + f->row_ptr[s + 1] - f->row_ptr[s];
+    for (j = first; j <= last; j++) {
+      pos[j] = j - first;
+    }
+    for (p = f->row_ptr[s]; p < f->row_ptr[s + 1]; p++) {
+      pos[f->rows[p]] = nc + p - f->row_ptr[s];
+    }
+    for (t = f->asm_ptr[s]; t < f->asm_ptr[s + 1]; t++) {
+      scs_int lo = 0, hi = n - 1, q = f->asm_src[t];
+      while (lo < hi) {
+        scs_int mid = (lo + hi + 1) / 2;
+        if (Cp[mid] <= q) {
+          lo = mid;
+        } else {
+          hi = mid - 1;
+        }
+      }
+      /* entry (Ci[q], lo) of the upper pattern is L(lo, Ci[q]) */
+      f->asm_dst[t] = (size_t)pos[lo] + (size_t)(Ci[q] - first) * h;
+    }
+  }
+
+  /* schedule: work of every subtree, then the subtrees below the target */
+  for (s = 0; s < n_super; s++) {
+    scs_float h;
+    nc = f->sn_start[s + 1] - f->sn_start[s];
+    h = (scs_float)(nc + f->row_ptr[s + 1] - f->row_ptr[s]);
+    sub_work[s] += nc * h * h + 1.0;
+    fd[s] = s;
+  }
+  for (s = 0; s < n_super; s++) {
+    if (f->sn_parent[s] != -1) {
+      sub_work[f->sn_parent[s]] += sub_work[s];
+      fd[f->sn_parent[s]] = MIN(fd[f->sn_parent[s]], fd[s]);
+    }
+    if (f->sn_parent[s] == -1) {
+      total += sub_work[s];
+    }
+  }
+  f->sub_root = (scs_int *)malloc(n_super * sizeof(scs_int));
+  f->sub_first = (scs_int *)malloc(n_super * sizeof(scs_int));
+  f->top = (scs_int *)malloc(n_super * sizeof(scs_int));
+  if (!f->sub_root || !f->sub_first || !f->top) {
+    goto out;
+  }
+  f->n_subtrees = 0;
+  f->n_top = 0;
+  target = f->threads > 1 ? total / (SN_SUBTREES_PER_THREAD * f->threads)
+                          : -1.0;
+  for (s = 0; s < n_super; s++) {
+    scs_int ps = f->sn_parent[s];
+    if (sub_work[s] > target) {
+      f->top[f->n_top++] = s;
+    } else if (ps == -1 || sub_work[ps] > target) {
+      subs[f->n_subtrees].work = sub_work[s];
+      subs[f->n_subtrees].root = s;
+      f->n_subtrees++;
+    }
+  }
+  qsort(subs, f->n_subtrees, sizeof(SnSubtree), cmp_subtree);
+  for (t = 0; t < f->n_subtrees; t++) {
+    f->sub_root[t] = subs[t].root;
+    f->sub_first[t] = fd[subs[t].root];
+  }
+  status = 0;
+
+out:
+  free(fs_start);
+  free(fs_nb);
+  free(fs_zeros);
+  free(sub_work);
+  free(fd);
+  free(subs);
+  return status;
+}
+
+SnLdl *sn_ldl_analyse(scs_int n, const scs_int *Ap, const scs_int *Ai,
+                      const scs_int *perm, const SnLdlOpts *opts) {
+  scs_int nnz = Ap[n];
+  scs_int j;
+  scs_int *Cp, *Ci, *iw, *parent, *post;
+  SnLdl *f = (SnLdl *)calloc(1, sizeof(SnLdl));
+
+  if (!f) {
+    return SCS_NULL;
+  }
+  f->n = n;
+  f->nnz = nnz;
+#ifdef _OPENMP
+  f->threads = opts->threads > 0 ? opts->threads : omp_get_max_threads();
+#else
+  (void)opts;
+  f->threads = 1;
+#endif
+  f->perm = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  f->pinv = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  f->d = (scs_float *)malloc((n + 1) * sizeof(scs_float));
+  f->x = (scs_float *)malloc((n + 1) * sizeof(scs_float));
+  Cp = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  Ci = (scs_int *)malloc((nnz + 1) * sizeof(scs_int));
+  parent = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  post = (scs_int *)malloc((n + 1) * sizeof(scs_int));
+  iw = (scs_int *)malloc((5 * n + 1) * sizeof(scs_int));
+  if (!f->perm || !f->pinv || !f->d || !f->x || !Cp || !Ci || !parent ||
+      !post || !iw) {
+    goto fail;
+  }
+
+  /* the given ordering, then its etree postorder on top */
+  for (j = 0; j < n; j++) {
+    f->perm[j] = perm ? perm[j] : j;
+    f->pinv[f->perm[j]] = j;
+  }
+  permuted_upper(n, Ap, Ai, f->pinv, Cp, Ci, iw);
+  etree(n, Cp, Ci, parent, iw);
+  postorder(n, parent, post, iw, iw + n, iw + 2 * n);
+  for (j = 0; j < n; j++) {
+    iw[j] = f->perm[post[j]];
+  }
+  for (j = 0; j < n; j++) {
+    f->perm[j] = iw[j];
+    f->pinv[f->perm[j]] = j;
+  }
+  permuted_upper(n, Ap, Ai, f->pinv, Cp, Ci, iw);
+  etree(n, Cp, Ci, parent, iw);
+
+  if (supernodes(f, Cp, Ci, parent, iw) < 0) {
+    goto fail;
+  }
+  /* asm_src indexes Ci so far: map it to the input entries, which
+   * permuted_upper visited in the same order as it filled Ci */
+  {
+    scs_int k, a, b, i;
+    scs_int *next = iw;
+    scs_int *src = (scs_int *)malloc((nnz + 1) * sizeof(scs_int));
+    if (!src) {
+      goto fail;
+    }
+    for (j = 0; j < n; j++) {
+      next[j] = Cp[j];
+    }
+    for (j = 0; j < n; j++) {
+      for (k = Ap[j]; k < Ap[j + 1]; k++) {
+        a = f->pinv[Ai[k]];
+        b = f->pinv[j];
+        i = MAX(a, b);
+        src[next[i]++] = k;
+      }
+    }
+    for (k = 0; k < nnz; k++) {
+      f->asm_src[k] = src[f->asm_src[k]];
+    }
+    free(src);
+  }
+
+  f->L = (scs_float *)malloc((f->L_ptr[f->n_super] + 1) * sizeof(scs_float));
+  f->tmp = (scs_float *)malloc((f->max_below + 1) * sizeof(scs_float));
+  if (!f->L || !f->tmp) {
+    goto fail;
+  }
+  free(Cp);
+  free(Ci);
+  free(parent);
+  free(post);
+  free(iw);
+  return f;
+
+fail:
+  free(Cp);
+  free(Ci);
+  free(parent);
+  free(post);
+  free(iw);
+  sn_ldl_free(f);
+  return SCS_NULL;
+}
+
+/* ======================== Numeric phase ======================== */
+
+/* C -= A * B' with C M x N, A M x K and B N x K, all column-major */
+static void gemm_nt(scs_int M, scs_int N, scs_int K, const scs_float *A,
+                    scs_int lda, const scs_float *B, scs_int ldb,
+                    scs_float *C, scs_int ldc) {
+  scs_int i, j, k;
+#ifdef USE_LAPACK
+  if ((scs_float)M * N * K >= SN_BLAS3_MIN) {
+    blas_int bm = (blas_int)M, bn = (blas_int)N, bk = (blas_int)K;
+    blas_int blda = (blas_int)lda, bldb = (blas_int)ldb, bldc = (blas_int)ldc;
+    scs_float neg_one = -1.0, one = 1.0;
+    BLAS(gemm)("N", "T", &bm, &bn, &bk, &neg_one, A, &blda, B, &bldb, &one, C,
+               &bldc);
+    return;
+  }
+#endif
+  for (j = 0; j < N; j++) {
+    scs_float *Cj = C + (size_t)j * ldc;
+    for (k = 0; k < K; k++) {
+      const scs_float *Ak = A + (size_t)k * lda;
+      scs_float b = B[j + (size_t)k * ldb];
+      if (b == 0.0) {
+        continue;
+      }
+      for (i = 0; i < M; i++) {
+        Cj[i] -= Ak[i] * b;
+      }
+    }
+  }
+}
+
+/* LDL' of the front whose first nc columns (height h, leading dimension h)
+ * are L and whose trailing nb x nb block (nb = h - nc) is U: L becomes the
+ * unit lower trapezoid with D on the diagonal of d, and U the Schur
+ * complement minus its current value. Only lower triangles are read. W has
+ * work_len entries. Returns -1 on a zero or non-finite pivot. */
+static scs_int factor_front(scs_int h, scs_int nc, scs_float *L, scs_float *d,
+                            scs_float *U, scs_float *W) {
+  scs_int nb = h - nc;
+  scs_int i, j, k, k0, k1, nt;
+  scs_float dk, ljk, inv;
+
+  for (k0 = 0; k0 < nc; k0 += SN_PANEL) {
+    k1 = MIN(k0 + SN_PANEL, nc);
+    for (k = k0; k < k1; k++) {
+      scs_float *Lk = L + (size_t)k * h;
+      dk = Lk[k];
+      if (dk == 0.0 || !isfinite(dk)) {
+        return -1;
+      }
+      d[k] = dk;
+      for (j = k + 1; j < k1; j++) {
+        scs_float *Lj = L + (size_t)j * h;
+        ljk = Lk[j] / dk;
+        for (i = j; i < h; i++) {
+          Lj[i] -= Lk[i] * ljk;
+        }
+      }
+      inv = 1.0 / dk;
+      for (i = k + 1; i < h; i++) {
+        Lk[i] *= inv;
+      }
+    }
+    /* remaining pivot columns: L(k1:h, k1:nc) -= L(k1:h, panel) * W' with
+     * W = L(k1:nc, panel) * D(panel) */
+    nt = nc - k1;
+    if (nt > 0) {
+      for (k = k0; k < k1; k++) {
+        for (j = 0; j < nt; j++) {
+          W[j + (size_t)(k - k0) * nt] = L[k1 + j + (size_t)k * h] * d[k];
+        }
+      }
+      gemm_nt(h - k1, nt, k1 - k0, L + k1 + (size_t)k0 * h, h, W, nt,
+              L + k1 + (size_t)k1 * h, h);
+    }
+  }
+  if (nb > 0) {
+    /* U -= L21 * D * L21', lower triangle by column blocks */
+    for (k = 0; k < nc; k++) {
+      for (i = 0; i < nb; i++) {
+        W[i + (size_t)k * nb] = L[nc + i + (size_t)k * h] * d[k];
+      }
+    }
+    for (j = 0; j < nb; j += SN_PANEL) {
+      nt = MIN(SN_PANEL, nb - j);
+      gemm_nt(nb - j, nt, nc, L + nc + j, h, W + j, nb,
+              U + j + (size_t)j * nb, nb);
+    }
+  }
+  return 0;
+}
+
+/* Assemble and factorize supernode s once all its children are done.
+ * Returns 0, -1 (pivot) or -2 (memory). */
+static scs_int factor_supernode(SnLdl *f, scs_int s, const scs_float *Ax,
+                                scs_float *W) {
+  scs_int first = f->sn_start[s];
+  scs_int nc = f->sn_start[s + 1] - first;
+  scs_int nb = f->row_ptr[s + 1] - f->row_ptr[s];
+  scs_int h = nc + nb;
+  scs_float *Ls = f->L + f->L_ptr[s];
+  scs_float *U = SCS_NULL;
+  scs_int i, j, t, k, c, nbc, ci, cj;
+
+  memset(Ls, 0, (size_t)h * nc * sizeof(scs_float));
+  for (k = f->asm_ptr[s]; k < f->asm_ptr[s + 1]; k++) {
+    Ls[f->asm_dst[k]] += Ax[f->asm_src[k]];
+  }
+  if (nb > 0) {
+    U = (scs_float *)calloc((size_t)nb * nb, sizeof(scs_float));
+    if (!U) {
+      return -2;
+    }
+  }
+  /* extend-add the children's update matrices */
+  for (t = f->child_ptr[s]; t < f->child_ptr[s + 1]; t++) {
+    const scs_int *rel;
+    const scs_float *Uc;
+    c = f->child[t];
+    Uc = f->U[c];
+    if (!Uc) {
+      continue;
+    }
+    rel = f->rel + f->row_ptr[c];
+    nbc = f->row_ptr[c + 1] - f->row_ptr[c];
+    for (j = 0; j < nbc; j++) {
+      const scs_float *Ucj = Uc + (size_t)j * nbc;
+      cj = rel[j];
+      if (cj < nc) {
+        scs_float *col = Ls + (size_t)cj * h;
+        for (i = j; i < nbc; i++) {
+          col[rel[i]] += Ucj[i];
+        }
+      } else {
+        scs_float *col = U + (size_t)(cj - nc) * nb - nc;
+        for (i = j; i < nbc; i++) {
+          ci = rel[i];
+          col[ci] += Ucj[i];
+        }
+      }
+    }
+    free(f->U[c]);
+    f->U[c] = SCS_NULL;
+  }
+  if (factor_front(h, nc, Ls, f->d + first, U, W) < 0) {
+    free(U);
+    return -1;
+  }
+  f->U[s] = U;
+  return 0;
+}
+
+scs_int sn_ldl_factor(SnLdl *f, const scs_float *Ax) {
+  scs_int status = 0, t, s;
+  scs_float *W;
+
+  if (f->n == 0) {
+    return 0;
+  }
+#ifdef _OPENMP
+  if (f->n_subtrees > 1) {
+#pragma omp parallel num_threads(f->threads) private(t, s, W)
+    {
+      W = (scs_float *)malloc(f->work_len * sizeof(scs_float));
+#pragma omp for schedule(dynamic, 1)
+      for (t = 0; t < f->n_subtrees; t++) {
+        scs_int st = 0;
+        if (!W) {
+          st = -2;
+        }
+        /* postorder: the supernodes of a subtree are the index range up to
+         * its root, children first */
+        for (s = f->sub_first[t]; st == 0 && s <= f->sub_root[t]; s++) {
+          st = factor_supernode(f, s, Ax, W);
+        }
+        if (st < 0) {
+#pragma omp critical(sn_ldl_status)
+          if (status == 0 || st == -2) {
+            status = st;
+          }
+        }
+      }
+      free(W);
+    }
+  } else
+#endif
+  {
+    W = (scs_float *)malloc(f->work_len * sizeof(scs_float));
+    if (!W) {
+      return -2;
+    }
+    for (t = 0; status == 0 && t < f->n_subtrees; t++) {
+      for (s = f->sub_first[t]; status == 0 && s <= f->sub_root[t]; s++) {
+        status = factor_supernode(f, s, Ax, W);
+      }
+    }
+    free(W);
+  }
+
+  if (status == 0) {
+    W = (scs_float *)malloc(f->work_len * sizeof(scs_float));
+    if (!W) {
+      status = -2;
+    }
+    for (t = 0; status == 0 && t < f->n_top; t++) {
+      status = factor_supernode(f, f->top[t], Ax, W);
+    }
+    free(W);
+  }
+
+  /* update matrices left over after a failure (roots have none) */
+  for (s = 0; s < f->n_super; s++) {
+    free(f->U[s]);
+    f->U[s] = SCS_NULL;
+  }
+  return status;
+}
+
+/* ======================== Solve ======================== */
+
+void sn_ldl_solve(SnLdl *f, scs_float *b) {
+  scs_float *x = f->x, *tmp = f->tmp;
+  scs_int n = f->n;
+  scs_int s, i, k, t, first, nc, nb, h;
+  const scs_int *rows;
+  const scs_float *Ls;
+
+  for (k = 0; k < n; k++) {
+    x[k] = b[f->perm[k]];
+  }
+
+  /* L y = b */
+  for (s = 0; s < f->n_super; s++) {
+    scs_float *xs;
+    first = f->sn_start[s];
+    nc = f->sn_start[s + 1] - first;
+    nb = f->row_ptr[s + 1] - f->row_ptr[s];
+    h = nc + nb;
+    Ls = f->L + f->L_ptr[s];
+    rows = f->rows + f->row_ptr[s];
+    xs = x + first;
+#ifdef USE_LAPACK
+    if ((scs_float)nc * h >= SN_BLAS2_MIN) {
+      blas_int bnc = (blas_int)nc, bnb = (blas_int)nb, bh = (blas_int)h;
+      blas_int one = 1;
+      scs_float fone = 1.0, zero = 0.0;
+      BLAS(trsv)("L", "N", "U", &bnc, Ls, &bh, xs, &one);
+      if (nb > 0) {
+        BLAS(gemv)("N", &bnb, &bnc, &fone, Ls + nc, &bh, xs, &one, &zero, tmp,
+                   &one);
+        for (t = 0; t < nb; t++) {
+          x[rows[t]] -= tmp[t];
+        }
+      }
+      continue;
+    }
+#endif
+    for (k = 0; k < nc; k++) {
+      const scs_float *Lk = Ls + (size_t)k * h;
+      scs_float xk = xs[k];
+      if (xk == 0.0) {
+        continue;
+      }
+      for (i = k + 1; i < nc; i++) {
+        xs[i] -= Lk[i] * xk;
+      }
+      for (t = 0; t < nb; t++) {
+        x[rows[t]] -= Lk[nc + t] * xk;
+      }
+    }
+  }
+
+  /* D z = y */
+  for (k = 0; k < n; k++) {
+    x[k] /= f->d[k];
+  }
+
+  /* L' x = z */
+  for (s = f->n_super - 1; s >= 0; s--) {
+    scs_float *xs;
+    first = f->sn_start[s];
+    nc = f->sn_start[s + 1] - first;
+    nb = f->row_ptr[s + 1] - f->row_ptr[s];
+    h = nc + nb;
+    Ls = f->L + f->L_ptr[s];
+    rows = f->rows + f->row_ptr[s];
+    xs = x + first;
+    for (t = 0; t < nb; t++) {
+      tmp[t] = x[rows[t]];
+    }
+#ifdef USE_LAPACK
+    if ((scs_float)nc * h >= SN_BLAS2_MIN) {
+      blas_int bnc = (blas_int)nc, bnb = (blas_int)nb, bh = (blas_int)h;
+      blas_int one = 1;
+      scs_float neg_one = -1.0, fone = 1.0;
+      if (nb > 0) {
+        BLAS(gemv)("T", &bnb, &bnc, &neg_one, Ls + nc, &bh, tmp, &one, &fone,
+                   xs, &one);
+      }
+      BLAS(trsv)("L", "T", "U", &bnc, Ls, &bh, xs, &one);
+      continue;
+    }
+#endif
+    for (k = nc - 1; k >= 0; k--) {
+      const scs_float *Lk = Ls + (size_t)k * h;
+      scs_float acc = xs[k];
+      for (t = 0; t < nb; t++) {
+        acc -= Lk[nc + t] * tmp[t];
+      }
+      for (i = k + 1; i < nc; i++) {
+        acc -= Lk[i] * xs[i];
+      }
+      xs[k] = acc;
+    }
+  }
+
+  for (k = 0; k < n; k++) {
+    b[f->perm[k]] = x[k];
+  }
+}
+
+void sn_ldl_get_info(const SnLdl *f, SnLdlInfo *info) {
+  size_t I = sizeof(scs_int), F = sizeof(scs_float), S = f->n_super;
+  scs_int s;
+
+  memset(info, 0, sizeof(SnLdlInfo));
+  info->n = f->n;
+  info->nnz = f->nnz;
+  info->n_super = f->n_super;
+  info->n_subtrees = f->n_subtrees;
+  info->threads = f->threads;
+  info->L_nnz = f->L_nnz;
+  info->flops = f->flops;
+  for (s = 0; s < f->n_super; s++) {
+    info->max_cols = MAX(info->max_cols, f->sn_start[s + 1] - f->sn_start[s]);
+  }
+  /* perm, pinv; supernodes, tree, rows and rel; scatter maps; schedule */
+  info->symbolic_bytes = 2 * (size_t)f->n * I + (6 * S + 4) * I +
+                         2 * (size_t)f->row_ptr[S] * I + S * sizeof(size_t) +
+                         (size_t)f->nnz * (I + sizeof(size_t)) + 3 * S * I +
+                         S * sizeof(scs_float *);
+  info->factor_bytes = (f->L_ptr[S] + (size_t)f->n) * F;
+  info->solve_bytes = ((size_t)f->n + f->max_below) * F;
+}
+
+void sn_ldl_free(SnLdl *f) {
+  scs_int s;
+  if (!f) {
+    return;
+  }
+  if (f->U) {
+    for (s = 0; s < f->n_super; s++) {
+      free(f->U[s]);
+    }
+  }
+  free(f->perm);
+  free(f->pinv);
+  free(f->sn_start);
+  free(f->sn_parent);
+  free(f->child_ptr);
+  free(f->child);
+  free(f->row_ptr);
+  free(f->rows);
+  free(f->rel);
+  free(f->L_ptr);
+  free(f->asm_ptr);
+  free(f->asm_src);
+  free(f->asm_dst);
+  free(f->sub_root);
+  free(f->sub_first);
+  free(f->top);
+  free(f->L);
+  free(f->d);
+  free(f->U);
+  free(f->x);
+  free(f->tmp);
+  free(f);
+}
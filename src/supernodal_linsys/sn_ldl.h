@@ -0,0 +1,75 @@
+#ifndef SN_LDL_H_GUARD
+#define SN_LDL_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "glbopts.h"
+#include <stddef.h>
+
+/* Supernodal multifrontal LDL' factorization of a sparse symmetric matrix
+ * that needs no pivoting (e.g. the quasi-definite SCS KKT matrix), so D is
+ * diagonal. Depends only on glbopts.h and BLAS (USE_LAPACK; plain loops
+ * otherwise), not on MATLAB, and allocates with malloc so that the
+ * numeric phase may allocate from OpenMP threads.
+ *
+ * sn_ldl_analyse does the symbolic phase once per pattern: the given
+ * fill-reducing ordering is combined with a postorder of the elimination
+ * tree, fundamental supernodes are found and relaxed (merged with their
+ * last child when that adds few explicit zeros), and the scatter maps of
+ * the input entries and of every update matrix into its parent front are
+ * precomputed. sn_ldl_factor is the numeric phase for new values on the
+ * same pattern. Each supernode's columns of L are one dense column-major
+ * block that the front is factorized in, with its pivot block done in
+ * panels and the Schur complement formed by GEMM.
+ *
+ * Subtrees of the supernodal tree are factorized in parallel (OpenMP), each
+ * by one thread; the supernodes above them run in order, where the fronts
+ * are largest and BLAS may use its own threads. */
+
+typedef struct {
+  scs_int threads; /* threads for the factorization, 0 = OpenMP default */
+} SnLdlOpts;
+
+typedef struct {
+  scs_int n, nnz;          /* order and entries of the input triangle */
+  scs_int n_super;         /* supernodes after relaxation */
+  scs_int max_cols;        /* widest supernode */
+  scs_int n_subtrees;      /* subtrees factorized in parallel */
+  scs_int threads;         /* threads used for them */
+  scs_float L_nnz;         /* strictly lower entries of L, with the
+                            * explicit zeros of the relaxed supernodes */
+  scs_float flops;         /* multiply-adds of one numeric factorization */
+  size_t symbolic_bytes;   /* ordering, supernodes and scatter maps */
+  size_t factor_bytes;     /* L blocks and D */
+  size_t solve_bytes;      /* solve vectors */
+} SnLdlInfo;
+
+typedef struct SnLdl SnLdl;
+
+void sn_ldl_default_opts(SnLdlOpts *opts);
+
+/* Symbolic phase for the n x n symmetric matrix whose upper (or lower)
+ * triangle has the CSC pattern Ap, Ai; every diagonal entry must be
+ * present. perm (new -> old, may be NULL for the natural order) is the
+ * fill-reducing ordering. Returns NULL if out of memory. */
+SnLdl *sn_ldl_analyse(scs_int n, const scs_int *Ap, const scs_int *Ai,
+                      const scs_int *perm, const SnLdlOpts *opts);
+
+/* Numeric phase for the values Ax of the analysed pattern. Returns 0, -1
+ * on a zero or non-finite pivot, -2 if out of memory. */
+scs_int sn_ldl_factor(SnLdl *f, const scs_float *Ax);
+
+/* x = A \ x with the last successful factorization. Uses the workspace in
+ * f, so one f solves one system at a time. */
+void sn_ldl_solve(SnLdl *f, scs_float *x);
+
+void sn_ldl_get_info(const SnLdl *f, SnLdlInfo *info);
+
+void sn_ldl_free(SnLdl *f);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
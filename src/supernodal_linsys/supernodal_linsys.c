@@ -0,0 +1,168 @@
+#include "supernodal_linsys.h"
+#include "external/amd/amd.h"
+#include "util.h"
+#include <string.h>
+
+struct SCS_LIN_SYS_WORK {
+  scs_int m, n;
+  ScsMatrix *kkt;       /* KKT matrix in CSC format (upper triangular) */
+  scs_int *diag_r_idxs; /* indices of R diagonal entries in kkt->x */
+  scs_float *diag_p;    /* diagonal of P (objective matrix) */
+  SnLdl *ldl;           /* symbolic analysis and factors */
+  ScsSupernodalOpts opts;
+
+  scs_int factorizations; /* all numeric factorizations */
+  scs_float factor_time;  /* ms spent in them (symbolic phase included) */
+  scs_int solves;         /* calls of scs_solve_lin_sys */
+  scs_float solve_time;   /* ms spent in them */
+};
+
+static ScsSupernodalOpts sn_opts = {0};
+
+const char *scs_get_lin_sys_method(void) {
+  return "sparse-direct-supernodal";
+}
+
+void scs_supernodal_default_opts(ScsSupernodalOpts *opts) {
+  opts->threads = 0;
+}
+
+void scs_supernodal_set_opts(const ScsSupernodalOpts *opts) {
+  sn_opts = *opts;
+}
+
+void scs_supernodal_get_stats(const ScsLinSysWork *p, ScsSupernodalStats *st) {
+  size_t N = (size_t)(p->n + p->m);
+  size_t I = sizeof(scs_int), F = sizeof(scs_float);
+  size_t kkt_nnz = (size_t)p->kkt->p[N];
+  SnLdlInfo info;
+
+  sn_ldl_get_info(p->ldl, &info);
+  memset(st, 0, sizeof(ScsSupernodalStats));
+  st->kkt_nnz = (scs_int)kkt_nnz;
+  st->L_nnz = (scs_int)info.L_nnz;
+  st->n_super = info.n_super;
+  st->factorizations = p->factorizations;
+  st->solves = p->solves;
+  st->factor_time = p->factor_time;
+  st->solve_time = p->solve_time;
+  st->kkt_bytes = (N + 1) * I + kkt_nnz * (I + F) + N * I + p->n * F;
+  st->factor_bytes = info.factor_bytes;
+  st->symbolic_bytes = info.symbolic_bytes;
+  st->solve_bytes = info.solve_bytes;
+}
+
+/* Numeric factorization of the current KKT values */
+static scs_int factor(ScsLinSysWork *p) {
+  SCS(timer) timer;
+  scs_int status;
+
+  SCS(tic)(&timer);
+  status = sn_ldl_factor(p->ldl, p->kkt->x);
+  p->factor_time += SCS(tocq)(&timer);
+  p->factorizations++;
+  if (status < 0) {
+    scs_printf("Error in supernodal LDL factorization (%s).\n",
+               status == -1 ? "zero pivot" : "out of memory");
+  }
+  return status;
+}
+
+ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
+                                     const scs_float *diag_r) {
+  scs_int n_plus_m = A->n + A->m;
+  scs_int *perm = SCS_NULL;
+  scs_float *info = SCS_NULL;
+  SnLdlOpts ldl_opts;
+  SCS(timer) timer;
+  ScsLinSysWork *p = (ScsLinSysWork *)scs_calloc(1, sizeof(ScsLinSysWork));
+
+  if (!p) {
+    return SCS_NULL;
+  }
+  p->n = A->n;
+  p->m = A->m;
+  p->opts = sn_opts;
+  p->diag_p = (scs_float *)scs_calloc(A->n, sizeof(scs_float));
+  p->diag_r_idxs = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  perm = (scs_int *)scs_calloc(n_plus_m, sizeof(scs_int));
+  info = (scs_float *)scs_calloc(AMD_INFO, sizeof(scs_float));
+  if (!p->diag_p || !p->diag_r_idxs || !perm || !info) {
+    scs_printf("Error allocating memory for linear system workspace.\n");
+    goto fail;
+  }
+
+  /* Form upper-triangular KKT matrix */
+  p->kkt = SCS(form_kkt)(A, P, p->diag_p, diag_r, p->diag_r_idxs, 1);
+  if (!p->kkt) {
+    scs_printf("Error forming KKT matrix.\n");
+    goto fail;
+  }
+
+  /* AMD ordering and symbolic analysis, once per workspace */
+  SCS(tic)(&timer);
+  if (amd_order(n_plus_m, p->kkt->p, p->kkt->i, perm, (scs_float *)SCS_NULL,
+                info) < 0) {
+    scs_printf("Error in AMD ordering.\n");
+    goto fail;
+  }
+  sn_ldl_default_opts(&ldl_opts);
+  ldl_opts.threads = p->opts.threads;
+  p->ldl = sn_ldl_analyse(n_plus_m, p->kkt->p, p->kkt->i, perm, &ldl_opts);
+  p->factor_time += SCS(tocq)(&timer);
+  if (!p->ldl) {
+    scs_printf("Error in supernodal LDL symbolic analysis.\n");
+    goto fail;
+  }
+  if (factor(p) < 0) {
+    goto fail;
+  }
+  scs_free(perm);
+  scs_free(info);
+  return p;
+
+fail:
+  scs_free(perm);
+  scs_free(info);
+  scs_free_lin_sys_work(p);
+  return SCS_NULL;
+}
+
+scs_int scs_solve_lin_sys(ScsLinSysWork *p, scs_float *b, const scs_float *s,
+                          scs_float tol) {
+  SCS(timer) timer;
+
+  (void)s;
+  (void)tol;
+  SCS(tic)(&timer);
+  sn_ldl_solve(p->ldl, b);
+  p->solve_time += SCS(tocq)(&timer);
+  p->solves++;
+  return 0;
+}
+
+/* Update diagonal of R in the KKT matrix and refactorize. The pattern is
+ * unchanged, so only the numeric phase runs. */
+scs_int scs_update_lin_sys_diag_r(ScsLinSysWork *p, const scs_float *diag_r) {
+  scs_int i;
+
+  for (i = 0; i < p->n; ++i) {
+    /* top left: R_x + P */
+    p->kkt->x[p->diag_r_idxs[i]] = p->diag_p[i] + diag_r[i];
+  }
+  for (i = p->n; i < p->n + p->m; ++i) {
+    /* bottom right: -R_y */
+    p->kkt->x[p->diag_r_idxs[i]] = -diag_r[i];
+  }
+  return factor(p);
+}
+
+void scs_free_lin_sys_work(ScsLinSysWork *p) {
+  if (p) {
+    sn_ldl_free(p->ldl);
+    SCS(cs_spfree)(p->kkt);
+    scs_free(p->diag_r_idxs);
+    scs_free(p->diag_p);
+    scs_free(p);
+  }
+}
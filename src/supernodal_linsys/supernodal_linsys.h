@@ -0,0 +1,41 @@
+#ifndef SUPERNODAL_LINSYS_H_GUARD
+#define SUPERNODAL_LINSYS_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "csparse.h"
+#include "glbopts.h"
+#include "linsys.h"
+#include "scs_matrix.h"
+#include "sn_ldl.h"
+
+/* Backend options, set by the mex layer before scs_init and copied into the
+ * linear system workspace when it is created */
+typedef struct {
+  scs_int threads; /* threads for the factorization, 0 = OpenMP default */
+} ScsSupernodalOpts;
+
+void scs_supernodal_default_opts(ScsSupernodalOpts *opts);
+void scs_supernodal_set_opts(const ScsSupernodalOpts *opts);
+
+/* Size, work done so far and memory of a linear system workspace */
+typedef struct {
+  scs_int kkt_nnz;  /* upper triangle of the KKT matrix */
+  scs_int L_nnz;    /* strictly lower triangle of L, relaxation zeros
+                     * included */
+  scs_int n_super;  /* supernodes */
+  scs_int factorizations, solves;
+  scs_float factor_time, solve_time; /* totals in ms */
+  /* Bytes held: KKT matrix; L blocks and D; ordering, supernodes and
+   * scatter maps; solve vectors */
+  size_t kkt_bytes, factor_bytes, symbolic_bytes, solve_bytes;
+} ScsSupernodalStats;
+
+void scs_supernodal_get_stats(const ScsLinSysWork *p, ScsSupernodalStats *st);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
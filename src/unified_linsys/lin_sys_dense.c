@@ -0,0 +1,8 @@
+/* SCS's dense direct (Gram matrix and LAPACK Cholesky) backend of the
+ * unified mex file (see unified_backend.h) */
+#define UNIFIED_BACKEND_PREFIX(x) scs_dense_##x
+#include "unified_backend.h"
+
+#include "cpu/dense/private.c"
+
+SCS_UNIFIED_BACKEND(scs_unified_dense, "dense");
@@ -0,0 +1,8 @@
+/* SCS's sparse direct (QDLDL) backend of the unified mex file (see
+ * unified_backend.h) */
+#define UNIFIED_BACKEND_PREFIX(x) scs_qdldl_##x
+#include "unified_backend.h"
+
+#include "cpu/direct/private.c"
+
+SCS_UNIFIED_BACKEND(scs_unified_direct, "direct");
@@ -0,0 +1,12 @@
+/* SCS's indirect (conjugate gradient) backend of the unified mex file (see
+ * unified_backend.h). INDIRECT is set here only, as the other backends and
+ * the solver are compiled without it. */
+#ifndef INDIRECT
+#define INDIRECT (1)
+#endif
+#define UNIFIED_BACKEND_PREFIX(x) scs_indirect_##x
+#include "unified_backend.h"
+
+#include "cpu/indirect/private.c"
+
+SCS_UNIFIED_BACKEND(scs_unified_indirect, "indirect");
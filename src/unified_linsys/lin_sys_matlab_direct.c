@@ -0,0 +1,7 @@
+/* MATLAB-LDL backend of the unified mex file (see unified_backend.h) */
+#define UNIFIED_BACKEND_PREFIX(x) scs_matlab_ldl_##x
+#include "unified_backend.h"
+
+#include "matlab_ldl_linsys.c"
+
+SCS_UNIFIED_BACKEND(scs_unified_matlab_direct, "matlab_direct");
@@ -0,0 +1,7 @@
+/* Supernodal LDL' backend of the unified mex file (see unified_backend.h) */
+#define UNIFIED_BACKEND_PREFIX(x) scs_supernodal_##x
+#include "unified_backend.h"
+
+#include "supernodal_linsys.c"
+
+SCS_UNIFIED_BACKEND(scs_unified_supernodal, "supernodal");
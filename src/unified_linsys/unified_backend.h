@@ -0,0 +1,38 @@
+#ifndef UNIFIED_BACKEND_H_GUARD
+#define UNIFIED_BACKEND_H_GUARD
+
+/* Included by the translation unit of each backend of the unified mex file,
+ * before the backend's source, with UNIFIED_BACKEND_PREFIX(x) defined to
+ * give its symbols a unique prefix. Renames the linsys.h functions the
+ * backend defines (linsys.h is included afterwards, so its declarations are
+ * renamed alike) and, after the source, SCS_UNIFIED_BACKEND(table, name)
+ * defines the backend's function table for unified_linsys.c. */
+
+#define scs_init_lin_sys_work UNIFIED_BACKEND_PREFIX(init_lin_sys_work)
+#define scs_solve_lin_sys UNIFIED_BACKEND_PREFIX(solve_lin_sys)
+#define scs_update_lin_sys_diag_r UNIFIED_BACKEND_PREFIX(update_lin_sys_diag_r)
+#define scs_free_lin_sys_work UNIFIED_BACKEND_PREFIX(free_lin_sys_work)
+#define scs_get_lin_sys_method UNIFIED_BACKEND_PREFIX(get_lin_sys_method)
+
+#include "unified_linsys.h"
+
+#define SCS_UNIFIED_BACKEND(table, backend_name)                               \
+  static void *unified_init(const ScsMatrix *A, const ScsMatrix *P,           \
+                            const scs_float *diag_r) {                         \
+    return (void *)scs_init_lin_sys_work(A, P, diag_r);                        \
+  }                                                                            \
+  static scs_int unified_solve(void *w, scs_float *b, const scs_float *s,      \
+                               scs_float tol) {                                \
+    return scs_solve_lin_sys((ScsLinSysWork *)w, b, s, tol);                   \
+  }                                                                            \
+  static scs_int unified_update_diag_r(void *w, const scs_float *diag_r) {     \
+    return scs_update_lin_sys_diag_r((ScsLinSysWork *)w, diag_r);              \
+  }                                                                            \
+  static void unified_free(void *w) {                                          \
+    scs_free_lin_sys_work((ScsLinSysWork *)w);                                 \
+  }                                                                            \
+  const ScsLinSysBackend table = {backend_name,  unified_init,                 \
+                                  unified_solve, unified_update_diag_r,        \
+                                  unified_free,  scs_get_lin_sys_method}
+
+#endif
@@ -0,0 +1,99 @@
+#include "unified_linsys.h"
+
+#include <string.h>
+
+extern const ScsLinSysBackend scs_unified_matlab_direct;
+extern const ScsLinSysBackend scs_unified_direct;
+extern const ScsLinSysBackend scs_unified_indirect;
+extern const ScsLinSysBackend scs_unified_dense;
+extern const ScsLinSysBackend scs_unified_supernodal;
+
+static const ScsLinSysBackend *const backends[SCS_N_LIN_SYS] = {
+    &scs_unified_matlab_direct, &scs_unified_direct, &scs_unified_indirect,
+    &scs_unified_dense, &scs_unified_supernodal};
+
+static scs_int selected = SCS_LIN_SYS_MATLAB_LDL;
+
+struct SCS_LIN_SYS_WORK {
+  const ScsLinSysBackend *backend; /* that created work */
+  void *work;                      /* NULL once taken over */
+};
+
+scs_int scs_unified_find(const char *name) {
+  scs_int i;
+  for (i = 0; i < SCS_N_LIN_SYS; i++) {
+    if (strcmp(name, backends[i]->name) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+scs_int scs_unified_find_method(const char *method) {
+  scs_int i;
+  for (i = 0; i < SCS_N_LIN_SYS; i++) {
+    if (strcmp(method, backends[i]->method()) == 0) {
+      return i;
+    }
+  }
+  return -1;
+}
+
+const char *scs_unified_name(scs_int id) {
+  return id >= 0 && id < SCS_N_LIN_SYS ? backends[id]->name : SCS_NULL;
+}
+
+void scs_unified_select(scs_int id) {
+  if (id >= 0 && id < SCS_N_LIN_SYS) {
+    selected = id;
+  }
+}
+
+scs_int scs_unified_selected(void) {
+  return selected;
+}
+
+void *scs_unified_work(const ScsLinSysWork *p) {
+  return p->work;
+}
+
+void **scs_unified_work_ref(ScsLinSysWork *p) {
+  return &p->work;
+}
+
+const char *scs_get_lin_sys_method(void) {
+  return backends[selected]->method();
+}
+
+ScsLinSysWork *scs_init_lin_sys_work(const ScsMatrix *A, const ScsMatrix *P,
+                                     const scs_float *diag_r) {
+  ScsLinSysWork *p = (ScsLinSysWork *)scs_calloc(1, sizeof(ScsLinSysWork));
+  if (!p) {
+    return SCS_NULL;
+  }
+  p->backend = backends[selected];
+  p->work = p->backend->init(A, P, diag_r);
+  if (!p->work) {
+    scs_free(p);
+    return SCS_NULL;
+  }
+  return p;
+}
+
+scs_int scs_solve_lin_sys(ScsLinSysWork *p, scs_float *b, const scs_float *s,
+                          scs_float tol) {
+  return p->backend->solve(p->work, b, s, tol);
+}
+
+scs_int scs_update_lin_sys_diag_r(ScsLinSysWork *p, const scs_float *diag_r) {
+  return p->backend->update_diag_r(p->work, diag_r);
+}
+
+void scs_free_lin_sys_work(ScsLinSysWork *p) {
+  if (p) {
+    if (p->work) {
+      p->backend->free(p->work);
+    }
+    scs_free(p);
+  }
+}
@@ -0,0 +1,55 @@
+#ifndef UNIFIED_LINSYS_H_GUARD
+#define UNIFIED_LINSYS_H_GUARD
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+#include "glbopts.h"
+#include "linsys.h"
+#include "scs_matrix.h"
+
+/* Linear system backends of the unified mex file. It links every CPU
+ * backend, each compiled with its scs_*_lin_sys* functions renamed (see
+ * unified_backend.h), and implements the linsys.h API by dispatching
+ * through their function tables: a linear system workspace is created by
+ * the backend selected at scs_init and stays with it. */
+enum {
+  SCS_LIN_SYS_MATLAB_LDL, /* 'matlab_direct' */
+  SCS_LIN_SYS_QDLDL,      /* 'direct' */
+  SCS_LIN_SYS_INDIRECT,   /* 'indirect' */
+  SCS_LIN_SYS_DENSE,      /* 'dense' */
+  SCS_LIN_SYS_SUPERNODAL, /* 'supernodal' */
+  SCS_N_LIN_SYS
+};
+
+/* The linsys.h functions of a backend, on its own (opaque) workspace */
+typedef struct {
+  const char *name; /* as in the name of its single-backend mex file */
+  void *(*init)(const ScsMatrix *A, const ScsMatrix *P,
+                const scs_float *diag_r);
+  scs_int (*solve)(void *w, scs_float *b, const scs_float *s, scs_float tol);
+  scs_int (*update_diag_r)(void *w, const scs_float *diag_r);
+  void (*free)(void *w);
+  const char *(*method)(void);
+} ScsLinSysBackend;
+
+/* Backend ids by name and by linear system method, -1 if unknown */
+scs_int scs_unified_find(const char *name);
+scs_int scs_unified_find_method(const char *method);
+const char *scs_unified_name(scs_int id);
+
+/* Backend of the workspaces created from now on, and the one whose method
+ * scs_get_lin_sys_method reports */
+void scs_unified_select(scs_int id);
+scs_int scs_unified_selected(void);
+
+/* The backend's own workspace inside p, for its backend-specific API, and
+ * its address, for APIs that may take it over (set it to NULL) */
+void *scs_unified_work(const ScsLinSysWork *p);
+void **scs_unified_work_ref(ScsLinSysWork *p);
+
+#ifdef __cplusplus
+}
+#endif
+#endif
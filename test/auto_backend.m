@@ -0,0 +1,85 @@
+classdef auto_backend < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            clear scs_auto_backend
+            rng(1234)
+            m = 300;
+            n = 100;
+            testCase.data.A = sprandn(m, n, 0.05) + [speye(n); sparse(m - n, n)];
+            testCase.data.b = rand(m, 1);
+            testCase.data.c = randn(n, 1);
+            testCase.cones.z = 10;
+            testCase.cones.l = m - 10;
+        end
+    end
+
+    methods (Test)
+        function test_auto_matches_default(testCase)
+            pars.verbose = 0;
+            pars.eps_abs = 1e-7;
+            pars.eps_rel = 1e-7;
+            [x0,~,~,info0] = scs(testCase.data,testCase.cones,pars);
+            pars.backend = 'auto';
+            [x,~,~,info] = scs(testCase.data,testCase.cones,pars);
+            testCase.verifyEqual(info.status, info0.status)
+            if strcmp(info.status, 'solved')
+                testCase.verifyEqual(x, x0, 'AbsTol', 1e-4)
+            end
+        end
+
+        function test_decision_cached(testCase)
+            [b1, r1] = scs_auto_backend(testCase.data, testCase.cones);
+            testCase.verifyFalse(startsWith(r1, 'cached'))
+            % same pattern, different values: cache hit
+            testCase.data.A = 2 * testCase.data.A;
+            [b2, r2] = scs_auto_backend(testCase.data, testCase.cones);
+            testCase.verifyEqual(b2, b1)
+            testCase.verifyTrue(startsWith(r2, 'cached'))
+            % different pattern: new decision
+            i = find(testCase.data.A(:, end) == 0, 1);
+            testCase.data.A(i, end) = 1;
+            [~, r3] = scs_auto_backend(testCase.data, testCase.cones);
+            testCase.verifyFalse(startsWith(r3, 'cached'))
+        end
+
+        function test_same_counts_different_pattern(testCase)
+            % rows 10, 20 and 11, 19 of one column: same nnz, row sums
+            % and column sums, different positions
+            testCase.data.A(:, end) = 0;
+            testCase.data.A([10 20], end) = 1;
+            scs_auto_backend(testCase.data, testCase.cones);
+            testCase.data.A([10 20], end) = 0;
+            testCase.data.A([11 19], end) = 1;
+            [~, r] = scs_auto_backend(testCase.data, testCase.cones);
+            testCase.verifyFalse(startsWith(r, 'cached'))
+        end
+
+        function test_dense_problem(testCase)
+            testCase.assumeEqual(exist('scs_dense', 'file'), 3)
+            rng(42)
+            data.A = sparse(randn(60, 20));
+            data.b = rand(60, 1);
+            data.c = randn(20, 1);
+            K.l = 60;
+            testCase.verifyEqual(scs_auto_backend(data, K), 'scs_dense')
+        end
+
+        function test_auto_workspace(testCase)
+            pars.verbose = 0;
+            pars.backend = 'auto';
+            work = scs_init(testCase.data,testCase.cones,pars);
+            cleanup = onCleanup(@() scs_finish(work));
+            testCase.verifyEqual(work.backend, ...
+                scs_auto_backend(testCase.data, testCase.cones))
+            [~,~,~,info] = scs_solve(work);
+            testCase.verifyTrue(any(strcmp(info.status, ...
+                {'solved', 'infeasible', 'unbounded'})))
+        end
+    end
+end
@@ -0,0 +1,101 @@
+classdef cache < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+        pars
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            rng(1234)
+            m = 9;
+            n = 3;
+            testCase.data.A = sparse(randn(m,n));
+            testCase.data.c = randn(n,1);
+            testCase.data.b = testCase.data.A * randn(n,1) + ones(m,1);
+            testCase.cones.l = m;
+            testCase.pars = struct('verbose', 0, 'cache_bytes', 1e8);
+            scs_cache('clear');
+        end
+    end
+
+    methods(TestMethodTeardown)
+        function clear_cache(~)
+            scs_cache('clear');
+        end
+    end
+
+    methods (Test)
+        function test_hit_after_b_change(testCase)
+            [~,~,~,info] = scs(testCase.data, testCase.cones, testCase.pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(info.cache_hit, 0)
+
+            data = testCase.data;
+            data.b = 2 * data.b;
+            [x,~,~,info] = scs(data, testCase.cones, testCase.pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(info.cache_hit, 1)
+            testCase.verifyEqual(info.cache_hits, 1)
+            testCase.verifyEqual(info.cache_misses, 1)
+
+            x_ref = scs(data, testCase.cones, struct('verbose', 0));
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-3)
+        end
+
+        function test_iteration_settings_per_call(testCase)
+            scs(testCase.data, testCase.cones, testCase.pars);
+            pars = testCase.pars;
+            pars.max_iters = 1;
+            [~,~,~,info] = scs(testCase.data, testCase.cones, pars);
+            testCase.verifyEqual(info.cache_hit, 1)
+            testCase.verifyEqual(info.iter, 1)
+        end
+
+        function test_misses(testCase)
+            scs(testCase.data, testCase.cones, testCase.pars);
+
+            % new A values
+            data = testCase.data;
+            data.A = 2 * data.A;
+            [~,~,~,info] = scs(data, testCase.cones, testCase.pars);
+            testCase.verifyEqual(info.cache_hit, 0)
+
+            % setup setting
+            pars = testCase.pars;
+            pars.scale = 0.5;
+            [~,~,~,info] = scs(testCase.data, testCase.cones, pars);
+            testCase.verifyEqual(info.cache_hit, 0)
+
+            stats = scs_cache();
+            testCase.verifyEqual(stats.entries, 3)
+            testCase.verifyEqual(stats.misses, 3)
+        end
+
+        function test_bound(testCase)
+            scs(testCase.data, testCase.cones, testCase.pars);
+            one = scs_cache().bytes;
+
+            % room for one entry: the older one is evicted
+            pars = testCase.pars;
+            pars.cache_bytes = 1.5 * one;
+            data = testCase.data;
+            data.A = 2 * data.A;
+            scs(data, testCase.cones, pars);
+            stats = scs_cache();
+            testCase.verifyEqual(stats.entries, 1)
+            testCase.verifyLessThanOrEqual(stats.bytes, pars.cache_bytes)
+
+            [~,~,~,info] = scs(data, testCase.cones, testCase.pars);
+            testCase.verifyEqual(info.cache_hit, 1)
+        end
+
+        function test_off_by_default(testCase)
+            [~,~,~,info] = scs(testCase.data, testCase.cones, ...
+                struct('verbose', 0));
+            testCase.verifyFalse(isfield(info, 'cache_hit'))
+            testCase.verifyEqual(scs_cache().entries, 0)
+        end
+    end
+end
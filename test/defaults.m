@@ -66,7 +66,7 @@ classdef defaults < matlab.unittest.TestCase
         end
 
         function test_dense_A_auto_sparsified(testCase, solver)
-            % Pass dense A — scs.m should auto-convert to sparse
+            % Pass dense A — the mex file converts it to sparse
             testCase.data.A = full(testCase.data.A);
             pars = defaults.solver_pars(solver);
             pars.verbose = 0;
@@ -75,7 +75,7 @@ classdef defaults < matlab.unittest.TestCase
         end
 
         function test_row_vector_b_c(testCase, solver)
-            % Pass b and c as row vectors — scs.m should reshape
+            % Pass b and c as row vectors — the mex file reads them as columns
             testCase.data.b = testCase.data.b';
             testCase.data.c = testCase.data.c';
             pars = defaults.solver_pars(solver);
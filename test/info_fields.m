@@ -70,6 +70,21 @@ classdef info_fields < matlab.unittest.TestCase
             testCase.verifySize(s, [m, 1])
         end
 
+        function test_factorizations(testCase, solver)
+            % counted by the default (MATLAB LDL) backend, NaN elsewhere
+            pars = info_fields.solver_pars(solver);
+            pars.verbose = 0;
+            [~,~,~,info] = scs(testCase.data,testCase.cones,pars);
+            testCase.verifyTrue(isfield(info, 'factorizations'))
+            if strcmp(solver, 'default')
+                testCase.verifyGreaterThanOrEqual(info.factorizations, 1)
+                testCase.verifyLessThanOrEqual(info.factorizations, ...
+                    info.scale_updates + 1)
+            else
+                testCase.verifyTrue(isnan(info.factorizations))
+            end
+        end
+
         function test_duality_gap(testCase, solver)
             pars = info_fields.solver_pars(solver);
             pars.verbose = 0;
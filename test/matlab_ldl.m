@@ -167,5 +167,162 @@ classdef matlab_ldl < matlab.unittest.TestCase
                 'matlab_ldl and qdldl should match on mixed cone problems')
             testCase.verifyEqual(y1, y2, 'AbsTol', 1e-3)
         end
+
+        function test_refactorization_cross_validate(testCase)
+            % Force many adaptive-scale updates so the numeric-only
+            % refactorizations (fixed ordering from the initial ldl())
+            % are exercised, and compare against qdldl
+            rng(6789)
+            n = 40; m = 80;
+            P = sprandn(n, n, 0.1);
+            data.P = P' * P + 0.01 * speye(n);
+            data.A = sprandn(m, n, 0.2) + [speye(n); sparse(m - n, n)];
+            data.c = randn(n, 1);
+            K.l = m;
+            data.b = data.A * randn(n, 1) + rand(m, 1);
+
+            pars.verbose = 0;
+            pars.scale = 1e-3;
+            pars.eps_abs = 1e-7;
+            pars.eps_rel = 1e-7;
+            [x1, y1, ~, info1] = scs(data, K, pars);
+            testCase.verifyEqual(info1.status, 'solved')
+            testCase.verifyGreaterThan(info1.scale_updates, 0)
+
+            pars.use_qdldl = true;
+            [x2, y2, ~, info2] = scs(data, K, pars);
+            testCase.verifyEqual(info2.status, 'solved')
+
+            testCase.verifyEqual(x1, x2, 'AbsTol', 1e-4, ...
+                'refactorized matlab_ldl and qdldl should match')
+            testCase.verifyEqual(y1, y2, 'AbsTol', 1e-4)
+        end
+
+        function test_parallel_trisolve_matches_serial(testCase)
+            % Large enough for the level-scheduled triangular solves (in an
+            % OpenMP build); must match the serial sweep
+            rng(7890)
+            n = 3000; m = 6000;
+            data.P = sprandsym(n, 10 / n) + speye(n);
+            data.P = data.P' * data.P;
+            data.A = [speye(n); sprandn(m - n, n, 10 / n)];
+            data.b = rand(m, 1);
+            data.c = randn(n, 1);
+            K.l = m;
+
+            pars.verbose = 0;
+            pars.max_iters = 200;
+            pars.lin_sys_threads = 1;
+            [x1, y1, ~, info1] = scs(data, K, pars);
+
+            pars.lin_sys_threads = 4;
+            [x2, y2, ~, info2] = scs(data, K, pars);
+
+            testCase.verifyEqual(info1.iter, info2.iter)
+            testCase.verifyEqual(x1, x2, 'AbsTol', 1e-8)
+            testCase.verifyEqual(y1, y2, 'AbsTol', 1e-8)
+        end
+
+        function test_stale_factor_refinement(testCase)
+            % With refactor_tol, scale updates within the tolerance reuse
+            % the factors (solving by refinement); results must match qdldl
+            rng(6789)
+            n = 40; m = 80;
+            P = sprandn(n, n, 0.1);
+            data.P = P' * P + 0.01 * speye(n);
+            data.A = sprandn(m, n, 0.2) + [speye(n); sparse(m - n, n)];
+            data.c = randn(n, 1);
+            K.l = m;
+            data.b = data.A * randn(n, 1) + rand(m, 1);
+
+            pars.verbose = 0;
+            pars.scale = 1e-3;
+            pars.eps_abs = 1e-7;
+            pars.eps_rel = 1e-7;
+            [~, ~, ~, info0] = scs(data, K, pars);
+            testCase.verifyEqual(info0.factorizations, ...
+                info0.scale_updates + 1)
+
+            pars.refactor_tol = 1e3;
+            [x1, y1, ~, info1] = scs(data, K, pars);
+            testCase.verifyEqual(info1.status, 'solved')
+            testCase.verifyGreaterThan(info1.scale_updates, 0)
+            testCase.verifyLessThan(info1.factorizations, ...
+                info1.scale_updates + 1)
+
+            pars = rmfield(pars, 'refactor_tol');
+            pars.use_qdldl = true;
+            [x2, y2, ~, info2] = scs(data, K, pars);
+            testCase.verifyEqual(info2.status, 'solved')
+
+            testCase.verifyEqual(x1, x2, 'AbsTol', 1e-4)
+            testCase.verifyEqual(y1, y2, 'AbsTol', 1e-4)
+        end
+
+        function test_factor_single(testCase)
+            % Single precision factors with refinement must converge like
+            % the double precision ones
+            rng(2468)
+            n = 60; m = 120;
+            P = sprandn(n, n, 0.1);
+            data.P = P' * P + 0.01 * speye(n);
+            data.A = sprandn(m, n, 0.2) + [speye(n); sparse(m - n, n)];
+            data.c = randn(n, 1);
+            K.z = 10;
+            K.l = m - 10;
+            data.b = data.A * randn(n, 1) + [zeros(10, 1); rand(m - 10, 1)];
+
+            pars.verbose = 0;
+            pars.eps_abs = 1e-8;
+            pars.eps_rel = 1e-8;
+            [x1, y1, s1, info1] = scs(data, K, pars);
+
+            pars.factor_single = 1;
+            [x2, y2, s2, info2] = scs(data, K, pars);
+            testCase.verifyEqual(info2.status, 'solved')
+            testCase.verifyLessThanOrEqual(abs(info2.iter - info1.iter), ...
+                0.1 * info1.iter + 25)
+
+            testCase.verifyEqual(x1, x2, 'AbsTol', 1e-5)
+            testCase.verifyEqual(y1, y2, 'AbsTol', 1e-5)
+            testCase.verifyEqual(s1, s2, 'AbsTol', 1e-5)
+        end
+
+        function test_iteration_trace(testCase)
+            % The trace keeps the last trace_iters iterations, in order,
+            % and its last row matches the final info
+            rng(1357)
+            m = 40; n = 15;
+            data.A = sprandn(m, n, 0.3) + [speye(n); sparse(m - n, n)];
+            data.c = randn(n, 1);
+            data.b = data.A * randn(n, 1) + rand(m, 1);
+            K.l = m;
+
+            pars.verbose = 0;
+            [~,~,~,info] = scs(data, K, pars);
+            testCase.verifyFalse(isfield(info, 'trace'))
+
+            pars.trace_iters = 1000;
+            [~,~,~,info] = scs(data, K, pars);
+            testCase.verifyEqual(info.status, 'solved')
+            T = info.trace;
+            testCase.verifyEqual(size(T, 2), 9)
+            testCase.verifyEqual(T(1, 1), 0)
+            testCase.verifyEqual(diff(T(:, 1)), ones(size(T, 1) - 1, 1))
+            testCase.verifyEqual(T(end, 2), info.res_pri, 'RelTol', 1e-8)
+            testCase.verifyEqual(T(end, 3), info.res_dual, 'RelTol', 1e-8)
+            testCase.verifyEqual(sum(T(:, 6)), info.accepted_accel_steps)
+            testCase.verifyEqual(sum(T(:, 7)), info.rejected_accel_steps)
+            testCase.verifyGreaterThanOrEqual(T(:, 8:9), 0)
+
+            % Ring buffer: only the last iterations are kept
+            pars.trace_iters = 5;
+            work = scs_init(data, K, pars);
+            [~,~,~,info] = scs_solve(work);
+            scs_finish(work);
+            testCase.verifyEqual(size(info.trace, 1), 5)
+            testCase.verifyEqual(info.trace(:, 1:7), T(end - 4:end, 1:7), ...
+                'RelTol', 1e-12)
+        end
     end
 end
@@ -0,0 +1,91 @@
+classdef prepare_data < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+        pars
+    end
+
+    properties (TestParameter)
+        solver = {'default', 'qdldl', 'indirect'}
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            rng(1234)
+            n = 5;
+            m = 10;
+            P = randn(n, n);
+            testCase.data.P = sparse(P * P');
+            testCase.data.A = sparse(randn(m, n));
+            testCase.data.b = randn(m, 1);
+            testCase.data.c = randn(n, 1);
+            testCase.cones.l = m;
+            testCase.pars = struct('verbose', 0, 'eps_abs', 1e-7, ...
+                'eps_rel', 1e-7);
+        end
+    end
+
+    methods (Test)
+        function test_P_forms(testCase, solver)
+            pars = prepare_data.solver_pars(solver, testCase.pars);
+            x_ref = scs(testCase.data, testCase.cones, pars);
+
+            % upper triangle only
+            data = testCase.data;
+            data.P = triu(data.P);
+            x = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+
+            % dense full symmetric
+            data.P = full(testCase.data.P);
+            x = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+
+            % not symmetric: only (P + P') / 2 matters
+            S = sprandn(5, 5, 0.5);
+            data.P = testCase.data.P + S - S';
+            x = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+        end
+
+        function test_matches_scs_prepare_data(testCase, solver)
+            pars = prepare_data.solver_pars(solver, testCase.pars);
+            data = testCase.data;
+            data.A = full(data.A);
+            data.P = tril(data.P) + 0.1 * speye(5);
+            data.b = data.b';
+            x = scs(data, testCase.cones, pars);
+            x_ref = scs(scs_prepare_data(data), testCase.cones, pars);
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+        end
+
+        function test_empty_P(testCase)
+            data = testCase.data;
+            data.P = [];
+            [~,~,~,info] = scs(data, testCase.cones, testCase.pars);
+            testCase.verifyClass(info.status, 'char')
+        end
+
+        function test_shape_errors(testCase)
+            data = testCase.data;
+            data.b = [data.b; 1];
+            testCase.verifyError(@() scs(data, testCase.cones, ...
+                testCase.pars), ?MException)
+            data = testCase.data;
+            data.P = speye(4);
+            testCase.verifyError(@() scs(data, testCase.cones, ...
+                testCase.pars), ?MException)
+            data.P = sparse(5, 4);
+            testCase.verifyError(@() scs(data, testCase.cones, ...
+                testCase.pars), ?MException)
+        end
+    end
+
+    methods (Static)
+        function pars = solver_pars(solver, pars)
+            if strcmp(solver, 'qdldl'), pars.use_qdldl = true; end
+            if strcmp(solver, 'indirect'), pars.use_indirect = true; end
+        end
+    end
+end
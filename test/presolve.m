@@ -0,0 +1,125 @@
+classdef presolve < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+        pars
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            % zero cone: a fixing row, a kept row and its duplicate, a
+            % row emptied by the fixing, an empty row; linear cone: a row
+            % emptied by the fixing, an empty row and four kept rows; last
+            % column unused
+            rng(1234)
+            n = 6;
+            A = [0 2 0 0 0 0;
+                 1 1 1 0 0 0;
+                 1 1 1 0 0 0;
+                 0 3 0 0 0 0;
+                 0 0 0 0 0 0;
+                 0 0 0 1 -1 0;
+                 0 1 0 0 0 0;
+                 0 0 0 0 0 0;
+                 [randn(4, 5), zeros(4, 1)]];
+            b = [4; 3; 3; 6; 0; 1; 5; 1; 10 * ones(4, 1)];
+            P = diag([2 3 4 5 1 0]);
+            P(1, 2) = 0.5;
+            P(2, 1) = 0.5;
+            testCase.data.A = sparse(A);
+            testCase.data.P = sparse(P);
+            testCase.data.b = b;
+            testCase.data.c = [randn(n - 1, 1); 0];
+            testCase.cones.z = 6;
+            testCase.cones.l = 6;
+            testCase.pars = struct('verbose', 0, 'eps_abs', 1e-8, ...
+                'eps_rel', 1e-8);
+        end
+    end
+
+    methods (Test)
+        function test_matches_full_solve(testCase)
+            [x_ref,y_ref,s_ref,info_ref] = scs(testCase.data, ...
+                testCase.cones, testCase.pars);
+            pars = testCase.pars;
+            pars.presolve = true;
+            [x,y,s,info] = scs(testCase.data, testCase.cones, pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+            testCase.verifyEqual(s, s_ref, 'AbsTol', 1e-5)
+            testCase.verifyEqual(info.pobj, info_ref.pobj, 'AbsTol', 1e-5)
+            testCase.verifyEqual(info.dobj, info_ref.dobj, 'AbsTol', 1e-5)
+
+            % y is not unique (duplicate rows), check the dual residual
+            d = testCase.data;
+            testCase.verifyLessThan(norm(d.P * x + d.A' * y + d.c), 1e-5)
+            testCase.verifyGreaterThanOrEqual(min(y(7:end)), -1e-6)
+            testCase.verifyLessThan(abs(s' * y), 1e-5)
+            testCase.verifyLessThan(norm(d.A' * (y - y_ref)), 1e-4)
+        end
+
+        function test_info(testCase)
+            pars = testCase.pars;
+            pars.presolve = true;
+            [~,~,~,info] = scs(testCase.data, testCase.cones, pars);
+            p = info.presolve;
+            testCase.verifyEqual([p.m, p.n], [12, 6])
+            testCase.verifyEqual([p.m_reduced, p.n_reduced], [6, 4])
+            testCase.verifyEqual(p.fixed_vars, 1)
+            testCase.verifyEqual(p.empty_rows, 4)
+            testCase.verifyEqual(p.duplicate_rows, 1)
+            testCase.verifyEqual(p.empty_cols, 1)
+
+            [~,~,~,info] = scs(testCase.data, testCase.cones, testCase.pars);
+            testCase.verifyFalse(isfield(info, 'presolve'))
+        end
+
+        function test_infeasible_row_is_kept(testCase)
+            data = testCase.data;
+            data.b(8) = -1;   % empty linear cone row 0 <= -1
+            pars = testCase.pars;
+            pars.presolve = true;
+            [x,~,~,info] = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(info.status, 'infeasible')
+            testCase.verifyEqual(info.presolve.empty_rows, 3)
+            testCase.verifyTrue(all(isnan(x)))
+        end
+
+        function test_workspace_update(testCase)
+            pars = testCase.pars;
+            pars.presolve = true;
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [x,~,~,info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(x(2), 2, 'AbsTol', 1e-8)
+
+            % moves the fixed variable, keeps every reduction
+            data = testCase.data;
+            data.b([1 2 3 4 7]) = [6; 1; 1; 9; 4];
+            data.c(1) = 1;
+            scs_update(work, data.b, data.c);
+            [x,~,~,info] = scs_solve(work);
+            x_ref = scs(data, testCase.cones, testCase.pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+
+            % breaks the duplicate row, the emptied row, the empty column
+            b = data.b;
+            b(3) = 0;
+            testCase.verifyError(@() scs_update(work, b, []), ?MException)
+            b = data.b;
+            b(4) = 1;
+            testCase.verifyError(@() scs_update(work, b, []), ?MException)
+            c = data.c;
+            c(6) = 1;
+            testCase.verifyError(@() scs_update(work, [], c), ?MException)
+            x = scs_solve(work);
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-5)
+
+            testCase.verifyError(@() scs_solve_batch(work, data.b, []), ...
+                ?MException)
+            scs_finish(work);
+        end
+    end
+end
@@ -39,6 +39,62 @@ classdef quad_box < matlab.unittest.TestCase
             testCase.verifyEqual(info.status, 'solved')
             testCase.verifyLessThanOrEqual(info.iter, 25)
         end
+
+        function test_update_bounds(testCase, solver)
+            pars = quad_box.solver_pars(solver);
+            pars.verbose = 0;
+            pars.eps_abs = 1e-8;
+            pars.eps_rel = 1e-8;
+            pars.normalize = 1;
+
+            % badly scaled box rows, so equilibration scales each bound
+            data = testCase.data;
+            data.A = sparse(diag([1, 100, 0.01, 1])) * data.A;
+
+            work = scs_init(data, testCase.cones, pars);
+            [~,~,~,info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+
+            K_new.bl = [-1., 0.5, -3.];
+            K_new.bu = [0.5, 1.5, -2.];
+            scs_update(work, [], [], K_new);
+            [x_ws,~,~,info_ws] = scs_solve(work);
+            testCase.verifyEqual(info_ws.status, 'solved')
+
+            cones = testCase.cones;
+            cones.bl = K_new.bl;
+            cones.bu = K_new.bu;
+            [x_ref,~,~,info_ref] = scs(data, cones, pars);
+            testCase.verifyEqual(info_ref.status, 'solved')
+            testCase.verifyEqual(x_ws, x_ref, 'AbsTol', 1e-5)
+
+            % updated before the first solve
+            work2 = scs_init(data, testCase.cones, pars);
+            scs_update(work2, [], [], K_new);
+            x_ws = scs_solve(work2);
+            testCase.verifyEqual(x_ws, x_ref, 'AbsTol', 1e-5)
+            scs_finish(work2);
+
+            % an infinite bound
+            K_new.bu(1) = Inf;
+            cones.bu = K_new.bu;
+            scs_update(work, [], [], K_new);
+            x_ws = scs_solve(work);
+            x_ref = scs(data, cones, pars);
+            testCase.verifyEqual(x_ws, x_ref, 'AbsTol', 1e-5)
+
+            % Wrong sizes, crossed bounds and other cone fields are rejected
+            testCase.verifyError(@() scs_update(work, [], [], ...
+                struct('bl', [0, 0])), ?MException)
+            testCase.verifyError(@() scs_update(work, [], [], ...
+                struct('bu', [-5., -5., -5.])), ?MException)
+            testCase.verifyError(@() scs_update(work, [], [], ...
+                struct('p', 0.5)), ?MException)
+            testCase.verifyError(@() scs_update(work, [], [], ...
+                struct('l', 2)), ?MException)
+
+            scs_finish(work);
+        end
     end
 
     methods (Static)
@@ -0,0 +1,77 @@
+classdef single_input < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            rng(1234)
+            m = 9;
+            n = 3;
+            testCase.data.A = sparse(randn(m,n));
+            testCase.data.c = randn(n,1);
+            testCase.cones.l = m;
+            x_feas = randn(n,1);
+            testCase.data.b = testCase.data.A * x_feas + ones(m,1);
+        end
+    end
+
+    methods (Test)
+        function test_single_one_shot(testCase)
+            pars = struct('verbose', 0, 'eps_abs', 1e-5, 'eps_rel', 1e-5);
+            [x_ref,~,~,~] = scs(testCase.data, testCase.cones, pars);
+
+            data = testCase.data;
+            data.b = single(data.b);
+            data.c = single(data.c);
+            [x,y,s,info] = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyClass(x, 'single')
+            testCase.verifyClass(y, 'single')
+            testCase.verifyClass(s, 'single')
+            testCase.verifyEqual(double(x), x_ref, 'AbsTol', 1e-3)
+
+            % single warm start
+            data.x = x;
+            data.y = y;
+            data.s = s;
+            [~,~,~,info] = scs(data, testCase.cones, pars);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyLessThanOrEqual(info.iter, 25)
+        end
+
+        function test_single_c_only(testCase)
+            % outputs follow the class of b
+            data = testCase.data;
+            data.c = single(data.c);
+            x = scs(data, testCase.cones, struct('verbose', 0));
+            testCase.verifyClass(x, 'double')
+        end
+
+        function test_single_workspace(testCase)
+            pars = struct('verbose', 0);
+            data = testCase.data;
+            data.b = single(data.b);
+            work = scs_init(data, testCase.cones, pars);
+            [x1,~,~,info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyClass(x1, 'single')
+
+            scs_update(work, single(2 * testCase.data.b), single(testCase.data.c));
+            [x2,~,~,info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyClass(x2, 'single')
+
+            ref = testCase.data;
+            ref.b = 2 * ref.b;
+            x_ref = scs(ref, testCase.cones, pars);
+            testCase.verifyEqual(double(x2), x_ref, 'AbsTol', 1e-3)
+
+            testCase.verifyError(@() scs_update(work, int32(ones(9,1)), []), ...
+                ?MException)
+            scs_finish(work);
+        end
+    end
+end
@@ -0,0 +1,111 @@
+classdef solve_batch < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+        B
+        C
+    end
+
+    properties (TestParameter)
+        solver = {'default', 'qdldl', 'indirect'}
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            rng(1234)
+            m = 20;
+            n = 6;
+            k = 7;
+            testCase.data.A = sparse(randn(m,n));
+            testCase.cones.l = m;
+            % Every scenario is feasible (b = A*x + s, s > 0) and bounded
+            % (c = -A'*y, y > 0).
+            testCase.B = testCase.data.A * randn(n,k) + ones(m,k);
+            testCase.C = -testCase.data.A' * (1 + rand(m,k));
+            testCase.data.b = testCase.B(:,1);
+            testCase.data.c = testCase.C(:,1);
+        end
+    end
+
+    methods (Test)
+        function test_batch_matches_loop(testCase, solver)
+            pars = solve_batch.solver_pars(solver);
+            pars.verbose = 0;
+            k = size(testCase.B, 2);
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [X, Y, S, info] = scs_solve_batch(work, testCase.B, testCase.C);
+            testCase.verifySize(X, [size(testCase.C,1), k])
+            testCase.verifySize(Y, [size(testCase.B,1), k])
+            testCase.verifySize(S, [size(testCase.B,1), k])
+            testCase.verifySize(info, [1, k])
+
+            for j = 1:k
+                scs_update(work, testCase.B(:,j), testCase.C(:,j));
+                [x, y, ~, info_j] = scs_solve(work);
+                testCase.verifyEqual(info(j).status, 'solved')
+                testCase.verifyEqual(info_j.status, 'solved')
+                testCase.verifyEqual(X(:,j), x, 'AbsTol', 1e-4)
+                testCase.verifyEqual(Y(:,j), y, 'AbsTol', 1e-4)
+            end
+
+            scs_finish(work);
+        end
+
+        function test_batch_keeps_workspace(testCase, solver)
+            % A batch must not change the workspace's own b and c.
+            pars = solve_batch.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [x_ref,~,~,info_ref] = scs_solve(work);
+            testCase.verifyEqual(info_ref.status, 'solved')
+
+            [X,~,~,info] = scs_solve_batch(work, testCase.B, []);
+            testCase.verifyEqual({info.status}, ...
+                repmat({'solved'}, 1, size(testCase.B, 2)))
+            testCase.verifyEqual(X(:,1), x_ref, 'AbsTol', 1e-4)
+
+            [x,~,~,info1] = scs_solve(work);
+            testCase.verifyEqual(info1.status, 'solved')
+            testCase.verifyEqual(x, x_ref, 'AbsTol', 1e-4)
+
+            scs_finish(work);
+        end
+
+        function test_default_backend_makes_no_copies(testCase)
+            % The default backend solves a batch on one thread, on the
+            % workspace itself.
+            work = scs_init(testCase.data, testCase.cones, ...
+                struct('verbose', 0));
+            [~,~,~,info] = scs_solve_batch(work, testCase.B, testCase.C);
+            testCase.verifyEqual({info.status}, ...
+                repmat({'solved'}, 1, size(testCase.B, 2)))
+            st = scs_stats(work);
+            testCase.verifyEqual(st.batch_workspaces, 0)
+            testCase.verifyEqual(st.ldl_calls, 1)
+            scs_finish(work);
+        end
+
+        function test_batch_bad_sizes(testCase, solver)
+            pars = solve_batch.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            testCase.verifyError(@() scs_solve_batch(work, ...
+                testCase.B(1:end-1,:), []), ?MException)
+            testCase.verifyError(@() scs_solve_batch(work, ...
+                testCase.B, testCase.C(:,1:end-1)), ?MException)
+            scs_finish(work);
+        end
+    end
+
+    methods (Static)
+        function pars = solver_pars(solver)
+            pars = struct();
+            if strcmp(solver, 'qdldl'), pars.use_qdldl = true; end
+            if strcmp(solver, 'indirect'), pars.use_indirect = true; end
+        end
+    end
+end
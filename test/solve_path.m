@@ -0,0 +1,97 @@
+classdef solve_path < matlab.unittest.TestCase
+
+    properties
+        data
+        cones
+        C
+    end
+
+    properties (TestParameter)
+        solver = {'default', 'qdldl', 'indirect'}
+    end
+
+    methods(TestMethodSetup)
+        function setup_problem(testCase)
+            % Lasso-style path: c moves smoothly, constraints stay fixed.
+            rng(1234)
+            m = 30;
+            n = 10;
+            k = 6;
+            testCase.data.A = sparse(randn(m,n));
+            testCase.data.b = testCase.data.A * randn(n,1) + ones(m,1);
+            testCase.cones.l = m;
+            y0 = 1 + rand(m,1);
+            dy = rand(m,1);
+            t = linspace(0, 1, k);
+            testCase.C = -testCase.data.A' * (y0 + dy * t);
+            testCase.data.c = testCase.C(:,1);
+        end
+    end
+
+    methods (Test)
+        function test_path_matches_manual_chain(testCase, solver)
+            pars = solve_path.solver_pars(solver);
+            pars.verbose = 0;
+            k = size(testCase.C, 2);
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [X, Y, S, info] = scs_solve_path(work, [], testCase.C);
+            scs_finish(work);
+            testCase.verifySize(X, [size(testCase.C,1), k])
+            testCase.verifySize(info, [1, k])
+
+            % Same path driven from MATLAB, one warm-started step at a time
+            work = scs_init(testCase.data, testCase.cones, pars);
+            for j = 1:k
+                testCase.verifyEqual(info(j).status, 'solved')
+                scs_update(work, [], testCase.C(:,j));
+                if j == 1
+                    [x,y,s,info_j] = scs_solve(work);
+                else
+                    [x,y,s,info_j] = scs_solve(work, warm);
+                end
+                warm = struct('x', x, 'y', y, 's', s);
+                testCase.verifyEqual(info_j.status, 'solved')
+                testCase.verifyEqual(X(:,j), x, 'AbsTol', 1e-4)
+                testCase.verifyEqual(Y(:,j), y, 'AbsTol', 1e-4)
+                testCase.verifyEqual(S(:,j), s, 'AbsTol', 1e-4)
+            end
+            scs_finish(work);
+        end
+
+        function test_path_warm_start_helps(testCase, solver)
+            % Re-running a converged point through the chain should take
+            % far fewer iterations than the cold first point.
+            pars = solve_path.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            C2 = [testCase.C(:,1), testCase.C(:,1)];
+            [~,~,~,info] = scs_solve_path(work, [], C2);
+            testCase.verifyEqual(info(2).status, 'solved')
+            testCase.verifyLessThan(info(2).iter, info(1).iter)
+            testCase.verifyLessThanOrEqual(info(2).iter, 25)
+            scs_finish(work);
+        end
+
+        function test_path_leaves_last_point(testCase, solver)
+            pars = solve_path.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [X,~,~,~] = scs_solve_path(work, [], testCase.C);
+            [x,~,~,info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+            testCase.verifyEqual(x, X(:,end), 'AbsTol', 1e-4)
+            scs_finish(work);
+        end
+    end
+
+    methods (Static)
+        function pars = solver_pars(solver)
+            pars = struct();
+            if strcmp(solver, 'qdldl'), pars.use_qdldl = true; end
+            if strcmp(solver, 'indirect'), pars.use_indirect = true; end
+        end
+    end
+end
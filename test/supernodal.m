@@ -0,0 +1,74 @@
+classdef supernodal < matlab.unittest.TestCase
+    % Cross-validation tests for the supernodal LDL backend against qdldl.
+
+    methods (TestClassSetup)
+        function check_built(testCase)
+            testCase.assumeEqual(exist('scs_supernodal', 'file'), 3)
+        end
+    end
+
+    methods (Test)
+        function test_qp_cross_validate(testCase)
+            rng(2345)
+            n = 15; m = 30;
+            P = randn(n, n);
+            data.P = sparse(P * P' + 0.1 * eye(n));
+            data.A = sparse(randn(m, n));
+            data.c = randn(n, 1);
+            data.b = data.A * randn(n, 1) + ones(m, 1);
+            K.l = m;
+
+            pars = struct('verbose', 0, 'use_qdldl', true);
+            [x1, y1, ~, info1] = scs(data, K, pars);
+            pars = struct('verbose', 0, 'supernodal', true);
+            [x2, y2, ~, info2] = scs(data, K, pars);
+            testCase.verifyEqual(info2.status, 'solved')
+            testCase.verifyEqual(info2.lin_sys_solver, ...
+                'sparse-direct-supernodal')
+            testCase.verifyEqual(x2, x1, 'AbsTol', 1e-4)
+            testCase.verifyEqual(y2, y1, 'AbsTol', 1e-4)
+            testCase.verifyGreaterThanOrEqual(info2.factorizations, 1)
+        end
+
+        function test_large_sparse_threads(testCase)
+            % big enough for multi-column supernodes and parallel subtrees
+            rng(42)
+            m = 3000; n = 1000;
+            data.A = sprandn(m, n, 5 / n) + [speye(n); sparse(m - n, n)];
+            data.c = randn(n, 1);
+            data.b = data.A * randn(n, 1) + rand(m, 1);
+            K.z = 100;
+            K.l = m - 100;
+            data.b(1:K.z) = data.A(1:K.z, :) * randn(n, 1);
+            pars = struct('verbose', 0, 'use_qdldl', true, 'max_iters', 200);
+            [x1, ~, ~, info1] = scs(data, K, pars);
+            for threads = [1, 4]
+                pars = struct('verbose', 0, 'supernodal', true, ...
+                    'max_iters', 200, 'lin_sys_threads', threads);
+                [x2, ~, ~, info2] = scs(data, K, pars);
+                testCase.verifyEqual(info2.status, info1.status)
+                testCase.verifyEqual(x2, x1, 'AbsTol', 1e-4, ...
+                    sprintf('lin_sys_threads = %d', threads))
+            end
+        end
+
+        function test_workspace_refactor(testCase)
+            % adaptive scale updates refactorize numerically only
+            rng(7)
+            m = 200; n = 80;
+            data.A = sprandn(m, n, 0.05) + [speye(n); sparse(m - n, n)];
+            data.P = sparse(diag(rand(n, 1)));
+            data.c = randn(n, 1);
+            data.b = data.A * randn(n, 1) + rand(m, 1);
+            K.l = m;
+            work = scs_init(data, K, struct('verbose', 0, 'supernodal', true));
+            cleanup = onCleanup(@() scs_finish(work));
+            testCase.verifyEqual(work.backend, 'scs_supernodal')
+            [~, ~, ~, info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+            st = scs_stats(work);
+            testCase.verifyGreaterThanOrEqual(st.factorizations, 1)
+            testCase.verifyGreaterThan(st.bytes.factor, 0)
+        end
+    end
+end
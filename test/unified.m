@@ -0,0 +1,122 @@
+classdef unified < matlab.unittest.TestCase
+    % Tests for scs_unified, all CPU backends in one mex file.
+
+    methods (TestClassSetup)
+        function check_built(testCase)
+            testCase.assumeEqual(exist('scs_unified', 'file'), 3)
+        end
+    end
+
+    methods (Static)
+        function [data, K] = qp()
+            rng(1234)
+            n = 15; m = 30;
+            P = randn(n, n);
+            data.P = sparse(P * P' + 0.1 * eye(n));
+            data.A = sparse(randn(m, n));
+            data.c = randn(n, 1);
+            data.b = data.A * randn(n, 1) + ones(m, 1);
+            K.l = m;
+        end
+    end
+
+    methods (Test)
+        function test_backends_cross_validate(testCase)
+            [data, K] = unified.qp();
+            [x0, y0] = scs(data, K, struct('verbose', 0, 'use_qdldl', true));
+            backends = {'matlab_direct', 'direct', 'indirect', 'dense', ...
+                'supernodal'};
+            solvers = {};
+            for i = 1:numel(backends)
+                pars = struct('verbose', 0, 'unified', true, ...
+                    'lin_sys_backend', backends{i});
+                [x, y, ~, info] = scs(data, K, pars);
+                testCase.verifyEqual(info.status, 'solved', backends{i})
+                testCase.verifyEqual(x, x0, 'AbsTol', 1e-4, backends{i})
+                testCase.verifyEqual(y, y0, 'AbsTol', 1e-4, backends{i})
+                solvers{end + 1} = info.lin_sys_solver; %#ok<AGROW>
+            end
+            % each call ran its own backend
+            testCase.verifyEqual(numel(unique(solvers)), numel(backends))
+        end
+
+        function test_flags_select_backend(testCase)
+            [data, K] = unified.qp();
+            pars = struct('verbose', 0, 'unified', true, 'supernodal', true);
+            [~, ~, ~, info] = scs(data, K, pars);
+            testCase.verifyEqual(info.lin_sys_solver, ...
+                'sparse-direct-supernodal')
+            pars = struct('verbose', 0, 'unified', true);
+            [~, ~, ~, info] = scs(data, K, pars);
+            testCase.verifyEqual(info.lin_sys_solver, ...
+                'sparse-direct-matlab-ldl')
+            pars.lin_sys_backend = 'cholmod';
+            testCase.verifyError(@() scs(data, K, pars), ?MException)
+        end
+
+        function test_workspaces_keep_backend(testCase)
+            [data, K] = unified.qp();
+            w1 = scs_init(data, K, struct('verbose', 0, 'unified', true, ...
+                'use_indirect', true));
+            c1 = onCleanup(@() scs_finish(w1));
+            w2 = scs_init(data, K, struct('verbose', 0, 'unified', true, ...
+                'supernodal', true));
+            c2 = onCleanup(@() scs_finish(w2));
+            testCase.verifyEqual(scs_lin_sys(w1), 'indirect')
+            testCase.verifyEqual(scs_lin_sys(w2), 'supernodal')
+            [x1, ~, ~, info1] = scs_solve(w1);
+            [x2, ~, ~, info2] = scs_solve(w2);
+            testCase.verifyNotEqual(info1.lin_sys_solver, ...
+                info2.lin_sys_solver)
+            testCase.verifyEqual(info2.lin_sys_solver, ...
+                'sparse-direct-supernodal')
+            testCase.verifyEqual(x1, x2, 'AbsTol', 1e-4)
+        end
+
+        function test_switch_backend(testCase)
+            [data, K] = unified.qp();
+            work = scs_init(data, K, struct('verbose', 0, 'unified', true));
+            cleanup = onCleanup(@() scs_finish(work));
+            [x, y, s, info] = scs_solve(work);
+            testCase.verifyEqual(info.status, 'solved')
+
+            % the updated b is what the new backend solves
+            b_new = data.b + 0.1;
+            scs_update(work, b_new, []);
+            scs_lin_sys(work, struct('lin_sys_backend', 'direct'));
+            testCase.verifyEqual(scs_lin_sys(work), 'direct')
+            [x2, ~, ~, info2] = scs_solve(work, ...
+                struct('x', x, 'y', y, 's', s));
+            testCase.verifyEqual(info2.status, 'solved')
+            data.b = b_new;
+            [x_ref, ~, ~, info_ref] = scs(data, K, ...
+                struct('verbose', 0, 'unified', true, 'use_qdldl', true));
+            testCase.verifyEqual(info2.lin_sys_solver, ...
+                info_ref.lin_sys_solver)
+            testCase.verifyEqual(scs_stats(work).lin_sys_solver, ...
+                info_ref.lin_sys_solver)
+            testCase.verifyEqual(x2, x_ref, 'AbsTol', 1e-4)
+
+            testCase.verifyError(@() scs_lin_sys(work, ...
+                struct('lin_sys_backend', 'cholmod')), ?MException)
+            testCase.verifyEqual(scs_lin_sys(work), 'direct')
+        end
+
+        function test_save_load_keeps_backend(testCase)
+            [data, K] = unified.qp();
+            work = scs_init(data, K, struct('verbose', 0, 'unified', true, ...
+                'supernodal', true));
+            c1 = onCleanup(@() scs_finish(work));
+            file = [tempname, '.scsws'];
+            c2 = onCleanup(@() delete(file));
+            scs_save(work, file);
+            loaded = scs_load(file, struct('unified', true));
+            c3 = onCleanup(@() scs_finish(loaded));
+            testCase.verifyEqual(scs_lin_sys(loaded), 'supernodal')
+            [x1, ~, ~, info1] = scs_solve(work);
+            [x2, ~, ~, info2] = scs_solve(loaded);
+            testCase.verifyEqual(info2.status, info1.status)
+            testCase.verifyEqual(x2, x1, 'AbsTol', 1e-6)
+        end
+    end
+end
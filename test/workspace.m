@@ -98,6 +98,220 @@ classdef workspace < matlab.unittest.TestCase
 
             scs_finish(work);
         end
+
+        function test_multiple_workspaces(testCase, solver)
+            % Several workspaces stay resident and independent: updating
+            % or finishing one must not disturb the others.
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+
+            [x_ref,~,~,info_ref] = scs(testCase.data,testCase.cones,pars);
+            testCase.verifyEqual(info_ref.status, 'solved')
+
+            rng(5678)
+            c_other = randn(size(testCase.data.c));
+            data_other = testCase.data;
+            data_other.c = c_other;
+            [x_other_ref,~,~,info_other] = scs(data_other,testCase.cones,pars);
+            testCase.verifyEqual(info_other.status, 'solved')
+
+            work1 = scs_init(testCase.data, testCase.cones, pars);
+            work2 = scs_init(testCase.data, testCase.cones, pars);
+            testCase.verifyNotEqual(work1.handle, work2.handle)
+
+            scs_update(work2, [], c_other);
+            [x1,~,~,info1] = scs_solve(work1);
+            [x2,~,~,info2] = scs_solve(work2);
+            testCase.verifyEqual(info1.status, 'solved')
+            testCase.verifyEqual(info2.status, 'solved')
+            testCase.verifyEqual(x1, x_ref, 'RelTol', 1e-6)
+            testCase.verifyEqual(x2, x_other_ref, 'RelTol', 1e-6)
+
+            scs_finish(work2);
+            [x1,~,~,info1] = scs_solve(work1);
+            testCase.verifyEqual(info1.status, 'solved')
+            testCase.verifyEqual(x1, x_ref, 'RelTol', 1e-6)
+
+            scs_finish(work1);
+        end
+
+        function test_save_load(testCase, solver)
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+            filename = [tempname, '.scsws'];
+            cleanup = onCleanup(@() delete(filename));
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            scs_save(work, filename);
+            [x1,y1,s1,info1] = scs_solve(work);
+            scs_finish(work);
+
+            work = scs_load(filename, pars);
+            testCase.verifyEqual(work.m, size(testCase.data.A, 1))
+            testCase.verifyEqual(work.n, size(testCase.data.A, 2))
+            [x2,y2,s2,info2] = scs_solve(work);
+            testCase.verifyEqual(info2.status, info1.status)
+            testCase.verifyEqual(info2.iter, info1.iter)
+            testCase.verifyEqual(x2, x1, 'AbsTol', 1e-10)
+            testCase.verifyEqual(y2, y1, 'AbsTol', 1e-10)
+            testCase.verifyEqual(s2, s1, 'AbsTol', 1e-10)
+
+            % The loaded workspace supports updates like any other
+            rng(99)
+            b_new = testCase.data.A * randn(size(testCase.data.c)) + ...
+                ones(size(testCase.data.b));
+            scs_update(work, b_new, []);
+            [~,~,~,info3] = scs_solve(work);
+            testCase.verifyEqual(info3.status, 'solved')
+            scs_finish(work);
+
+            testCase.verifyError(@() scs_load([filename, '.missing'], ...
+                pars), ?MException)
+        end
+
+        function test_save_over_loaded_file(testCase, solver)
+            % the loaded workspace may still map the file it came from
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+            filename = [tempname, '.scsws'];
+            cleanup = onCleanup(@() delete(filename));
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            scs_save(work, filename);
+            x1 = scs_solve(work);
+            loaded = scs_load(filename, pars);
+            scs_save(loaded, filename);
+            scs_save(work, filename);
+            scs_finish(work);
+
+            [x2,~,~,info2] = scs_solve(loaded);
+            testCase.verifyEqual(info2.status, 'solved')
+            testCase.verifyEqual(x2, x1, 'AbsTol', 1e-10)
+            scs_finish(loaded);
+
+            work = scs_load(filename, pars);
+            x3 = scs_solve(work);
+            testCase.verifyEqual(x3, x1, 'AbsTol', 1e-10)
+            scs_finish(work);
+            [folder, name, ext] = fileparts(filename);
+            testCase.verifyEmpty(dir(fullfile(folder, [name, ext, '.*.tmp'])))
+        end
+
+        function test_load_corrupt_file(testCase, solver)
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+            filename = [tempname, '.scsws'];
+            bad = [tempname, '.scsws'];
+            cleanup = onCleanup(@() delete(filename, bad));
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            scs_save(work, filename);
+            scs_finish(work);
+            fid = fopen(filename, 'r');
+            bytes = fread(fid, inf, '*uint8');
+            fclose(fid);
+
+            % every section is needed: truncated copies are rejected
+            for len = unique(round(linspace(0, numel(bytes) - 1, 40)))
+                workspace.write_bytes(bad, bytes(1:len));
+                testCase.verifyError(@() scs_load(bad, pars), ?MException)
+            end
+
+            % damaged words (sizes, indices, options) give an error or a
+            % workspace, never a crash; the stored settings may be damaged
+            % too, so the workspace is not solved
+            for pos = 1:8:numel(bytes) - 7
+                for fill = uint8([255 127])
+                    damaged = bytes;
+                    damaged(pos:pos + 7) = fill;
+                    workspace.write_bytes(bad, damaged);
+                    try
+                        evalc('loaded = scs_load(bad, pars);');
+                    catch
+                        continue
+                    end
+                    scs_finish(loaded);
+                end
+            end
+        end
+
+        function test_read_file(testCase, solver)
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+            filename = [tempname, '.bin'];
+            cleanup = onCleanup(@() delete(filename));
+
+            pars.write_data_filename = filename;
+            [x1,y1,s1,info1] = scs(testCase.data, testCase.cones, pars);
+            pars = rmfield(pars, 'write_data_filename');
+
+            [x2,y2,s2,info2] = scs_read(filename, pars);
+            testCase.verifyEqual(info2.status, info1.status)
+            testCase.verifyEqual(x2, x1, 'AbsTol', 1e-10)
+            testCase.verifyEqual(y2, y1, 'AbsTol', 1e-10)
+            testCase.verifyEqual(s2, s1, 'AbsTol', 1e-10)
+
+            % Settings in pars override the stored ones
+            pars.max_iters = 1;
+            [~,~,~,info3] = scs_read(filename, pars);
+            testCase.verifyEqual(info3.iter, 1)
+            pars = rmfield(pars, 'max_iters');
+
+            work = scs_read_init(filename, pars);
+            testCase.verifyEqual(work.m, size(testCase.data.A, 1))
+            testCase.verifyEqual(work.n, size(testCase.data.A, 2))
+            [x4,~,~,info4] = scs_solve(work);
+            testCase.verifyEqual(info4.status, 'solved')
+            testCase.verifyEqual(x4, x1, 'AbsTol', 1e-10)
+            scs_finish(work);
+
+            testCase.verifyError(@() scs_read([filename, '.missing'], ...
+                pars), ?MException)
+        end
+
+        function test_stats(testCase, solver)
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [~,~,~,info] = scs_solve(work);
+            stats = scs_stats(work);
+            scs_finish(work);
+            testCase.verifyEqual(stats.m, size(testCase.data.A, 1))
+            testCase.verifyEqual(stats.n, size(testCase.data.A, 2))
+            testCase.verifyEqual(stats.lin_sys_solver, info.lin_sys_solver)
+            testCase.verifyGreaterThan(stats.bytes.data, 0)
+            testCase.verifyEqual(stats.bytes.file, 0)
+            if strcmp(solver, 'default')
+                testCase.verifyGreaterThanOrEqual(stats.L_nnz, 0)
+                testCase.verifyEqual(stats.fill_ratio, ...
+                    (stats.L_nnz + stats.m + stats.n) / stats.kkt_nnz, ...
+                    'RelTol', 1e-12)
+                testCase.verifyGreaterThanOrEqual(stats.factorizations, 1)
+                testCase.verifyGreaterThanOrEqual(stats.solves, ...
+                    info.lin_sys_solves)
+                testCase.verifyGreaterThanOrEqual(info.lin_sys_solves, ...
+                    info.iter)
+                testCase.verifyGreaterThan(stats.bytes.factor, 0)
+                testCase.verifyGreaterThan(stats.bytes.total, ...
+                    stats.bytes.factor + stats.bytes.kkt)
+            else
+                testCase.verifyTrue(isnan(stats.L_nnz))
+                testCase.verifyTrue(isnan(info.factor_time))
+            end
+        end
+
+        function test_finished_handle_errors(testCase, solver)
+            pars = workspace.solver_pars(solver);
+            pars.verbose = 0;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            scs_finish(work);
+            testCase.verifyError(@() scs_solve(work), ?MException)
+            testCase.verifyError(@() scs_update(work, testCase.data.b, []), ...
+                ?MException)
+            testCase.verifyError(@() scs_finish(work), ?MException)
+        end
     end
 
     methods (Static)
@@ -106,5 +320,11 @@ classdef workspace < matlab.unittest.TestCase
             if strcmp(solver, 'qdldl'), pars.use_qdldl = true; end
             if strcmp(solver, 'indirect'), pars.use_indirect = true; end
         end
+
+        function write_bytes(filename, bytes)
+            fid = fopen(filename, 'w');
+            fwrite(fid, bytes, 'uint8');
+            fclose(fid);
+        end
     end
 end
@@ -85,6 +85,50 @@ classdef workspace_qp < matlab.unittest.TestCase
 
             scs_finish(work);
         end
+
+        function test_update_matrix(testCase, solver)
+            pars = workspace_qp.solver_pars(solver);
+            pars.verbose = 0;
+            pars.eps_abs = 1e-8;
+            pars.eps_rel = 1e-8;
+
+            work = scs_init(testCase.data, testCase.cones, pars);
+            [~,~,~,info1] = scs_solve(work);
+            testCase.verifyEqual(info1.status, 'solved')
+
+            % New values, same pattern (P passed full symmetric)
+            rng(4321)
+            data2 = testCase.data;
+            [i, j, v] = find(data2.A);
+            data2.A = sparse(i, j, v .* (1 + 0.2 * rand(size(v))), ...
+                size(data2.A, 1), size(data2.A, 2));
+            data2.P = data2.P + 0.5 * speye(size(data2.P, 1));
+            scs_update(work, [], [], data2.A, data2.P);
+            [x_ws,y_ws,~,info_ws] = scs_solve(work);
+            testCase.verifyEqual(info_ws.status, 'solved')
+
+            [x_ref,y_ref,~,info_ref] = scs(data2, testCase.cones, pars);
+            testCase.verifyEqual(info_ref.status, 'solved')
+            testCase.verifyEqual(x_ws, x_ref, 'AbsTol', 1e-5)
+            testCase.verifyEqual(y_ws, y_ref, 'AbsTol', 1e-5)
+
+            % Value vector form may set entries to zero
+            vals = nonzeros(data2.A);
+            vals(1) = 0;
+            scs_update(work, [], [], vals, []);
+            [~,~,~,info3] = scs_solve(work);
+            testCase.verifyEqual(info3.status, 'solved')
+
+            % Pattern changes are rejected
+            A_bad = data2.A;
+            A_bad(find(A_bad, 1)) = 0;
+            testCase.verifyError(@() scs_update(work, [], [], A_bad), ...
+                ?MException)
+            testCase.verifyError(@() scs_update(work, [], [], vals(2:end)), ...
+                ?MException)
+
+            scs_finish(work);
+        end
     end
 
     methods (Static)